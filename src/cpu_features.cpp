@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cpu_features.h"
+
+#if CPU_FEATURES_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+static CpuFeatures detect_cpu_features()
+{
+   CpuFeatures features = {false, false, false, false};
+
+#if CPU_FEATURES_X86 && (defined(__GNUC__) || defined(__clang__))
+   //The GCC builtins already check that the OS saves the extended registers (XGETBV)
+   __builtin_cpu_init();
+   features.sse41 = __builtin_cpu_supports("sse4.1");
+   features.sse42 = __builtin_cpu_supports("sse4.2");
+   features.avx2 = __builtin_cpu_supports("avx2");
+   features.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif CPU_FEATURES_X86 && defined(_MSC_VER)
+   int registers[4];
+   __cpuid(registers, 0);
+   const int max_leaf = registers[0];
+
+   __cpuid(registers, 1);
+   features.sse41 = (registers[2] & (1 << 19)) != 0;
+   features.sse42 = (registers[2] & (1 << 20)) != 0;
+   const bool os_xsave = (registers[2] & (1 << 27)) != 0;
+   const bool avx = (registers[2] & (1 << 28)) != 0;
+
+   if (os_xsave && avx && max_leaf >= 7)
+   {
+      const unsigned long long xcr0 = _xgetbv(0);
+      const bool os_ymm = (xcr0 & 0x6) == 0x6;
+      const bool os_zmm = (xcr0 & 0xe6) == 0xe6;
+
+      __cpuidex(registers, 7, 0);
+      features.avx2 = os_ymm && (registers[1] & (1 << 5)) != 0;
+      features.avx512 = os_zmm && (registers[1] & (1 << 16)) != 0 && (registers[1] & (1 << 30)) != 0;
+   }
+#endif
+
+   return features;
+}
+
+const CpuFeatures& get_cpu_features()
+{
+   static const CpuFeatures features = detect_cpu_features();
+   return features;
+}
@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file cpu_features.h
+   @brief This file contains the runtime detection of the CPU instruction sets used by the vectorized kernels.
+*/
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CPU_FEATURES_X86 1
+#else
+#define CPU_FEATURES_X86 0
+#endif
+
+/*!
+   @brief Per-function target attribute for kernels using instruction sets that are not enabled for the whole translation unit.
+   MSVC accepts the intrinsics without any attribute.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define TARGET_SSE41
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+/*!
+   @brief Instruction sets available on the running CPU, usable by the operating system.
+*/
+struct CpuFeatures
+{
+   bool sse41;
+   bool sse42;
+   bool avx2;
+   bool avx512;
+};
+
+/*!
+   @brief Returns the instruction sets supported by the CPU. The detection is done once, on first call.
+
+   @returns A reference to the detected CpuFeatures.
+*/
+const CpuFeatures& get_cpu_features();
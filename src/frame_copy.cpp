@@ -0,0 +1,143 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_copy.h"
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+//Below this size, the destination is likely to stay in the cache until it is used, and memcpy is faster.
+constexpr size_t non_temporal_copy_threshold = 256 * 1024;
+constexpr size_t cache_line_size = 64;
+
+void copy_frame_scalar(uint8_t* destination, const uint8_t* source, size_t size)
+{
+   std::memcpy(destination, source, size);
+}
+
+#if CPU_FEATURES_X86
+//Copies up to the next cache line boundary of the destination, so that the non-temporal stores fill whole lines.
+static size_t copy_to_cache_line_boundary(uint8_t* destination, const uint8_t* source, size_t size)
+{
+   const size_t head = std::min(size, (cache_line_size - reinterpret_cast<uintptr_t>(destination) % cache_line_size) % cache_line_size);
+   std::memcpy(destination, source, head);
+   return head;
+}
+
+TARGET_AVX2 static void copy_frame_avx2(uint8_t* destination, const uint8_t* source, size_t size)
+{
+   const size_t head = copy_to_cache_line_boundary(destination, source, size);
+   destination += head;
+   source += head;
+   size -= head;
+
+   const size_t body = size / (4 * sizeof(__m256i)) * (4 * sizeof(__m256i));
+   if (reinterpret_cast<uintptr_t>(source) % sizeof(__m256i) == 0)
+   {
+      for (size_t i = 0; i < body; i += 4 * sizeof(__m256i))
+      {
+         const __m256i* in = reinterpret_cast<const __m256i*>(source + i);
+         __m256i* out = reinterpret_cast<__m256i*>(destination + i);
+         const __m256i a = _mm256_stream_load_si256(in), b = _mm256_stream_load_si256(in + 1);
+         const __m256i c = _mm256_stream_load_si256(in + 2), d = _mm256_stream_load_si256(in + 3);
+         _mm256_stream_si256(out, a);
+         _mm256_stream_si256(out + 1, b);
+         _mm256_stream_si256(out + 2, c);
+         _mm256_stream_si256(out + 3, d);
+      }
+   }
+   else
+   {
+      for (size_t i = 0; i < body; i += 4 * sizeof(__m256i))
+      {
+         const __m256i* in = reinterpret_cast<const __m256i*>(source + i);
+         __m256i* out = reinterpret_cast<__m256i*>(destination + i);
+         const __m256i a = _mm256_loadu_si256(in), b = _mm256_loadu_si256(in + 1);
+         const __m256i c = _mm256_loadu_si256(in + 2), d = _mm256_loadu_si256(in + 3);
+         _mm256_stream_si256(out, a);
+         _mm256_stream_si256(out + 1, b);
+         _mm256_stream_si256(out + 2, c);
+         _mm256_stream_si256(out + 3, d);
+      }
+   }
+
+   //Non-temporal stores are weakly ordered : they must be visible before the slot is handed back to the stream.
+   _mm_sfence();
+   std::memcpy(destination + body, source + body, size - body);
+}
+
+TARGET_AVX512 static void copy_frame_avx512(uint8_t* destination, const uint8_t* source, size_t size)
+{
+   const size_t head = copy_to_cache_line_boundary(destination, source, size);
+   destination += head;
+   source += head;
+   size -= head;
+
+   const size_t body = size / (4 * sizeof(__m512i)) * (4 * sizeof(__m512i));
+   if (reinterpret_cast<uintptr_t>(source) % sizeof(__m512i) == 0)
+   {
+      for (size_t i = 0; i < body; i += 4 * sizeof(__m512i))
+      {
+         //Older compilers declare the source of _mm512_stream_load_si512 as a non-const pointer.
+         __m512i* in = reinterpret_cast<__m512i*>(const_cast<uint8_t*>(source + i));
+         __m512i* out = reinterpret_cast<__m512i*>(destination + i);
+         const __m512i a = _mm512_stream_load_si512(in), b = _mm512_stream_load_si512(in + 1);
+         const __m512i c = _mm512_stream_load_si512(in + 2), d = _mm512_stream_load_si512(in + 3);
+         _mm512_stream_si512(out, a);
+         _mm512_stream_si512(out + 1, b);
+         _mm512_stream_si512(out + 2, c);
+         _mm512_stream_si512(out + 3, d);
+      }
+   }
+   else
+   {
+      for (size_t i = 0; i < body; i += 4 * sizeof(__m512i))
+      {
+         const uint8_t* in = source + i;
+         __m512i* out = reinterpret_cast<__m512i*>(destination + i);
+         const __m512i a = _mm512_loadu_si512(in), b = _mm512_loadu_si512(in + sizeof(__m512i));
+         const __m512i c = _mm512_loadu_si512(in + 2 * sizeof(__m512i)), d = _mm512_loadu_si512(in + 3 * sizeof(__m512i));
+         _mm512_stream_si512(out, a);
+         _mm512_stream_si512(out + 1, b);
+         _mm512_stream_si512(out + 2, c);
+         _mm512_stream_si512(out + 3, d);
+      }
+   }
+
+   _mm_sfence();
+   std::memcpy(destination + body, source + body, size - body);
+}
+#endif
+
+typedef void (*CopyFrameFunction)(uint8_t*, const uint8_t*, size_t);
+
+void copy_frame(uint8_t* destination, const uint8_t* source, size_t size)
+{
+#if CPU_FEATURES_X86
+   static const CopyFrameFunction copy = get_cpu_features().avx512 ? copy_frame_avx512 : get_cpu_features().avx2 ? copy_frame_avx2 : copy_frame_scalar;
+#else
+   static const CopyFrameFunction copy = copy_frame_scalar;
+#endif
+
+   if (size < non_temporal_copy_threshold)
+      copy_frame_scalar(destination, source, size);
+   else
+      copy(destination, source, size);
+}
@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file frame_copy.h
+   @brief This file contains the copy of whole frames between the slot buffers and the application buffers.
+
+   A frame is written once and not read back by the copying thread, so writing it through the cache only evicts the
+   working set of the other cores sharing the last level cache, the conductor first. Large copies use non-temporal
+   stores (AVX-512 or AVX2, selected at runtime) that write to memory without allocating cache lines, and streaming loads
+   when the source is aligned. Streaming loads only bypass the cache on write-combining memory, they are regular loads otherwise.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+
+/*!
+   @brief Copies a frame, or a large part of it, with non-temporal stores. Small copies use memcpy, the data
+   being likely to be used again from the cache. The buffers do not have to be aligned and must not overlap.
+*/
+void copy_frame(uint8_t* destination /*!< [out] Destination buffer.*/
+   , const uint8_t* source /*!< [in] Source buffer.*/
+   , size_t size /*!< [in] Number of bytes to copy.*/
+);
+
+/*!
+   @brief Copy through the cache with memcpy, fallback of copy_frame.
+*/
+void copy_frame_scalar(uint8_t* destination, const uint8_t* source, size_t size);
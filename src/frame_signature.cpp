@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_signature.h"
+#include "cpu_features.h"
+
+#include <array>
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+constexpr uint32_t crc32c_polynomial = 0x82F63B78; /*! Castagnoli polynomial, bit reflected */
+constexpr size_t crc32c_lane_size = 8192; /*! Bytes processed by each of the 3 interleaved lanes of the hardware kernel */
+
+//Signature layout, every field in little endian.
+constexpr size_t signature_magic_offset = 0;
+constexpr size_t signature_reserved_size_offset = 4;
+constexpr size_t signature_sequence_offset = 8;
+constexpr size_t signature_payload_crc_offset = 16;
+constexpr size_t signature_header_crc_offset = 20;
+
+static std::array<uint32_t, 256> make_crc32c_table()
+{
+   std::array<uint32_t, 256> table = {};
+   for (uint32_t i = 0; i < table.size(); i++)
+   {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+         crc = (crc & 1) ? (crc >> 1) ^ crc32c_polynomial : crc >> 1;
+      table[i] = crc;
+   }
+   return table;
+}
+
+uint32_t crc32c_scalar(const uint8_t* data, size_t size, uint32_t crc)
+{
+   static const std::array<uint32_t, 256> table = make_crc32c_table();
+
+   crc = ~crc;
+   for (size_t i = 0; i < size; i++)
+      crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+   return ~crc;
+}
+
+#if CPU_FEATURES_X86
+//Product of two polynomials modulo the CRC polynomial, in the bit reflected representation (x^0 is the most significant bit).
+static uint32_t multiply_modulo_polynomial(uint32_t a, uint32_t b)
+{
+   uint32_t product = 0;
+   for (uint32_t mask = 1u << 31; mask != 0; mask >>= 1)
+   {
+      if (a & mask)
+         product ^= b;
+      b = (b & 1) ? (b >> 1) ^ crc32c_polynomial : b >> 1;
+   }
+   return product;
+}
+
+//x^(8 * size) modulo the CRC polynomial : multiplying a CRC by it appends size zero bytes to the checksummed data.
+static uint32_t zero_bytes_operator(size_t size)
+{
+   uint32_t power = 1u << 30; //x^1
+   uint32_t result = 1u << 31; //x^0
+   for (size_t exponent = 8 * size; exponent != 0; exponent >>= 1)
+   {
+      if (exponent & 1)
+         result = multiply_modulo_polynomial(result, power);
+      power = multiply_modulo_polynomial(power, power);
+   }
+   return result;
+}
+
+TARGET_SSE42 static uint32_t crc32c_sse42(const uint8_t* data, size_t size, uint32_t crc)
+{
+   static const uint32_t lane_shift = zero_bytes_operator(crc32c_lane_size);
+
+   uint64_t crc0 = ~crc;
+
+   while (size != 0 && reinterpret_cast<uintptr_t>(data) % 8 != 0)
+   {
+      crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *data++);
+      size--;
+   }
+
+   //The crc32 instruction has a latency of 3 cycles and a throughput of 1 : three independent lanes keep it busy.
+   //The lanes are then chained by appending the size of a lane of zeros to the first CRCs, which is linear.
+   while (size >= 3 * crc32c_lane_size)
+   {
+      uint64_t crc1 = 0, crc2 = 0;
+      for (size_t i = 0; i < crc32c_lane_size; i += 8)
+      {
+         uint64_t word0, word1, word2;
+         std::memcpy(&word0, data + i, 8);
+         std::memcpy(&word1, data + crc32c_lane_size + i, 8);
+         std::memcpy(&word2, data + 2 * crc32c_lane_size + i, 8);
+         crc0 = _mm_crc32_u64(crc0, word0);
+         crc1 = _mm_crc32_u64(crc1, word1);
+         crc2 = _mm_crc32_u64(crc2, word2);
+      }
+      crc0 = multiply_modulo_polynomial(lane_shift, static_cast<uint32_t>(crc0)) ^ static_cast<uint32_t>(crc1);
+      crc0 = multiply_modulo_polynomial(lane_shift, static_cast<uint32_t>(crc0)) ^ static_cast<uint32_t>(crc2);
+      data += 3 * crc32c_lane_size;
+      size -= 3 * crc32c_lane_size;
+   }
+
+   for (; size >= 8; size -= 8, data += 8)
+   {
+      uint64_t word;
+      std::memcpy(&word, data, 8);
+      crc0 = _mm_crc32_u64(crc0, word);
+   }
+
+   for (; size != 0; size--)
+      crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *data++);
+
+   return ~static_cast<uint32_t>(crc0);
+}
+#endif
+
+typedef uint32_t (*Crc32cFunction)(const uint8_t*, size_t, uint32_t);
+
+uint32_t crc32c(const uint8_t* data, size_t size, uint32_t crc)
+{
+#if CPU_FEATURES_X86
+   static const Crc32cFunction checksum = get_cpu_features().sse42 ? crc32c_sse42 : crc32c_scalar;
+#else
+   static const Crc32cFunction checksum = crc32c_scalar;
+#endif
+   return checksum(data, size, crc);
+}
+
+static void write_le32(uint8_t* destination, uint32_t value)
+{
+   for (int i = 0; i < 4; i++)
+      destination[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static void write_le64(uint8_t* destination, uint64_t value)
+{
+   for (int i = 0; i < 8; i++)
+      destination[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint32_t read_le32(const uint8_t* source)
+{
+   uint32_t value = 0;
+   for (int i = 0; i < 4; i++)
+      value |= static_cast<uint32_t>(source[i]) << (8 * i);
+   return value;
+}
+
+static uint64_t read_le64(const uint8_t* source)
+{
+   uint64_t value = 0;
+   for (int i = 0; i < 8; i++)
+      value |= static_cast<uint64_t>(source[i]) << (8 * i);
+   return value;
+}
+
+bool write_frame_signature(uint8_t* frame, size_t frame_size, size_t reserved_size, uint64_t sequence)
+{
+   if (frame == nullptr || reserved_size < frame_signature_size || reserved_size > frame_size || reserved_size > UINT32_MAX)
+      return false;
+
+   write_le32(frame + signature_magic_offset, frame_signature_magic);
+   write_le32(frame + signature_reserved_size_offset, static_cast<uint32_t>(reserved_size));
+   write_le64(frame + signature_sequence_offset, sequence);
+   write_le32(frame + signature_payload_crc_offset, crc32c(frame + reserved_size, frame_size - reserved_size));
+   write_le32(frame + signature_header_crc_offset, crc32c(frame, signature_header_crc_offset));
+   return true;
+}
+
+bool read_frame_sequence(const uint8_t* frame, size_t frame_size, uint64_t* sequence)
+{
+   if (frame == nullptr || sequence == nullptr || frame_size < frame_signature_size || read_le32(frame + signature_magic_offset) != frame_signature_magic
+      || read_le32(frame + signature_header_crc_offset) != crc32c(frame, signature_header_crc_offset))
+      return false;
+
+   *sequence = read_le64(frame + signature_sequence_offset);
+   return true;
+}
+
+FrameSignatureVerifier::FrameSignatureVerifier() : last_sequence(0), has_sequence(false)
+{
+}
+
+void FrameSignatureVerifier::verify(const uint8_t* frame, size_t frame_size)
+{
+   if (frame == nullptr || frame_size < frame_signature_size || read_le32(frame + signature_magic_offset) != frame_signature_magic)
+   {
+      statistics.unsigned_frames++;
+      return;
+   }
+
+   statistics.verified++;
+
+   //A damaged header cannot be trusted for the sequence number nor for the extent of the CRC.
+   const size_t reserved_size = read_le32(frame + signature_reserved_size_offset);
+   if (read_le32(frame + signature_header_crc_offset) != crc32c(frame, signature_header_crc_offset) || reserved_size < frame_signature_size || reserved_size > frame_size)
+   {
+      statistics.corrupt++;
+      return;
+   }
+
+   if (read_le32(frame + signature_payload_crc_offset) != crc32c(frame + reserved_size, frame_size - reserved_size))
+      statistics.corrupt++;
+
+   const uint64_t sequence = read_le64(frame + signature_sequence_offset);
+   if (has_sequence)
+   {
+      if (sequence == last_sequence)
+         statistics.repeated++;
+      else if (sequence < last_sequence)
+         statistics.out_of_order++;
+      else
+         statistics.skipped += sequence - last_sequence - 1;
+   }
+
+   //An out of order frame does not move the reference back, so that the frames following it are not counted as repeated.
+   if (!has_sequence || sequence > last_sequence)
+      last_sequence = sequence;
+   has_sequence = true;
+}
+
+void FrameSignatureVerifier::reset()
+{
+   statistics = FrameSignatureStatistics();
+   last_sequence = 0;
+   has_sequence = false;
+}
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file frame_signature.h
+   @brief This file contains the per-frame signature written by the sender and checked by the receiver.
+
+   The signature is written at the start of the reserved lines of the frame buffer, the first buffer lines. It holds a
+   sequence number and the CRC32C of the rest of the frame, so that the receiver can tell a corrupt frame from an
+   intact one, and a repeated or skipped frame from the expected next one. The reserved lines are not part of the CRC.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+
+constexpr uint32_t frame_signature_magic = 0x4753464D; /*! "MFSG" in little endian */
+constexpr size_t frame_signature_size = 24; /*! Size of the signature written at the start of the frame */
+
+/*!
+   @brief Computes the CRC32C (Castagnoli) of a buffer. The SSE4.2 crc32 instruction is used when the CPU supports it.
+
+   @returns The CRC32C of the data, continuing the CRC crc of the preceding data.
+*/
+uint32_t crc32c(const uint8_t* data /*!< [in] Data to checksum.*/
+   , size_t size /*!< [in] Size of the data in bytes.*/
+   , uint32_t crc = 0 /*!< [in] CRC32C of the preceding data, 0 for the first block.*/
+);
+
+/*!
+   @brief Table driven CRC32C, reference of the hardware accelerated crc32c.
+*/
+uint32_t crc32c_scalar(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+/*!
+   @brief Writes the signature of a frame at the start of its reserved lines. The CRC covers the frame from reserved_size to frame_size.
+
+   @returns false if the frame is too small to hold the signature and the reserved lines.
+*/
+bool write_frame_signature(uint8_t* frame /*!< [in,out] Frame buffer.*/
+   , size_t frame_size /*!< [in] Size of the frame buffer in bytes.*/
+   , size_t reserved_size /*!< [in] Size of the reserved lines, excluded from the CRC. At least frame_signature_size.*/
+   , uint64_t sequence /*!< [in] Sequence number of the frame.*/
+);
+
+/*!
+   @brief Reads the sequence number of a signed frame, without checking its content.
+
+   @returns false if the frame carries no signature, or if its header is damaged.
+*/
+bool read_frame_sequence(const uint8_t* frame /*!< [in] Received frame buffer.*/
+   , size_t frame_size /*!< [in] Size of the frame buffer in bytes.*/
+   , uint64_t* sequence /*!< [out] Sequence number of the frame.*/
+);
+
+/*!
+   @brief Counters of the FrameSignatureVerifier.
+*/
+struct FrameSignatureStatistics
+{
+   uint64_t verified = 0; /*! Frames carrying a signature */
+   uint64_t corrupt = 0; /*! Signed frames whose content does not match the CRC */
+   uint64_t repeated = 0; /*! Frames carrying the same sequence number as the previous one */
+   uint64_t skipped = 0; /*! Sequence numbers missing between two consecutive frames */
+   uint64_t out_of_order = 0; /*! Frames carrying a sequence number lower than the previous one */
+   uint64_t unsigned_frames = 0; /*! Frames without any signature */
+};
+
+class FrameSignatureVerifier
+{
+public:
+
+   FrameSignatureVerifier();
+
+   /*!
+      @brief Checks the signature of a received frame and updates the statistics.
+   */
+   void verify(const uint8_t* frame /*!< [in] Received frame buffer.*/
+      , size_t frame_size /*!< [in] Size of the frame buffer in bytes.*/
+   );
+
+   /*!
+      @brief Forgets the last sequence number and clears the statistics, typically when the reception restarts.
+   */
+   void reset();
+
+   const FrameSignatureStatistics& get_statistics() const { return statistics; }
+
+private:
+
+   FrameSignatureStatistics statistics;
+   uint64_t last_sequence;
+   bool has_sequence;
+};
@@ -23,6 +23,7 @@
 #include "nmos/clock_name.h"
 #include "nmos/settings.h"
 #include "nmos/node_resources.h"
+#include "nmos/resources.h"
 #include "nmos/interlace_mode.h"
 #include "nmos/colorspace.h"
 #include "nmos/transfer_characteristic.h"
@@ -30,15 +31,91 @@
 #include "nmos/transport.h"
 #include "nmos/connection_resources.h"
 #include "nmos/capabilities.h"
+#include "nmos/channels.h"
+#include "nmos/tai.h"
 #include "cpprest/host_utils.h"
 #include "cpprest/json_ops.h"
 
 #include <videomasterip/videomasterip_networkinterface.h>
 
+#include <algorithm>
+
 #include "tools.h"
 
-nmos_tools::NodeServer::NodeServer(nmos::node_model& node_model, nmos::experimental::node_implementation node_implementation, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, std::string media_nic_name)
-      : node_model(node_model), gate(gate), device_name(device_name), device_description(device_description), media_nic_name(media_nic_name), is_enabled(false), sdp(""),node_server(nmos::experimental::make_node_server(node_model, node_implementation, log_model, gate))
+//Interface bindings of the senders and the receivers, one per leg
+static std::vector<utility::string_t> to_interface_bindings(const std::vector<std::string>& media_nic_names)
+{
+   std::vector<utility::string_t> interface_bindings;
+   for (const std::string& media_nic_name : media_nic_names)
+      interface_bindings.push_back(utility::conversions::to_string_t(media_nic_name));
+   return interface_bindings;
+}
+
+//Gives the string field of an activated leg, or an empty string if it is absent or null
+static utility::string_t get_string_field(const web::json::object& transport_params_object, const utility::string_t& field_name)
+{
+   if(transport_params_object.find(field_name) != transport_params_object.end() && transport_params_object.at(field_name).is_string())
+      return transport_params_object.at(field_name).as_string();
+   return utility::string_t();
+}
+
+//Tells whether an activated leg is enabled. Connections of a single leg have no rtp_enabled field to turn off.
+static bool is_rtp_enabled(const web::json::object& transport_params_object)
+{
+   if(transport_params_object.find(U("rtp_enabled")) != transport_params_object.end() && transport_params_object.at(U("rtp_enabled")).is_boolean())
+      return transport_params_object.at(U("rtp_enabled")).as_bool();
+   return true;
+}
+
+//Builds the source and the raw video flow of a video stream from its essence.
+static void make_video_resources(const nmos::id& source_id, const nmos::id& flow_id, const nmos::id& device_id, const VMIP_STREAM_ESSENCE_CONFIG& essence_config, const nmos::settings& settings,
+                                 nmos::resource& source, nmos::resource& flow)
+{
+   uint32_t frame_heigth;
+   uint32_t frame_width;
+   uint32_t frame_rate;
+   nmos::rational frame_rate_rational;
+   bool8_t interlaced;
+   bool8_t is_us;
+
+   if(VMIP_GetVideoStandardInfo(essence_config.EssenceS2110_20Prop.VideoStandard, &frame_width, &frame_heigth, &frame_rate, &interlaced, &is_us) != VMIPERR_NOERROR)
+      throw std::runtime_error("Failed to get video standard info");
+
+   if(is_us)
+      frame_rate_rational = nmos::parse_rational(nmos::make_rational(frame_rate * 1000, 1001));
+   else
+      frame_rate_rational = frame_rate;
+
+   source = nmos::make_video_source(source_id, device_id, nmos::clock_names::clk0, frame_rate_rational, settings);
+   flow = nmos::make_raw_video_flow(flow_id, source_id, device_id,
+                                    frame_rate_rational,
+                                    frame_width,frame_heigth,
+                                    interlaced ? nmos::interlace_modes::interlaced_tff : nmos::interlace_modes::progressive,
+                                    nmos::colorspaces::BT709,
+                                    nmos::transfer_characteristics::SDR,
+                                    nmos_tools::to_chroma_subsampling(essence_config.EssenceS2110_20Prop.NetworkBitSampling),
+                                    nmos_tools::to_bit_depth(essence_config.EssenceS2110_20Prop.NetworkBitDepth),
+                                    settings);
+}
+
+//Gives the TAI time at which an activation was scheduled, or 0 for an immediate activation.
+//The time of a relative activation is the one nmos-cpp computed from the offset when the activation was staged.
+static uint64_t get_scheduled_activation_time(const web::json::value& activation)
+{
+   if (!activation.has_field(U("mode")) || !activation.at(U("mode")).is_string())
+      return 0;
+
+   const utility::string_t mode = activation.at(U("mode")).as_string();
+   const utility::string_t time_field = (mode == U("activate_scheduled_absolute")) ? U("requested_time")
+      : (mode == U("activate_scheduled_relative")) ? U("activation_time") : U("");
+   if (time_field.empty() || !activation.has_field(time_field) || !activation.at(time_field).is_string())
+      return 0;
+
+   return nmos_tools::parse_tai_time(activation.at(time_field).as_string());
+}
+
+nmos_tools::NodeServer::NodeServer(nmos::node_model& node_model, nmos::experimental::node_implementation node_implementation, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, std::vector<std::string> media_nic_names)
+      : node_model(node_model), gate(gate), device_name(device_name), device_description(device_description), media_nic_names(media_nic_names), is_enabled(false), sdp(""),node_server(nmos::experimental::make_node_server(node_model, node_implementation, log_model, gate))
 {
 }
 
@@ -116,76 +193,96 @@ void nmos_tools::NodeServer::system_params_handler(const web::uri &system_uri, c
 bool nmos_tools::NodeServerSender::node_implementation_init()
 {
    const unsigned int delay_millis{ 0 };
-   uint32_t frame_heigth;
-   uint32_t frame_width;
-   uint32_t frame_rate;
-   nmos::rational frame_rate_rational;
-   bool8_t interlaced;
-   bool8_t is_us;
-
 
    try
    {
       NodeServer::node_implementation_init();
 
-      if(VMIP_GetVideoStandardInfo(vmip_info.essence_config.EssenceS2110_20Prop.VideoStandard, &frame_width, &frame_heigth, &frame_rate, &interlaced, &is_us) != VMIPERR_NOERROR)
-         throw node_implementation_init_exception("Failed to get video standard info");
-
-      if(is_us)
-         frame_rate_rational = nmos::parse_rational(nmos::make_rational(frame_rate * 1000, 1001));
-      else
-         frame_rate_rational = frame_rate;
-
       const auto seed_id = nmos::experimental::fields::seed_id(node_model.settings);
 
       nmos::write_lock lock = node_model.write_lock(); // in order to update the resources
 
       //Start of sender specific part
-      //Add one source
-      const auto source_id = nmos::make_repeatable_id(seed_id, U("IPVC Video Source"));
-      const auto flow_id = nmos::make_repeatable_id(seed_id, U("IPVC Video Flow"));
-      const auto sender_id = nmos::make_repeatable_id(seed_id, U("IPVC Video Sender"));
-
-      nmos::resource source = nmos::make_video_source(source_id, device_id, nmos::clock_names::clk0, frame_rate_rational, node_model.settings);
-      source.data[nmos::fields::label] = web::json::value::string(U("IPVC Video Source"));
-      source.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card Video Source"));
-
-      nmos::resource flow = nmos::make_raw_video_flow(flow_id, source_id, device_id,
-                                                      frame_rate_rational,
-                                                      frame_width,frame_heigth,
-                                                      interlaced ? nmos::interlace_modes::interlaced_tff : nmos::interlace_modes::progressive,
-                                                      nmos::colorspaces::BT709,
-                                                      nmos::transfer_characteristics::SDR,
-                                                      nmos::chroma_subsampling::YCbCr422,
-                                                      10,
-                                                      node_model.settings);
-
-      flow.data[nmos::fields::label] = web::json::value::string(U("IPVC Video Flow"));
-      flow.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card Video Flow"));
-
-      if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(source), gate)) throw node_implementation_init_exception("Failed to insert source resource");  
-      if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(flow), gate)) throw node_implementation_init_exception("Failed to insert flow resource");
-   
-      const auto manifest_href = nmos::experimental::make_manifest_api_manifest(sender_id, node_model.settings);
-      auto sender = nmos::make_sender(sender_id, flow_id, nmos::transports::rtp, device_id, manifest_href.to_string(),{utility::conversions::to_string_t(media_nic_name)} , node_model.settings);
-      sender.data[nmos::fields::label] = web::json::value::string(U("IPVC Video Sender"));
-      sender.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card Video Sender"));
-
-      auto connection_sender = nmos::make_connection_rtp_sender(sender_id, false, utility::conversions::to_string_t(sdp));
-
-      connection_sender.data[nmos::fields::endpoint_constraints][0][nmos::fields::source_ip]
-         = web::json::value_of({
-               { nmos::fields::constraint_enum,
-               web::json::value_of({nmos_tools::ipv4_to_string(active_transport_params.ip_src)})},
-                              });
-      connection_sender.data[nmos::fields::endpoint_constraints][0][nmos::fields::source_port]
-         = web::json::value_of({
-               { nmos::fields::constraint_enum,
-               web::json::value_of({active_transport_params.port_src})},
-                              });
-
-      if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(sender), gate)) throw node_implementation_init_exception("Failed to insert sender resource");
-      if (!insert_resource_after(node_model,lock,delay_millis, node_model.connection_resources, std::move(connection_sender), gate)) throw node_implementation_init_exception("Failed to insert connection sender resource");
+      //Add one source, flow and sender per stream, all of them under the same device
+      const size_t audio_sender_count = std::count_if(senders.begin(), senders.end(),
+         [](const Sender& sender_state) { return sender_state.audio_channel_count != 0; });
+      const size_t video_sender_count = senders.size() - audio_sender_count;
+      size_t audio_sender_number = 0, video_sender_number = 0;
+
+      sender_ids.clear();
+      source_ids.clear();
+      flow_ids.clear();
+      for (size_t sender_index = 0; sender_index < senders.size(); sender_index++)
+      {
+         const Sender& sender_state = senders[sender_index];
+         const VMIP_STREAM_ESSENCE_CONFIG& essence_config = sender_state.vmip_info.essence_config;
+         const bool is_audio = (sender_state.audio_channel_count != 0);
+
+         //A single sender of a kind keeps the names, and so the ids, it always had. Several senders of a kind are numbered from 1.
+         const size_t sender_number = is_audio ? ++audio_sender_number : ++video_sender_number;
+         const utility::string_t suffix = ((is_audio ? audio_sender_count : video_sender_count) > 1) ? U(" ") + utility::conversions::to_string_t(std::to_string(sender_number)) : U("");
+         const utility::string_t kind = is_audio ? U("Audio") : U("Video");
+
+         const auto source_id = nmos::make_repeatable_id(seed_id, U("IPVC ") + kind + U(" Source") + suffix);
+         const auto flow_id = nmos::make_repeatable_id(seed_id, U("IPVC ") + kind + U(" Flow") + suffix);
+         const auto sender_id = nmos::make_repeatable_id(seed_id, U("IPVC ") + kind + U(" Sender") + suffix);
+
+         nmos::resource source;
+         nmos::resource flow;
+         if (is_audio)
+         {
+            //The grain rate of an audio source is its packet rate. The channels are not assigned to a sound field, as in the SDP.
+            const nmos::rational packet_rate = get_audio_packet_rate(sender_state.audio_packet_time);
+            std::vector<nmos::channel> channels;
+            for (uint32_t channel = 0; channel < sender_state.audio_channel_count; channel++)
+            {
+               const std::string channel_number = (channel < 9 ? "0" : "") + std::to_string(channel + 1);
+               channels.push_back({ U("Channel ") + utility::conversions::to_string_t(channel_number), nmos::channel_symbol{ U("U") + utility::conversions::to_string_t(channel_number) } });
+            }
+
+            source = nmos::make_audio_source(source_id, device_id, nmos::clock_names::clk0, packet_rate, channels, node_model.settings);
+            flow = nmos::make_raw_audio_flow(flow_id, source_id, device_id, nmos::rational(48000), 24, node_model.settings);
+         }
+         else
+            make_video_resources(source_id, flow_id, device_id, essence_config, node_model.settings, source, flow);
+
+         source.data[nmos::fields::label] = web::json::value::string(U("IPVC ") + kind + U(" Source") + suffix);
+         source.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card ") + kind + U(" Source") + suffix);
+         flow.data[nmos::fields::label] = web::json::value::string(U("IPVC ") + kind + U(" Flow") + suffix);
+         flow.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card ") + kind + U(" Flow") + suffix);
+
+         if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(source), gate)) throw node_implementation_init_exception("Failed to insert source resource");  
+         if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(flow), gate)) throw node_implementation_init_exception("Failed to insert flow resource");
+      
+         const auto manifest_href = nmos::experimental::make_manifest_api_manifest(sender_id, node_model.settings);
+         auto sender = nmos::make_sender(sender_id, flow_id, nmos::transports::rtp, device_id, manifest_href.to_string(), to_interface_bindings(media_nic_names), node_model.settings);
+         sender.data[nmos::fields::label] = web::json::value::string(U("IPVC ") + kind + U(" Sender") + suffix);
+         sender.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card ") + kind + U(" Sender") + suffix);
+
+         //With a second media NIC, the sender has two legs sending the same packets (ST2022-7), each bound to the address of its NIC.
+         auto connection_sender = nmos::make_connection_rtp_sender(sender_id, media_nic_names.size() > 1, utility::conversions::to_string_t(sender_state.sdp));
+
+         for (size_t leg = 0; leg < media_nic_names.size() && leg < max_path_count; leg++)
+         {
+            connection_sender.data[nmos::fields::endpoint_constraints][leg][nmos::fields::source_ip]
+               = web::json::value_of({
+                     { nmos::fields::constraint_enum,
+                     web::json::value_of({nmos_tools::ipv4_to_string(sender_state.resolve_auto_transport_params[leg].ip_src)})},
+                                    });
+            connection_sender.data[nmos::fields::endpoint_constraints][leg][nmos::fields::source_port]
+               = web::json::value_of({
+                     { nmos::fields::constraint_enum,
+                     web::json::value_of({sender_state.resolve_auto_transport_params[leg].port_src})},
+                                    });
+         }
+
+         if (!insert_resource_after(node_model,lock,delay_millis, node_model.node_resources, std::move(sender), gate)) throw node_implementation_init_exception("Failed to insert sender resource");
+         if (!insert_resource_after(node_model,lock,delay_millis, node_model.connection_resources, std::move(connection_sender), gate)) throw node_implementation_init_exception("Failed to insert connection sender resource");
+
+         sender_ids.push_back(sender_id);
+         source_ids.push_back(source_id);
+         flow_ids.push_back(flow_id);
+      }
    }
    catch (const node_implementation_init_exception& e)
    {
@@ -238,7 +335,7 @@ bool nmos_tools::NodeServerReceiver::node_implementation_init()
       //start of receiver specific part
       const auto receiver_id = nmos::make_repeatable_id(seed_id, U("IPVC Video Receiver"));
 
-      const std::vector<utility::string_t> media_interfaces = { utility::conversions::to_string_t(media_nic_name) };
+      const std::vector<utility::string_t> media_interfaces = to_interface_bindings(media_nic_names);
       auto receiver = nmos::make_video_receiver(receiver_id, device_id, nmos::transports::rtp, media_interfaces, node_model.settings);
       receiver.data[nmos::fields::label] = web::json::value::string(U("IPVC Video Receiver"));
       receiver.data[nmos::fields::description] = web::json::value::string(U("IP Virtual Card Video Receiver"));
@@ -246,13 +343,17 @@ bool nmos_tools::NodeServerReceiver::node_implementation_init()
       const auto interlace_modes = std::vector<utility::string_t>{ nmos::interlace_modes::progressive.name, nmos::interlace_modes::interlaced_tff.name };
       receiver.data[nmos::fields::caps][nmos::fields::constraint_sets] = generate_constraints();
 
-      auto connection_receiver = nmos::make_connection_rtp_receiver(receiver_id, false);
-      connection_receiver.data[nmos::fields::endpoint_constraints].as_array()[0].as_object()[nmos::fields::interface_ip] =
-      web::json::value_of({
-         { nmos::fields::constraint_enum,
-         web::json::value_of({ web::json::value(ipv4_to_string(active_transport_params.ip_interface)) })
-         }
-      });
+      //With a second media NIC, the receiver has two legs (ST2022-7), each bound to the address of its NIC.
+      auto connection_receiver = nmos::make_connection_rtp_receiver(receiver_id, media_nic_names.size() > 1);
+      for (size_t leg = 0; leg < media_nic_names.size() && leg < max_path_count; leg++)
+      {
+         connection_receiver.data[nmos::fields::endpoint_constraints].as_array()[leg].as_object()[nmos::fields::interface_ip] =
+         web::json::value_of({
+            { nmos::fields::constraint_enum,
+            web::json::value_of({ web::json::value(ipv4_to_string(active_transport_params[leg].ip_interface)) })
+            }
+         });
+      }
 
       if (!insert_resource_after(node_model, lock, delay_millis, node_model.node_resources, std::move(receiver), gate)) throw node_implementation_init_exception("Failed to insert receiver resource");
       if (!insert_resource_after(node_model, lock, delay_millis, node_model.connection_resources, std::move(connection_receiver), gate)) throw node_implementation_init_exception("Failed to insert connection receiver resource");
@@ -325,10 +426,53 @@ bool nmos_tools::NodeServer::is_field_auto(const web::json::value &object, const
           object.at(field_name).as_string() == U("auto");
 }
 
-nmos_tools::NodeServerSender::NodeServerSender(nmos::node_model &node_model, nmos::experimental::log_model &log_model, slog::base_gate &gate, const std::string device_name, const std::string device_description, VmipInfo vmip_info, TransportParams &resolve_auto_transport_params, TransportParams &active_transport_params, std::string media_nic_name, std::string sdp)
-: NodeServer(node_model, make_node_implementation(), log_model, gate, device_name, device_description, media_nic_name), vmip_info(vmip_info), resolve_auto_transport_params(resolve_auto_transport_params), active_transport_params(active_transport_params)
+nmos_tools::NodeServerSender::NodeServerSender(nmos::node_model &node_model, nmos::experimental::log_model &log_model, slog::base_gate &gate, const std::string device_name, const std::string device_description, std::vector<Sender> &senders, std::vector<std::string> media_nic_names)
+: NodeServer(node_model, make_node_implementation(), log_model, gate, device_name, device_description, media_nic_names), senders(senders)
+{
+}
+
+bool nmos_tools::NodeServerSender::update_video_format(size_t sender_index, const VMIP_STREAM_ESSENCE_CONFIG& essence_config, const std::string& sdp)
 {
-   this->sdp = sdp;
+   try
+   {
+      nmos::write_lock lock = node_model.write_lock(); // in order to update the resources
+
+      Sender& sender_state = senders.at(sender_index);
+      sender_state.vmip_info.essence_config = essence_config;
+      sender_state.sdp = sdp;
+
+      //The source and the flow are replaced under the same ids, with a new version. Their labels are kept.
+      nmos::resource source;
+      nmos::resource flow;
+      make_video_resources(source_ids.at(sender_index), flow_ids.at(sender_index), device_id, essence_config, node_model.settings, source, flow);
+
+      auto replace_data = [](const web::json::value& data)
+      {
+         return [&data](nmos::resource& resource)
+         {
+            web::json::value updated_data = data;
+            updated_data[nmos::fields::label] = resource.data.at(nmos::fields::label);
+            updated_data[nmos::fields::description] = resource.data.at(nmos::fields::description);
+            resource.data = updated_data;
+         };
+      };
+      nmos::modify_resource(node_model.node_resources, source_ids[sender_index], replace_data(source.data));
+      nmos::modify_resource(node_model.node_resources, flow_ids[sender_index], replace_data(flow.data));
+
+      //The transport file is otherwise only generated on activation.
+      nmos::modify_resource(node_model.connection_resources, sender_ids.at(sender_index), [&sdp](nmos::resource& connection_sender)
+      {
+         connection_sender.data[nmos::fields::endpoint_transportfile][U("data")] = web::json::value::string(utility::conversions::to_string_t(sdp));
+      });
+
+      node_model.notify();
+   }
+   catch (const std::exception& e)
+   {
+      slog::log<slog::severities::error>(gate, SLOG_FLF) << "Error when updating the video format: " << e.what();
+      return false;
+   }
+   return true;
 }
 
 nmos::experimental::node_implementation nmos_tools::NodeServerSender::make_node_implementation()
@@ -342,6 +486,21 @@ nmos::experimental::node_implementation nmos_tools::NodeServerSender::make_node_
    return node_implementation;
 }
 
+nmos_tools::NodeServerSender::ActivationState nmos_tools::NodeServerSender::Sender::get_activation_state()
+{
+   std::lock_guard lock(activation_state_mutex);
+   return activation_state;
+}
+
+nmos_tools::NodeServerSender::Sender& nmos_tools::NodeServerSender::find_sender(const nmos::id& sender_id)
+{
+   const auto sender_id_it = std::find(sender_ids.begin(), sender_ids.end(), sender_id);
+   if (sender_id_it == sender_ids.end())
+      throw web::json::json_exception("Unknown sender");
+
+   return senders[sender_id_it - sender_ids.begin()];
+}
+
 void nmos_tools::NodeServerSender::resolve_auto(const nmos::resource &resource, const nmos::resource &connection_resource, web::json::value &transport_params)
 {
    // debug log the json objects
@@ -349,8 +508,14 @@ void nmos_tools::NodeServerSender::resolve_auto(const nmos::resource &resource,
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "resolve_auto_sender: connection_resource: " << std::endl << connection_resource.data.serialize();
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "resolve_auto_sender: transport_params: " << std::endl << transport_params.serialize();
 
-   for (auto& transport_param : transport_params.as_array())
+   const TransportLegs& resolve_auto_transport_legs = find_sender(resource.id).resolve_auto_transport_params;
+
+   //Each leg is resolved with the parameters of its own NIC.
+   for (size_t leg = 0; leg < transport_params.as_array().size() && leg < max_path_count; leg++)
    {
+      web::json::value& transport_param = transport_params.as_array().at(leg);
+      const TransportParams& resolve_auto_transport_params = resolve_auto_transport_legs[leg];
+
       if (is_field_auto(transport_param, nmos::fields::destination_ip))
       {
          transport_param[nmos::fields::destination_ip] = web::json::value::string(ipv4_to_string(resolve_auto_transport_params.ip_dst));
@@ -373,8 +538,8 @@ void nmos_tools::NodeServerSender::resolve_auto(const nmos::resource &resource,
 
 }
 
-nmos_tools::NodeServerReceiver::NodeServerReceiver(nmos::node_model &node_model, nmos::experimental::log_model &log_model, slog::base_gate &gate, const std::string device_name, const std::string device_description, TransportParams &resolve_auto_transport_params, TransportParams &active_transport_params, std::string media_nic_name)
-: NodeServer(node_model, make_node_implementation(), log_model, gate, device_name, device_description, media_nic_name), resolve_auto_transport_params(resolve_auto_transport_params), active_transport_params(active_transport_params)
+nmos_tools::NodeServerReceiver::NodeServerReceiver(nmos::node_model &node_model, nmos::experimental::log_model &log_model, slog::base_gate &gate, const std::string device_name, const std::string device_description, TransportLegs &resolve_auto_transport_params, TransportLegs &active_transport_params, std::vector<std::string> media_nic_names)
+: NodeServer(node_model, make_node_implementation(), log_model, gate, device_name, device_description, media_nic_names), resolve_auto_transport_params(resolve_auto_transport_params), active_transport_params(active_transport_params), activation_time(0)
 {
 }
 
@@ -396,8 +561,12 @@ void nmos_tools::NodeServerReceiver::resolve_auto(const nmos::resource &resource
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "resolve_auto_sender: connection_resource: " << std::endl << connection_resource.data.serialize();
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "resolve_auto_sender: transport_params: " << std::endl << transport_params.serialize();
 
-   for (auto& transport_param : transport_params.as_array())
+   //Each leg is resolved with the parameters of its own NIC.
+   for (size_t leg = 0; leg < transport_params.as_array().size() && leg < max_path_count; leg++)
    {
+      web::json::value& transport_param = transport_params.as_array().at(leg);
+      const TransportParams& resolve_auto_transport_params = this->resolve_auto_transport_params[leg];
+
       if (is_field_auto(transport_param, nmos::fields::interface_ip))
       {
          transport_param[nmos::fields::interface_ip] = web::json::value::string(ipv4_to_string(resolve_auto_transport_params.ip_interface));
@@ -426,6 +595,38 @@ void nmos_tools::NodeServerSender::patch_validator(const nmos::resource &resourc
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "patch_validator: connection_resource: " << std::endl << connection_resource.data.serialize();
    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "patch_validator: endpoint_staged: " << std::endl << endpoint_staged.serialize();
 
+   //A scheduled activation is known here, ahead of its time : the sample can prepare the stream of the staged parameters before it is due.
+   Sender& sender = find_sender(resource.id);
+   const web::json::value& activation = endpoint_staged.at(nmos::fields::activation);
+   const utility::string_t mode = (activation.has_field(U("mode")) && activation.at(U("mode")).is_string()) ? activation.at(U("mode")).as_string() : U("");
+   if ((mode != U("activate_scheduled_absolute") && mode != U("activate_scheduled_relative")) || !activation.has_field(U("requested_time")) || !activation.at(U("requested_time")).is_string())
+   {
+      std::lock_guard lock(sender.activation_state_mutex);
+      sender.activation_state.staged_activation_time = 0;
+      return;
+   }
+
+   TransportLegs staged_transport_params = sender.get_activation_state().active_transport_params;
+   const web::json::array& staged_transport_params_array = endpoint_staged.at(nmos::fields::transport_params).as_array();
+   for (size_t leg = 0; leg < staged_transport_params_array.size() && leg < max_path_count; leg++)
+   {
+      const web::json::value& staged_leg = staged_transport_params_array.at(leg);
+      const TransportParams& resolve_auto_transport_params = sender.resolve_auto_transport_params[leg];
+      TransportParams& staged = staged_transport_params[leg];
+
+      staged.ip_dst = is_field_auto(staged_leg, nmos::fields::destination_ip) ? resolve_auto_transport_params.ip_dst : string_to_ipv4(get_string_field(staged_leg.as_object(), nmos::fields::destination_ip));
+      staged.port_dst = is_field_auto(staged_leg, nmos::fields::destination_port) ? resolve_auto_transport_params.port_dst : staged_leg.at(nmos::fields::destination_port).as_integer();
+      staged.ip_src = is_field_auto(staged_leg, nmos::fields::source_ip) ? resolve_auto_transport_params.ip_src : string_to_ipv4(get_string_field(staged_leg.as_object(), nmos::fields::source_ip));
+      staged.port_src = is_field_auto(staged_leg, nmos::fields::source_port) ? resolve_auto_transport_params.port_src : staged_leg.at(nmos::fields::source_port).as_integer();
+      staged.rtp_enabled = is_rtp_enabled(staged_leg.as_object());
+   }
+
+   const uint64_t requested_time = parse_tai_time(activation.at(U("requested_time")).as_string());
+   const uint64_t staged_activation_time = (mode == U("activate_scheduled_absolute")) ? requested_time : get_tai_time() + requested_time;
+
+   std::lock_guard lock(sender.activation_state_mutex);
+   sender.activation_state.staged_transport_params = staged_transport_params;
+   sender.activation_state.staged_activation_time = staged_activation_time;
 }
 
 void nmos_tools::NodeServerReceiver::patch_validator(const nmos::resource &resource, const nmos::resource &connection_resource, const web::json::value &endpoint_staged)
@@ -449,15 +650,31 @@ void nmos_tools::NodeServerSender::connection_activation(const nmos::resource& r
 
    //parameters have been activated, communicate those modifications to the sample in order to reflect the model changes
 
-   is_enabled = connection_resource.data.at(nmos::fields::active).at(nmos::fields::master_enable).as_bool();
+   Sender& sender = find_sender(resource.id);
+   ActivationState activation_state = sender.get_activation_state();
+
+   //The sample applies a scheduled activation on the first frame boundary at or after its time, the schedule must be known when it sees the new parameters.
+   activation_state.activation_time = get_scheduled_activation_time(connection_resource.data.at(nmos::fields::active).at(nmos::fields::activation));
+   activation_state.staged_activation_time = 0;
 
    const web::json::array& active_transport_params_array = connection_resource.data.at(nmos::fields::active).at(nmos::fields::transport_params).as_array();
-   const web::json::object& active_transport_params_object = active_transport_params_array.at(0).as_object();
+   for (size_t leg = 0; leg < active_transport_params_array.size() && leg < max_path_count; leg++)
+   {
+      const web::json::object& active_transport_params_object = active_transport_params_array.at(leg).as_object();
+      TransportParams& active_transport_params = activation_state.active_transport_params[leg];
+
+      active_transport_params.ip_dst = string_to_ipv4(active_transport_params_object.at(nmos::fields::destination_ip).as_string());
+      active_transport_params.port_dst = active_transport_params_object.at(nmos::fields::destination_port).as_integer();
+      active_transport_params.ip_src = string_to_ipv4(active_transport_params_object.at(nmos::fields::source_ip).as_string());
+      active_transport_params.port_src = active_transport_params_object.at(nmos::fields::source_port).as_integer();
+      active_transport_params.rtp_enabled = is_rtp_enabled(active_transport_params_object);
+   }
 
-   active_transport_params.ip_dst = string_to_ipv4(active_transport_params_object.at(nmos::fields::destination_ip).as_string());
-   active_transport_params.port_dst = active_transport_params_object.at(nmos::fields::destination_port).as_integer();
-   active_transport_params.ip_src = string_to_ipv4(active_transport_params_object.at(nmos::fields::source_ip).as_string());
-   active_transport_params.port_src = active_transport_params_object.at(nmos::fields::source_port).as_integer();
+   activation_state.is_enabled = connection_resource.data.at(nmos::fields::active).at(nmos::fields::master_enable).as_bool();
+
+   //The transmission thread sees the legs, the enable and the times of the activation together.
+   std::lock_guard lock(sender.activation_state_mutex);
+   sender.activation_state = activation_state;
 
 }
 
@@ -469,24 +686,24 @@ void nmos_tools::NodeServerReceiver::connection_activation(const nmos::resource
 
    //parameters have been activated, communicate those modifications to the sample in order to reflect the model changes
 
+   //The sample applies a scheduled activation on the first frame boundary at or after its time, the schedule must be known when it sees the new parameters.
+   activation_time = get_scheduled_activation_time(connection_resource.data.at(nmos::fields::active).at(nmos::fields::activation));
+
    is_enabled = connection_resource.data.at(nmos::fields::active).at(nmos::fields::master_enable).as_bool();
 
+   //string_to_ipv4 gives 0 for the absent or null addresses : no multicast, no source filtering.
    const web::json::array& active_transport_params_array = connection_resource.data.at(nmos::fields::active).at(nmos::fields::transport_params).as_array();
-   const web::json::object& active_transport_params_object = active_transport_params_array.at(0).as_object();
-
-   if(active_transport_params_object.find(nmos::fields::interface_ip) != active_transport_params_object.end() && active_transport_params_object.at(nmos::fields::interface_ip).is_string())
-      active_transport_params.ip_interface = string_to_ipv4(active_transport_params_object.at(nmos::fields::interface_ip).as_string());
-   else
-      active_transport_params.ip_interface = 0;
-   if(active_transport_params_object.find(nmos::fields::multicast_ip) != active_transport_params_object.end() && active_transport_params_object.at(nmos::fields::multicast_ip).is_string())
-      active_transport_params.ip_multicast = string_to_ipv4(active_transport_params_object.at(nmos::fields::multicast_ip).as_string());
-   else
-      active_transport_params.ip_multicast = 0;
-   if(active_transport_params_object.find(nmos::fields::source_ip) != active_transport_params_object.end() && active_transport_params_object.at(nmos::fields::source_ip).is_string())
-      active_transport_params.ip_src = string_to_ipv4(active_transport_params_object.at(nmos::fields::source_ip).as_string());
-   else
-      active_transport_params.ip_src = 0;
-   active_transport_params.port_dst = active_transport_params_object.at(nmos::fields::destination_port).as_integer();
+   for (size_t leg = 0; leg < active_transport_params_array.size() && leg < max_path_count; leg++)
+   {
+      const web::json::object& active_transport_params_object = active_transport_params_array.at(leg).as_object();
+      TransportParams& leg_transport_params = active_transport_params[leg];
+
+      leg_transport_params.ip_interface = string_to_ipv4(get_string_field(active_transport_params_object, nmos::fields::interface_ip));
+      leg_transport_params.ip_multicast = string_to_ipv4(get_string_field(active_transport_params_object, nmos::fields::multicast_ip));
+      leg_transport_params.ip_src = string_to_ipv4(get_string_field(active_transport_params_object, nmos::fields::source_ip));
+      leg_transport_params.port_dst = active_transport_params_object.at(nmos::fields::destination_port).as_integer();
+      leg_transport_params.rtp_enabled = is_rtp_enabled(active_transport_params_object);
+   }
 
    const web::json::object& transport_file = connection_resource.data.at(nmos::fields::active).at(nmos::fields::transport_file).as_object();
    if(transport_file.find(nmos::fields::data) != transport_file.end() && transport_file.at(nmos::fields::data).is_string())
@@ -506,16 +723,32 @@ void nmos_tools::NodeServerSender::transportfile_setter(const nmos::resource& se
 
    const web::json::array& active_transport_params = connection_sender.data.at(U("active")).at(U("transport_params")).as_array();
 
-   vmip_info.stream_network_config.pPathParameters[0].DestinationIp = string_to_ipv4(active_transport_params.at(0).at(U("destination_ip")).as_string());
-   vmip_info.stream_network_config.pPathParameters[0].UdpPort = active_transport_params.at(0).at(U("destination_port")).as_integer();
+   Sender& sender_state = find_sender(sender.id);
+   VmipInfo& vmip_info = sender_state.vmip_info;
+
+   //The SDP describes the enabled legs only, each one keeping the NIC of its path.
+   VMIP_STREAM_NETWORK_CONFIG stream_network_config = vmip_info.stream_network_config;
+   stream_network_config.PathParameterSize = 0;
+   for (size_t leg = 0; leg < active_transport_params.size() && leg < vmip_info.stream_network_config.PathParameterSize; leg++)
+   {
+      if (!is_rtp_enabled(active_transport_params.at(leg).as_object()))
+         continue;
+
+      VMIP_PATH_PARAMETERS& path_parameters = stream_network_config.pPathParameters[stream_network_config.PathParameterSize++];
+      path_parameters = vmip_info.stream_network_config.pPathParameters[leg];
+      path_parameters.DestinationIp = string_to_ipv4(active_transport_params.at(leg).at(U("destination_ip")).as_string());
+      path_parameters.UdpPort = active_transport_params.at(leg).at(U("destination_port")).as_integer();
+   }
+   if (stream_network_config.PathParameterSize == 0)
+      throw web::json::json_exception("No leg is enabled");
    //sdp must be set before the stream restart, so we have to call generate sdp here
 
    //generate sdp
-   VMIP_ERRORCODE result = generate_sdp(vmip_info.vcs_context, vmip_info.stream_network_config, vmip_info.essence_config, &sdp);
+   VMIP_ERRORCODE result = generate_sdp(vmip_info.vcs_context, stream_network_config, vmip_info.essence_config, &sender_state.sdp);
 
    if(result == VMIPERR_NOERROR){
       //update sdp
-      endpoint_transportfile.at(U("data")) = web::json::value::string(utility::conversions::to_string_t(sdp));
+      endpoint_transportfile.at(U("data")) = web::json::value::string(utility::conversions::to_string_t(sender_state.sdp));
    }
    else{
       throw web::json::json_exception("Error while generating SDP");
@@ -580,6 +813,21 @@ utility::string_t nmos_tools::ipv4_to_string(uint32_t ipv4_network_byte_order)
    return utility::conversions::to_string_t(ss.str());
 }
 
+uint64_t nmos_tools::get_tai_time()
+{
+   const nmos::tai now = nmos::tai_now();
+   return static_cast<uint64_t>(now.seconds) * 1000000000 + static_cast<uint64_t>(now.nanoseconds);
+}
+
+uint64_t nmos_tools::parse_tai_time(const utility::string_t& tai_string)
+{
+   std::string utf8_str = utility::conversions::to_utf8string(tai_string);
+   unsigned long long seconds = 0, nanoseconds = 0;
+   if (sscanf(utf8_str.c_str(), "%llu:%llu", &seconds, &nanoseconds) != 2)
+      return 0;
+   return static_cast<uint64_t>(seconds) * 1000000000 + static_cast<uint64_t>(nanoseconds);
+}
+
 uint32_t nmos_tools::string_to_ipv4(const utility::string_t& ipv4_string)
 {
    std::string utf8_str = utility::conversions::to_utf8string(ipv4_string);
@@ -595,3 +843,25 @@ uint32_t nmos_tools::string_to_ipv4(const utility::string_t& ipv4_string)
    }
    return ipv4_network_byte_order;
 }
+
+nmos::chroma_subsampling nmos_tools::to_chroma_subsampling(VMIP_VIDEO_SAMPLING video_sampling)
+{
+   switch (video_sampling)
+   {
+   case VMIP_VIDEO_SAMPLING_YCBCR_444: return nmos::chroma_subsampling{ U("YCbCr-4:4:4") };
+   case VMIP_VIDEO_SAMPLING_RGB_444: return nmos::chroma_subsampling::RGB444;
+   case VMIP_VIDEO_SAMPLING_YCBCR_422:
+   default: return nmos::chroma_subsampling::YCbCr422;
+   }
+}
+
+unsigned int nmos_tools::to_bit_depth(VMIP_VIDEO_DEPTH video_depth)
+{
+   switch (video_depth)
+   {
+   case VMIP_VIDEO_DEPTH_8BIT: return 8;
+   case VMIP_VIDEO_DEPTH_12BIT: return 12;
+   case VMIP_VIDEO_DEPTH_10BIT:
+   default: return 10;
+   }
+}
@@ -20,9 +20,15 @@
 #include "nmos/mutex.h"
 #include <videomasterip/videomasterip_core.h>
 #include <videomasterip/videomasterip_stream.h>
+#include "tools.h"
+#include <array>
+#include <vector>
+#include <mutex>
 
 namespace nmos_tools
 {
+   constexpr uint32_t max_path_count = 2; /*! Paths of a stream, sent or received on a NIC each. Two paths carry the same packets, as specified in the norm ST2022-7 */
+
    struct VmipInfo{
       HANDLE vcs_context;
       VMIP_STREAM_NETWORK_CONFIG stream_network_config;
@@ -41,7 +47,7 @@ namespace nmos_tools
       bool is_enabled;
 
       NodeServer(nmos::node_model& node_model, nmos::experimental::node_implementation node_implementation, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, 
-                 std::string media_nic_name);
+                 std::vector<std::string> media_nic_names);
 
       bool get_ptp_system_parameters(NmosPtpSystemParameters& ptp_system_parameters);
 
@@ -53,7 +59,7 @@ namespace nmos_tools
       //parameters
       nmos::node_model& node_model;
       slog::base_gate& gate;
-      std::string media_nic_name;
+      std::vector<std::string> media_nic_names /*! Media NIC of each path, a second NIC adding an ST2022-7 leg to the streams */;
       std::string sdp;
       const std::string device_name;
       const std::string device_description;
@@ -104,22 +110,49 @@ namespace nmos_tools
          uint16_t port_src /*! Source port. */;
          uint32_t ip_dst   /*! Destination IP address. */;
          uint16_t port_dst /*! Destination port. */;
+         bool rtp_enabled  /*! The packets are sent on this leg. */;
       };
 
-      TransportParams& active_transport_params;
+      typedef std::array<TransportParams, max_path_count> TransportLegs; /*! Transport parameters of each leg, one leg per media NIC */
+
+      struct ActivationState{
+         TransportLegs active_transport_params          /*! Transport parameters of the last activation. */;
+         bool is_enabled                                /*! Master enable of the last activation. */;
+         uint64_t activation_time                       /*! TAI time in nanoseconds at which the last activation was scheduled, 0 if it was immediate. */;
+         TransportLegs staged_transport_params          /*! Transport parameters of the staged scheduled activation, the auto fields resolved. */;
+         uint64_t staged_activation_time                /*! TAI time in nanoseconds of the staged scheduled activation, 0 if none is staged. */;
+      }; /*! Activation state of a sender, written by the connection API and read by the transmission thread */;
+
+      struct Sender{
+         VmipInfo vmip_info                             /*! Stream of the sender, with a path per media NIC. */;
+         TransportLegs resolve_auto_transport_params    /*! Transport parameters given to the fields set to auto. */;
+         std::string sdp                                /*! Transport file of the sender. */;
+         uint32_t audio_channel_count                   /*! Channels of an audio sender, 0 for a video sender. */;
+         AudioPacketTime audio_packet_time              /*! Duration of the samples of a packet of an audio sender. */;
+         ActivationState activation_state               /*! Activation state, guarded by activation_state_mutex. */;
+         std::mutex activation_state_mutex;
 
-      NodeServerSender(nmos::node_model& node_model, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, VmipInfo vmip_info, TransportParams& resolve_auto_transport_params, TransportParams& active_transport_params,
-                     std::string media_nic_name, std::string sdp = "");
+         // copy of the activation state, taken under its lock
+         ActivationState get_activation_state();
+      }; /*! State of one sender of the device, updated by the connection API */;
+
+      NodeServerSender(nmos::node_model& node_model, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, std::vector<Sender>& senders,
+                     std::vector<std::string> media_nic_names);
 
       bool node_implementation_init() override;
 
-   private:
+      // change the video format of the sender at the given index : its source and flow follow the new essence of its stream, and its transport file the new SDP
+      bool update_video_format(size_t sender_index, const VMIP_STREAM_ESSENCE_CONFIG& essence_config, const std::string& sdp);
 
-      VmipInfo vmip_info;
+   private:
 
-      TransportParams& resolve_auto_transport_params;
+      std::vector<Sender>& senders;
+      std::vector<nmos::id> sender_ids;
+      std::vector<nmos::id> source_ids;
+      std::vector<nmos::id> flow_ids;
 
       nmos::experimental::node_implementation make_node_implementation();
+      Sender& find_sender(const nmos::id& sender_id);
 
       void resolve_auto(const nmos::resource& resource, const nmos::resource& connection_resource, web::json::value& transport_params) override;
       void patch_validator(const nmos::resource& resource, const nmos::resource& connection_resource, const web::json::value& endpoint_staged) override;
@@ -137,12 +170,16 @@ namespace nmos_tools
          uint32_t ip_multicast /*! Multicast destination ip : can be equal to 0 if unicast used. */;
          uint32_t ip_src /*! Source ip : filtering, if equals to 0 disable filtering. */;
          uint16_t port_dst /*! Destination port. */;
+         bool rtp_enabled /*! The packets are received on this leg. */;
       };
 
-      TransportParams& active_transport_params;
+      typedef std::array<TransportParams, max_path_count> TransportLegs; /*! Transport parameters of each leg, one leg per media NIC */
 
-      NodeServerReceiver(nmos::node_model& node_model, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, TransportParams& resolve_auto_transport_params, TransportParams& active_transport_params,
-                        std::string media_nic_name);
+      TransportLegs& active_transport_params;
+      uint64_t activation_time /*! TAI time in nanoseconds at which the last activation was scheduled, 0 if it was immediate. */;
+
+      NodeServerReceiver(nmos::node_model& node_model, nmos::experimental::log_model& log_model, slog::base_gate& gate, const std::string device_name, const std::string device_description, TransportLegs& resolve_auto_transport_params, TransportLegs& active_transport_params,
+                        std::vector<std::string> media_nic_names);
 
       bool node_implementation_init() override;
 
@@ -150,7 +187,7 @@ namespace nmos_tools
 
    private:
 
-      TransportParams& resolve_auto_transport_params;
+      TransportLegs& resolve_auto_transport_params;
 
       nmos::experimental::node_implementation make_node_implementation();
 
@@ -167,5 +204,17 @@ namespace nmos_tools
 
    // convert the given string representation of an ipv4 address of the form "a.b.c.d" to an ipv4 address in network byte order
    uint32_t string_to_ipv4(const utility::string_t& ipv4_string);
+
+   // get the current TAI time in nanoseconds, from the clock on which nmos-cpp schedules the activations
+   uint64_t get_tai_time();
+
+   // convert the given TAI time of the form "seconds:nanoseconds" to nanoseconds
+   uint64_t parse_tai_time(const utility::string_t& tai_string);
+
+   // convert the given VMIP video sampling to the chroma subsampling of an NMOS raw video flow
+   nmos::chroma_subsampling to_chroma_subsampling(VMIP_VIDEO_SAMPLING video_sampling);
+
+   // convert the given VMIP video depth to the bit depth of an NMOS raw video flow
+   unsigned int to_bit_depth(VMIP_VIDEO_DEPTH video_depth);
 }
 
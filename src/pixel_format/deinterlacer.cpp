@@ -0,0 +1,279 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "deinterlacer.h"
+#include "../cpu_features.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+/*!
+   @brief Smallest run of bytes holding a whole number of samples of a given depth.
+*/
+template <uint32_t depth>
+struct SampleUnit
+{
+   static constexpr uint32_t size = (depth == 8) ? 1 : (depth == 10) ? 5 : 3; /*! Size of the run in bytes */
+   static constexpr uint32_t bits = size * 8;
+
+   //Every bit of the run except the most significant bit of each sample : (a ^ b) >> 1 must not carry a bit into the sample below.
+   static constexpr uint64_t carry_mask()
+   {
+      uint64_t mask = (bits == 64) ? ~0ull : ((1ull << bits) - 1);
+      for (uint32_t msb = depth - 1; msb < bits; msb += depth)
+         mask &= ~(1ull << msb);
+      return mask;
+   }
+};
+
+//Average of every sample of two runs, rounded up. (a | b) - ((a ^ b) >> 1) is the rounded up average of each sample,
+//no sample borrowing from its neighbour as (a | b) is never smaller than (a ^ b) >> 1.
+template <uint32_t depth>
+static inline uint64_t average_samples(uint64_t a, uint64_t b)
+{
+   return (a | b) - (((a ^ b) >> 1) & SampleUnit<depth>::carry_mask());
+}
+
+template <uint32_t depth>
+static void average_lines_scalar(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint8_t* average)
+{
+   constexpr uint32_t unit_size = SampleUnit<depth>::size;
+
+   for (uint32_t i = 0; i + unit_size <= line_size; i += unit_size)
+   {
+      uint64_t a = 0, b = 0;
+      for (uint32_t byte = 0; byte < unit_size; byte++)
+      {
+         a = (a << 8) | line_a[i + byte];
+         b = (b << 8) | line_b[i + byte];
+      }
+
+      const uint64_t result = average_samples<depth>(a, b);
+      for (uint32_t byte = 0; byte < unit_size; byte++)
+         average[i + byte] = static_cast<uint8_t>(result >> (8 * (unit_size - 1 - byte)));
+   }
+}
+
+#if CPU_FEATURES_X86
+TARGET_AVX2 static void average_lines_8bit_avx2(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint8_t* average)
+{
+   uint32_t i = 0;
+   for (; i + 32 <= line_size; i += 32)
+   {
+      const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line_a + i));
+      const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line_b + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(average + i), _mm256_avg_epu8(a, b));
+   }
+
+   average_lines_scalar<8>(line_a + i, line_b + i, line_size - i, average + i);
+}
+
+TARGET_AVX2 static inline __m256i load_lanes_avx2(const uint8_t* low_lane, const uint8_t* high_lane)
+{
+   return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low_lane))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(high_lane)), 1);
+}
+
+//Each 128 bits lane holds two groups of group_size bytes, byte swapped into 64 bits integers to be averaged,
+//then swapped back. Each lane is stored with 16 bytes, the bytes after the two groups being rewritten by the next iteration.
+template <uint32_t depth>
+TARGET_AVX2 static void average_lines_avx2(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint8_t* average)
+{
+   constexpr uint32_t unit_size = SampleUnit<depth>::size;
+   constexpr uint32_t group_size = (unit_size * 2 <= 8) ? unit_size * 2 : unit_size; /*! 5 bytes for 10 bits, 6 bytes for 12 bits */
+   constexpr uint32_t lane_size = 2 * group_size;
+
+   alignas(32) int8_t to_integers[32], to_bytes[32];
+   for (int lane = 0; lane < 2; lane++)
+   {
+      for (int byte = 0; byte < 16; byte++)
+      {
+         const int group = byte / 8, position = byte % 8;
+         to_integers[16 * lane + byte] = (position < static_cast<int>(group_size)) ? static_cast<int8_t>(group * group_size + group_size - 1 - position) : -1;
+         const int output_group = byte / group_size, output_position = byte % group_size;
+         to_bytes[16 * lane + byte] = (byte < static_cast<int>(lane_size)) ? static_cast<int8_t>(8 * output_group + group_size - 1 - output_position) : -1;
+      }
+   }
+   const __m256i integer_shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(to_integers));
+   const __m256i byte_shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(to_bytes));
+   constexpr uint64_t group_carry_mask = (group_size == unit_size) ? SampleUnit<depth>::carry_mask()
+      : SampleUnit<depth>::carry_mask() | (SampleUnit<depth>::carry_mask() << SampleUnit<depth>::bits);
+   const __m256i carry_mask = _mm256_set1_epi64x(static_cast<long long>(group_carry_mask));
+
+   uint32_t i = 0;
+   for (; i + lane_size + 16 <= line_size; i += 2 * lane_size)
+   {
+      const __m256i a = _mm256_shuffle_epi8(load_lanes_avx2(line_a + i, line_a + i + lane_size), integer_shuffle);
+      const __m256i b = _mm256_shuffle_epi8(load_lanes_avx2(line_b + i, line_b + i + lane_size), integer_shuffle);
+      const __m256i result = _mm256_sub_epi64(_mm256_or_si256(a, b), _mm256_and_si256(_mm256_srli_epi64(_mm256_xor_si256(a, b), 1), carry_mask));
+      const __m256i bytes = _mm256_shuffle_epi8(result, byte_shuffle);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(average + i), _mm256_castsi256_si128(bytes));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(average + i + lane_size), _mm256_extracti128_si256(bytes, 1));
+   }
+
+   average_lines_scalar<depth>(line_a + i, line_b + i, line_size - i, average + i);
+}
+
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (get_cpu_features().avx2 ? avx2_kernel : scalar_kernel)
+#else
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (scalar_kernel)
+#endif
+
+typedef void (*AverageLinesFunction)(const uint8_t*, const uint8_t*, uint32_t, uint8_t*);
+
+bool average_packed_lines_scalar(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint32_t sample_depth, uint8_t* average)
+{
+   switch (sample_depth)
+   {
+   case 8: average_lines_scalar<8>(line_a, line_b, line_size, average); return true;
+   case 10: average_lines_scalar<10>(line_a, line_b, line_size, average); return true;
+   case 12: average_lines_scalar<12>(line_a, line_b, line_size, average); return true;
+   default: return false;
+   }
+}
+
+bool average_packed_lines(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint32_t sample_depth, uint8_t* average)
+{
+   static const AverageLinesFunction average_8bit = SELECT_KERNEL(average_lines_8bit_avx2, average_lines_scalar<8>);
+   static const AverageLinesFunction average_10bit = SELECT_KERNEL(average_lines_avx2<10>, average_lines_scalar<10>);
+   static const AverageLinesFunction average_12bit = SELECT_KERNEL(average_lines_avx2<12>, average_lines_scalar<12>);
+
+   switch (sample_depth)
+   {
+   case 8: average_8bit(line_a, line_b, line_size, average); return true;
+   case 10: average_10bit(line_a, line_b, line_size, average); return true;
+   case 12: average_12bit(line_a, line_b, line_size, average); return true;
+   default: return false;
+   }
+}
+
+Deinterlacer::Deinterlacer(uint32_t line_size, uint32_t frame_height, uint32_t sample_depth)
+   : line_size(line_size), frame_height(frame_height), sample_depth(sample_depth)
+{
+}
+
+bool Deinterlacer::deinterlace(DeinterlaceMode mode, const uint8_t* fields, uint8_t* frame)
+{
+   if (fields == nullptr || frame == nullptr || frame_height == 0)
+      return false;
+
+   const bool in_place = (fields == frame);
+   switch (mode)
+   {
+   case DeinterlaceMode::weave:
+      if (in_place)
+         weave_in_place(frame);
+      else
+         weave(fields, frame);
+      return true;
+   case DeinterlaceMode::bob_first_field:
+   case DeinterlaceMode::bob_second_field:
+   {
+      const uint32_t field = (mode == DeinterlaceMode::bob_first_field) ? 0 : 1;
+      if (sample_depth != 8 && sample_depth != 10 && sample_depth != 12)
+         return false;
+      if (frame_height < 2 && field == 1)
+         return false;
+      if (in_place)
+         bob_in_place(field, frame);
+      else
+         bob(field, fields + field_offset(field), frame);
+      return true;
+   }
+   default:
+      return false;
+   }
+}
+
+uint32_t Deinterlacer::field_line(uint32_t picture_line) const
+{
+   return (picture_line % 2 == 0) ? picture_line / 2 : (frame_height + 1) / 2 + picture_line / 2;
+}
+
+size_t Deinterlacer::field_offset(uint32_t field) const
+{
+   return (field == 0) ? 0 : static_cast<size_t>((frame_height + 1) / 2) * line_size;
+}
+
+uint32_t Deinterlacer::field_line_count(uint32_t field) const
+{
+   return (field == 0) ? (frame_height + 1) / 2 : frame_height / 2;
+}
+
+void Deinterlacer::weave(const uint8_t* fields, uint8_t* frame)
+{
+   for (uint32_t line = 0; line < frame_height; line++)
+      std::memcpy(frame + static_cast<size_t>(line) * line_size, fields + static_cast<size_t>(field_line(line)) * line_size, line_size);
+}
+
+void Deinterlacer::weave_in_place(uint8_t* frame)
+{
+   //Interleaving the fields is a permutation of the lines : each cycle of the permutation is walked once, a single line being saved.
+   line_buffer.resize(line_size);
+   moved_lines.assign(frame_height, false);
+
+   for (uint32_t start = 0; start < frame_height; start++)
+   {
+      if (moved_lines[start] || field_line(start) == start)
+         continue;
+
+      std::memcpy(line_buffer.data(), frame + static_cast<size_t>(start) * line_size, line_size);
+      uint32_t line = start;
+      while (field_line(line) != start)
+      {
+         std::memcpy(frame + static_cast<size_t>(line) * line_size, frame + static_cast<size_t>(field_line(line)) * line_size, line_size);
+         moved_lines[line] = true;
+         line = field_line(line);
+      }
+      std::memcpy(frame + static_cast<size_t>(line) * line_size, line_buffer.data(), line_size);
+      moved_lines[line] = true;
+   }
+}
+
+void Deinterlacer::bob(uint32_t field, const uint8_t* field_lines, uint8_t* frame)
+{
+   //Line k of the field is picture line 2k + field. The other lines are interpolated from the field lines around them.
+   const uint32_t last_field_line = field_line_count(field) - 1;
+
+   for (uint32_t line = 0; line < frame_height; line++)
+   {
+      uint8_t* destination = frame + static_cast<size_t>(line) * line_size;
+      if (line % 2 == field)
+      {
+         std::memcpy(destination, field_lines + static_cast<size_t>(line / 2) * line_size, line_size);
+         continue;
+      }
+
+      //Field lines above and below, the first or the last one being repeated on the frame borders.
+      const uint32_t above = (line > field) ? (line - 1 - field) / 2 : 0;
+      const uint32_t below = std::min((line + 1 - field) / 2, last_field_line);
+      if (line < field || above == below)
+         std::memcpy(destination, field_lines + static_cast<size_t>(below) * line_size, line_size);
+      else
+         average_packed_lines(field_lines + static_cast<size_t>(above) * line_size, field_lines + static_cast<size_t>(below) * line_size, line_size, sample_depth, destination);
+   }
+}
+
+void Deinterlacer::bob_in_place(uint32_t field, uint8_t* frame)
+{
+   //The field is saved aside, so that the frame can be written in order.
+   line_buffer.resize(static_cast<size_t>(field_line_count(field)) * line_size);
+   std::memcpy(line_buffer.data(), frame + field_offset(field), line_buffer.size());
+   bob(field, line_buffer.data(), frame);
+}
@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file deinterlacer.h
+   @brief This file contains the conversion of field-sequential interlaced buffers to progressive frames.
+
+   Interlaced ST2110-20 buffers hold the first field (even picture lines, (frame_height + 1) / 2 lines) followed by the
+   second field (odd picture lines). Weave interleaves the two fields back in picture order. Bob builds the frame from one
+   field, the missing lines being the average of the field lines above and below, so that motion shows no combing.
+
+   Every ST2110-20 format packs samples of a single depth MSB first, so lines are averaged sample by sample whatever the
+   sampling, on packed data. The vectorized kernels (AVX2) are selected at runtime, the scalar ones being the reference.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+/*!
+   @brief Deinterlacing methods.
+*/
+enum class DeinterlaceMode
+{
+   weave, /*! Both fields interleaved, full vertical resolution for still pictures */
+   bob_first_field, /*! First field only, the lines of the second field interpolated */
+   bob_second_field /*! Second field only, the lines of the first field interpolated */
+};
+
+/*!
+   @brief Averages two lines of packed samples, sample by sample, rounding up.
+
+   @returns false if the depth is not supported (8, 10 and 12 bits are).
+*/
+bool average_packed_lines(const uint8_t* line_a /*!< [in] First line.*/
+   , const uint8_t* line_b /*!< [in] Second line.*/
+   , uint32_t line_size /*!< [in] Size of a line in bytes, a whole number of pgroups.*/
+   , uint32_t sample_depth /*!< [in] Number of bits of a sample.*/
+   , uint8_t* average /*!< [out] Averaged line. Must not overlap the source lines.*/
+);
+
+bool average_packed_lines_scalar(const uint8_t* line_a, const uint8_t* line_b, uint32_t line_size, uint32_t sample_depth, uint8_t* average);
+
+class Deinterlacer
+{
+public:
+
+   Deinterlacer(uint32_t line_size /*!< [in] Size of a line in bytes.*/
+      , uint32_t frame_height /*!< [in] Number of lines of the frame, both fields.*/
+      , uint32_t sample_depth /*!< [in] Number of bits of a sample, for bob.*/
+   );
+
+   /*!
+      @brief Converts a field-sequential buffer to a progressive frame. The conversion is done in place when fields and frame are the same buffer.
+
+      @returns false if the mode is not supported for the sample depth, nothing being written.
+   */
+   bool deinterlace(DeinterlaceMode mode /*!< [in] Deinterlacing method.*/
+      , const uint8_t* fields /*!< [in] Field-sequential buffer of frame_height lines.*/
+      , uint8_t* frame /*!< [out] Progressive frame of frame_height lines. Either fields itself, or a buffer not overlapping it.*/
+   );
+
+private:
+
+   void weave(const uint8_t* fields, uint8_t* frame);
+   void weave_in_place(uint8_t* frame);
+   void bob(uint32_t field, const uint8_t* field_lines, uint8_t* frame);
+   void bob_in_place(uint32_t field, uint8_t* frame);
+   uint32_t field_line(uint32_t picture_line) const;
+   size_t field_offset(uint32_t field) const;
+   uint32_t field_line_count(uint32_t field) const;
+
+   uint32_t line_size;
+   uint32_t frame_height;
+   uint32_t sample_depth;
+   std::vector<uint8_t> line_buffer; /*! Line, or field, saved while lines are moved in place */
+   std::vector<bool> moved_lines; /*! Lines already in place while weaving in place */
+};
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pcm_packer.h"
+#include "../cpu_features.h"
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+void pack_pcm24_be_scalar(const int32_t* samples, uint32_t sample_count, uint8_t* pcm)
+{
+   for (uint32_t i = 0; i < sample_count; i++)
+   {
+      const uint32_t sample = static_cast<uint32_t>(samples[i]);
+
+      pcm[0] = static_cast<uint8_t>(sample >> 24);
+      pcm[1] = static_cast<uint8_t>(sample >> 16);
+      pcm[2] = static_cast<uint8_t>(sample >> 8);
+      pcm += pcm24_sample_size;
+   }
+}
+
+#if CPU_FEATURES_X86
+
+//Writes the 3 MSB of four little endian 32 bits samples in big endian order on the 12 first bytes of a 128 bits register.
+#define PCM24_BE_SHUFFLE 3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1
+
+TARGET_SSE41 void pack_pcm24_be_sse41(const int32_t* samples, uint32_t sample_count, uint8_t* pcm)
+{
+   const __m128i shuffle = _mm_setr_epi8(PCM24_BE_SHUFFLE);
+   uint32_t i = 0;
+
+   //Each iteration stores 16 bytes for 12 useful ones, the 4 extra bytes must stay inside the buffer.
+   for (; i + 6 <= sample_count; i += 4)
+   {
+      const __m128i packed = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), shuffle);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pcm + i * pcm24_sample_size), packed);
+   }
+
+   pack_pcm24_be_scalar(samples + i, sample_count - i, pcm + i * pcm24_sample_size);
+}
+
+TARGET_AVX2 void pack_pcm24_be_avx2(const int32_t* samples, uint32_t sample_count, uint8_t* pcm)
+{
+   const __m256i shuffle = _mm256_setr_epi8(PCM24_BE_SHUFFLE, PCM24_BE_SHUFFLE);
+   uint32_t i = 0;
+
+   //Each iteration packs 16 samples (48 bytes) with four 16 bytes stores, the last one overflows by 4 bytes.
+   for (; i + 18 <= sample_count; i += 16)
+   {
+      const __m256i low = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i)), shuffle);
+      const __m256i high = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i + 8)), shuffle);
+      uint8_t* destination = pcm + i * pcm24_sample_size;
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm256_castsi256_si128(low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 12), _mm256_extracti128_si256(low, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 24), _mm256_castsi256_si128(high));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 36), _mm256_extracti128_si256(high, 1));
+   }
+
+   //The tail stays VEX encoded : handing it to the SSE4.1 kernel would pay an AVX to SSE transition on each call.
+   const __m128i shuffle_128 = _mm256_castsi256_si128(shuffle);
+   for (; i + 6 <= sample_count; i += 4)
+   {
+      const __m128i packed = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), shuffle_128);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pcm + i * pcm24_sample_size), packed);
+   }
+
+   pack_pcm24_be_scalar(samples + i, sample_count - i, pcm + i * pcm24_sample_size);
+}
+
+#endif
+
+typedef void (*PackPcmFunction)(const int32_t*, uint32_t, uint8_t*);
+
+static PackPcmFunction select_pack_pcm24_be()
+{
+#if CPU_FEATURES_X86
+   if (get_cpu_features().avx2)
+      return pack_pcm24_be_avx2;
+   if (get_cpu_features().sse41)
+      return pack_pcm24_be_sse41;
+#endif
+   return pack_pcm24_be_scalar;
+}
+
+void pack_pcm24_be(const int32_t* samples, uint32_t sample_count, uint8_t* pcm)
+{
+   static const PackPcmFunction pack = select_pack_pcm24_be();
+   pack(samples, sample_count, pcm);
+}
@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file pcm_packer.h
+   @brief This file contains the kernels packing audio samples into ST2110-30 24 bits PCM (L24).
+
+   An L24 sample is the 24 most significant bits of a signed 32 bits sample, in network order (MSB first), the channels
+   of a sample period being interleaved. The vectorized kernels (SSE4.1, AVX2) are selected at runtime according to the
+   CPU, the scalar kernel is the fallback and the reference for the vectorized ones.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include "../cpu_features.h"
+
+constexpr uint32_t pcm24_sample_size = 3; /*! Size of an L24 sample in bytes */
+
+/*!
+   @brief Packs signed 32 bits samples into 24 bits big endian PCM, using the best kernel for the running CPU.
+*/
+void pack_pcm24_be(const int32_t* samples /*!< [in] Samples, channels interleaved. The 8 LSB are dropped.*/
+   , uint32_t sample_count /*!< [in] Number of samples to pack, all channels included.*/
+   , uint8_t* pcm /*!< [out] Destination of the PCM, sample_count * pcm24_sample_size bytes.*/
+);
+
+/*!
+   @brief Scalar reference of pack_pcm24_be.
+*/
+void pack_pcm24_be_scalar(const int32_t* samples /*!< [in] Samples, channels interleaved.*/
+   , uint32_t sample_count /*!< [in] Number of samples to pack.*/
+   , uint8_t* pcm /*!< [out] Destination of the PCM.*/
+);
+
+#if CPU_FEATURES_X86
+/*!
+   @brief SSE4.1 and AVX2 kernels of pack_pcm24_be, whichever is selected for the running CPU, so that both can be checked and measured.
+   The CPU must support their instruction set.
+*/
+void pack_pcm24_be_sse41(const int32_t* samples, uint32_t sample_count, uint8_t* pcm);
+void pack_pcm24_be_avx2(const int32_t* samples, uint32_t sample_count, uint8_t* pcm);
+#endif
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pgroup_packer.h"
+#include "../cpu_features.h"
+
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+void pack_ycbcr422_10bit_pgroups_scalar(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t pgroup_count,
+   uint8_t* pgroups)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+   {
+      const uint32_t u = cb[i] & 0x3ff;
+      const uint32_t v = cr[i] & 0x3ff;
+      const uint32_t y0 = y[2 * i] & 0x3ff;
+      const uint32_t y1 = y[2 * i + 1] & 0x3ff;
+
+      pgroups[0] = static_cast<uint8_t>(u >> 2);
+      pgroups[1] = static_cast<uint8_t>(((u & 0x3) << 6) | (y0 >> 4));
+      pgroups[2] = static_cast<uint8_t>(((y0 & 0xf) << 4) | (v >> 6));
+      pgroups[3] = static_cast<uint8_t>(((v & 0x3f) << 2) | (y1 >> 8));
+      pgroups[4] = static_cast<uint8_t>(y1 & 0xff);
+      pgroups += ycbcr422_10bit_pgroup_size;
+   }
+}
+
+#if CPU_FEATURES_X86
+
+//Each 64 bits lane holds one pgroup as a 40 bits value (Cb << 30 | Y0 << 20 | Cr << 10 | Y1).
+//The shuffle writes the 5 LSB of two lanes in big endian order on the 10 first bytes of a 128 bits register.
+#define PGROUP_422_10BIT_SHUFFLE 4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1
+
+TARGET_SSE41 static inline __m128i pack_2_ycbcr422_10bit_pgroups_sse41(const uint16_t* y, const uint16_t* cb, const uint16_t* cr)
+{
+   const __m128i shuffle = _mm_setr_epi8(PGROUP_422_10BIT_SHUFFLE);
+   const __m128i mask = _mm_set1_epi64x(0x3ff);
+
+   uint32_t cb_pair, cr_pair;
+   std::memcpy(&cb_pair, cb, sizeof(cb_pair));
+   std::memcpy(&cr_pair, cr, sizeof(cr_pair));
+
+   const __m128i u = _mm_and_si128(_mm_cvtepu16_epi64(_mm_cvtsi32_si128(static_cast<int>(cb_pair))), mask);
+   const __m128i v = _mm_and_si128(_mm_cvtepu16_epi64(_mm_cvtsi32_si128(static_cast<int>(cr_pair))), mask);
+   const __m128i y_pairs = _mm_cvtepu32_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y)));
+   const __m128i y0 = _mm_and_si128(y_pairs, mask);
+   const __m128i y1 = _mm_and_si128(_mm_srli_epi64(y_pairs, 16), mask);
+
+   __m128i pgroup = _mm_or_si128(_mm_slli_epi64(u, 30), _mm_slli_epi64(y0, 20));
+   pgroup = _mm_or_si128(pgroup, _mm_or_si128(_mm_slli_epi64(v, 10), y1));
+
+   return _mm_shuffle_epi8(pgroup, shuffle);
+}
+
+TARGET_SSE41 static void pack_ycbcr422_10bit_pgroups_sse41(const uint16_t* y, const uint16_t* cb, const uint16_t* cr,
+   uint32_t pgroup_count, uint8_t* pgroups)
+{
+   uint32_t i = 0;
+
+   //Each iteration stores 16 bytes for 10 useful ones, the 6 extra bytes must stay inside the buffer.
+   for (; i + 4 <= pgroup_count; i += 2)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups + i * ycbcr422_10bit_pgroup_size), pack_2_ycbcr422_10bit_pgroups_sse41(y + 2 * i, cb + i, cr + i));
+
+   pack_ycbcr422_10bit_pgroups_scalar(y + 2 * i, cb + i, cr + i, pgroup_count - i, pgroups + i * ycbcr422_10bit_pgroup_size);
+}
+
+TARGET_AVX2 static inline __m256i pack_4_ycbcr422_10bit_pgroups_avx2(const uint16_t* y, const uint16_t* cb, const uint16_t* cr)
+{
+   const __m256i shuffle = _mm256_setr_epi8(PGROUP_422_10BIT_SHUFFLE, PGROUP_422_10BIT_SHUFFLE);
+   const __m256i mask = _mm256_set1_epi64x(0x3ff);
+
+   const __m256i u = _mm256_and_si256(_mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb))), mask);
+   const __m256i v = _mm256_and_si256(_mm256_cvtepu16_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr))), mask);
+   const __m256i y_pairs = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+   const __m256i y0 = _mm256_and_si256(y_pairs, mask);
+   const __m256i y1 = _mm256_and_si256(_mm256_srli_epi64(y_pairs, 16), mask);
+
+   __m256i pgroup = _mm256_or_si256(_mm256_slli_epi64(u, 30), _mm256_slli_epi64(y0, 20));
+   pgroup = _mm256_or_si256(pgroup, _mm256_or_si256(_mm256_slli_epi64(v, 10), y1));
+
+   return _mm256_shuffle_epi8(pgroup, shuffle);
+}
+
+TARGET_AVX2 static void pack_ycbcr422_10bit_pgroups_avx2(const uint16_t* y, const uint16_t* cb, const uint16_t* cr,
+   uint32_t pgroup_count, uint8_t* pgroups)
+{
+   uint32_t i = 0;
+
+   //Each iteration packs 8 pgroups (40 bytes) with four 16 bytes stores, the last one overflows by 6 bytes.
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      const __m256i low = pack_4_ycbcr422_10bit_pgroups_avx2(y + 2 * i, cb + i, cr + i);
+      const __m256i high = pack_4_ycbcr422_10bit_pgroups_avx2(y + 2 * i + 8, cb + i + 4, cr + i + 4);
+      uint8_t* destination = pgroups + i * ycbcr422_10bit_pgroup_size;
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm256_castsi256_si128(low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 10), _mm256_extracti128_si256(low, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 20), _mm256_castsi256_si128(high));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 30), _mm256_extracti128_si256(high, 1));
+   }
+
+   //The tail is inlined here, VEX encoded : calling the SSE4.1 kernel would pay an AVX to SSE transition on each line.
+   for (; i + 4 <= pgroup_count; i += 2)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups + i * ycbcr422_10bit_pgroup_size), pack_2_ycbcr422_10bit_pgroups_sse41(y + 2 * i, cb + i, cr + i));
+
+   pack_ycbcr422_10bit_pgroups_scalar(y + 2 * i, cb + i, cr + i, pgroup_count - i, pgroups + i * ycbcr422_10bit_pgroup_size);
+}
+
+#endif
+
+typedef void (*PackPgroupsFunction)(const uint16_t*, const uint16_t*, const uint16_t*, uint32_t, uint8_t*);
+
+static PackPgroupsFunction select_pack_ycbcr422_10bit_pgroups()
+{
+#if CPU_FEATURES_X86
+   if (get_cpu_features().avx2)
+      return pack_ycbcr422_10bit_pgroups_avx2;
+   if (get_cpu_features().sse41)
+      return pack_ycbcr422_10bit_pgroups_sse41;
+#endif
+   return pack_ycbcr422_10bit_pgroups_scalar;
+}
+
+void pack_ycbcr422_10bit_pgroups(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t pgroup_count,
+   uint8_t* pgroups)
+{
+   static const PackPgroupsFunction pack = select_pack_ycbcr422_10bit_pgroups();
+   pack(y, cb, cr, pgroup_count, pgroups);
+}
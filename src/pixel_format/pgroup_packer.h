@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file pgroup_packer.h
+   @brief This file contains the kernels packing Y/Cb/Cr samples into ST2110-20 pgroups.
+
+   A yuv 4:2:2 10bits pgroup holds two pixels on 5 bytes, in network order : Cb, Y0, Cr, Y1, 10 bits each, MSB first.
+   The vectorized kernels (SSE4.1, AVX2) are selected at runtime according to the CPU, the scalar kernel is the fallback
+   and the reference for the vectorized ones.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+constexpr uint32_t ycbcr422_10bit_pgroup_size = 5; /*! Size of a yuv 4:2:2 10bits pgroup in bytes */
+constexpr uint32_t ycbcr422_10bit_pgroup_pixels = 2; /*! Number of pixels in a yuv 4:2:2 10bits pgroup */
+
+/*!
+   @brief Packs runs of 10 bits samples into yuv 4:2:2 10bits big endian pgroups, using the best kernel for the running CPU.
+*/
+void pack_ycbcr422_10bit_pgroups(const uint16_t* y /*!< [in] Luma samples, 2 per pgroup. Only the 10 LSB are used.*/
+   , const uint16_t* cb /*!< [in] Blue chroma samples, 1 per pgroup. Only the 10 LSB are used.*/
+   , const uint16_t* cr /*!< [in] Red chroma samples, 1 per pgroup. Only the 10 LSB are used.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to pack.*/
+   , uint8_t* pgroups /*!< [out] Destination of the pgroups, pgroup_count * ycbcr422_10bit_pgroup_size bytes.*/
+);
+
+/*!
+   @brief Scalar reference of pack_ycbcr422_10bit_pgroups.
+*/
+void pack_ycbcr422_10bit_pgroups_scalar(const uint16_t* y /*!< [in] Luma samples, 2 per pgroup.*/
+   , const uint16_t* cb /*!< [in] Blue chroma samples, 1 per pgroup.*/
+   , const uint16_t* cr /*!< [in] Red chroma samples, 1 per pgroup.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to pack.*/
+   , uint8_t* pgroups /*!< [out] Destination of the pgroups.*/
+);
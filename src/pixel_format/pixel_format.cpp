@@ -0,0 +1,481 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pixel_format.h"
+#include "../cpu_features.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+//BT.709 narrow range yuv to full range RGB, as 16 bits fixed point coefficients scaled from 10 bits to 8 bits samples.
+constexpr int32_t rgb_luma_scale = 19077; /*! 255 / 876 */
+constexpr int32_t rgb_r_cr = 29372; /*! 1.5748 * 255 / 896 */
+constexpr int32_t rgb_g_cb = 3494; /*! 0.1873 * 255 / 896 */
+constexpr int32_t rgb_g_cr = 8731; /*! 0.4681 * 255 / 896 */
+constexpr int32_t rgb_b_cb = 34610; /*! 1.8556 * 255 / 896 */
+
+//Full range RGB to BT.709 narrow range yuv, as 16 bits fixed point coefficients scaled from 8 bits to 10 bits samples.
+//The chroma coefficients are applied to the sum of the two pixels of a pgroup, hence the 17 bits shift.
+constexpr int32_t y_r = 47864, y_g = 161017, y_b = 16255;
+constexpr int32_t cb_r = -26383, cb_g = -88755, cb_b = 115138;
+constexpr int32_t cr_r = 115138, cr_g = -104580, cr_b = -10558;
+
+static inline void read_pgroup(const uint8_t* pgroup, uint32_t& cb, uint32_t& y0, uint32_t& cr, uint32_t& y1)
+{
+   cb = (static_cast<uint32_t>(pgroup[0]) << 2) | (pgroup[1] >> 6);
+   y0 = (static_cast<uint32_t>(pgroup[1] & 0x3f) << 4) | (pgroup[2] >> 4);
+   cr = (static_cast<uint32_t>(pgroup[2] & 0xf) << 6) | (pgroup[3] >> 2);
+   y1 = (static_cast<uint32_t>(pgroup[3] & 0x3) << 8) | pgroup[4];
+}
+
+static inline void write_pgroup(uint8_t* pgroup, uint32_t cb, uint32_t y0, uint32_t cr, uint32_t y1)
+{
+   pgroup[0] = static_cast<uint8_t>(cb >> 2);
+   pgroup[1] = static_cast<uint8_t>(((cb & 0x3) << 6) | (y0 >> 4));
+   pgroup[2] = static_cast<uint8_t>(((y0 & 0xf) << 4) | (cr >> 6));
+   pgroup[3] = static_cast<uint8_t>(((cr & 0x3f) << 2) | (y1 >> 8));
+   pgroup[4] = static_cast<uint8_t>(y1 & 0xff);
+}
+
+static inline uint32_t clamp_to_8bit(int32_t value)
+{
+   return static_cast<uint32_t>(std::min(std::max((value + 32768) >> 16, 0), 255));
+}
+
+static inline uint32_t ycbcr_to_rgba(int32_t luma, int32_t r_chroma, int32_t g_chroma, int32_t b_chroma)
+{
+   return clamp_to_8bit(luma + r_chroma) | (clamp_to_8bit(luma + g_chroma) << 8) | (clamp_to_8bit(luma + b_chroma) << 16) | 0xff000000u;
+}
+
+static inline void store_le32(uint8_t* destination, uint32_t value)
+{
+   destination[0] = static_cast<uint8_t>(value);
+   destination[1] = static_cast<uint8_t>(value >> 8);
+   destination[2] = static_cast<uint8_t>(value >> 16);
+   destination[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static inline uint32_t load_le32(const uint8_t* source)
+{
+   return source[0] | (static_cast<uint32_t>(source[1]) << 8) | (static_cast<uint32_t>(source[2]) << 16) | (static_cast<uint32_t>(source[3]) << 24);
+}
+
+void unpack_ycbcr422_10bit_pgroups_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint16_t* y, uint16_t* cb, uint16_t* cr)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+   {
+      uint32_t u, y0, v, y1;
+      read_pgroup(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+      cb[i] = static_cast<uint16_t>(u);
+      cr[i] = static_cast<uint16_t>(v);
+      y[2 * i] = static_cast<uint16_t>(y0);
+      y[2 * i + 1] = static_cast<uint16_t>(y1);
+   }
+}
+
+void convert_ycbcr422_10bit_pgroups_to_v210_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* v210)
+{
+   //v210 stores the samples in the same order as the pgroups (Cb Y Cr Y ...), 3 per little endian 32 bits word.
+   for (uint32_t i = 0; i < pgroup_count; i += 3)
+   {
+      uint32_t samples[12] = {};
+      for (uint32_t j = 0; j < 3 && i + j < pgroup_count; j++)
+         read_pgroup(pgroups + (i + j) * ycbcr422_10bit_pgroup_size, samples[4 * j], samples[4 * j + 1], samples[4 * j + 2], samples[4 * j + 3]);
+
+      for (uint32_t word = 0; word < 4; word++)
+         store_le32(v210 + (i / 3) * 16 + word * 4, samples[3 * word] | (samples[3 * word + 1] << 10) | (samples[3 * word + 2] << 20));
+   }
+}
+
+void convert_v210_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* v210, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   for (uint32_t i = 0; i < pgroup_count; i += 3)
+   {
+      uint32_t samples[12];
+      for (uint32_t word = 0; word < 4; word++)
+      {
+         const uint32_t value = load_le32(v210 + (i / 3) * 16 + word * 4);
+         samples[3 * word] = value & 0x3ff;
+         samples[3 * word + 1] = (value >> 10) & 0x3ff;
+         samples[3 * word + 2] = (value >> 20) & 0x3ff;
+      }
+
+      for (uint32_t j = 0; j < 3 && i + j < pgroup_count; j++)
+         write_pgroup(pgroups + (i + j) * ycbcr422_10bit_pgroup_size, samples[4 * j], samples[4 * j + 1], samples[4 * j + 2], samples[4 * j + 3]);
+   }
+}
+
+void convert_ycbcr422_10bit_pgroups_to_uyvy8_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* uyvy)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+   {
+      uint32_t u, y0, v, y1;
+      read_pgroup(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+      uyvy[4 * i] = static_cast<uint8_t>(u >> 2);
+      uyvy[4 * i + 1] = static_cast<uint8_t>(y0 >> 2);
+      uyvy[4 * i + 2] = static_cast<uint8_t>(v >> 2);
+      uyvy[4 * i + 3] = static_cast<uint8_t>(y1 >> 2);
+   }
+}
+
+void convert_uyvy8_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* uyvy, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+      write_pgroup(pgroups + i * ycbcr422_10bit_pgroup_size, uyvy[4 * i] << 2, uyvy[4 * i + 1] << 2, uyvy[4 * i + 2] << 2, uyvy[4 * i + 3] << 2);
+}
+
+void convert_ycbcr422_10bit_pgroups_to_rgba8_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* rgba)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+   {
+      uint32_t u, y0, v, y1;
+      read_pgroup(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+
+      const int32_t cb = static_cast<int32_t>(u) - 512;
+      const int32_t cr = static_cast<int32_t>(v) - 512;
+      const int32_t r_chroma = cr * rgb_r_cr;
+      const int32_t g_chroma = -(cb * rgb_g_cb + cr * rgb_g_cr);
+      const int32_t b_chroma = cb * rgb_b_cb;
+
+      store_le32(rgba + 8 * i, ycbcr_to_rgba((static_cast<int32_t>(y0) - 64) * rgb_luma_scale, r_chroma, g_chroma, b_chroma));
+      store_le32(rgba + 8 * i + 4, ycbcr_to_rgba((static_cast<int32_t>(y1) - 64) * rgb_luma_scale, r_chroma, g_chroma, b_chroma));
+   }
+}
+
+void convert_rgba8_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* rgba, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   for (uint32_t i = 0; i < pgroup_count; i++)
+   {
+      const uint8_t* pixels = rgba + 8 * i;
+      const int32_t r = pixels[0] + pixels[4], g = pixels[1] + pixels[5], b = pixels[2] + pixels[6];
+
+      const uint32_t y0 = static_cast<uint32_t>((64 << 16) + 32768 + pixels[0] * y_r + pixels[1] * y_g + pixels[2] * y_b) >> 16;
+      const uint32_t y1 = static_cast<uint32_t>((64 << 16) + 32768 + pixels[4] * y_r + pixels[5] * y_g + pixels[6] * y_b) >> 16;
+      const uint32_t u = static_cast<uint32_t>((512 << 17) + 65536 + r * cb_r + g * cb_g + b * cb_b) >> 17;
+      const uint32_t v = static_cast<uint32_t>((512 << 17) + 65536 + r * cr_r + g * cr_g + b * cr_b) >> 17;
+
+      write_pgroup(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+   }
+}
+
+#if CPU_FEATURES_X86
+
+//Inverse of PGROUP_422_10BIT_SHUFFLE : two big endian pgroups of a 128 bits register become two 40 bits values in the 64 bits lanes.
+#define PGROUP_422_10BIT_UNSHUFFLE 4, 3, 2, 1, 0, -1, -1, -1, 9, 8, 7, 6, 5, -1, -1, -1
+#define PGROUP_422_10BIT_SHUFFLE 4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1
+
+//Extracts one 10 bits field of 8 pgroups, held as 40 bits values by two registers, into 32 bits lanes in pgroup order.
+TARGET_AVX2 static inline __m256i gather_pgroup_field_avx2(__m256i low, __m256i high, int shift)
+{
+   const __m256i mask = _mm256_set1_epi64x(0x3ff);
+   const __m128i count = _mm_cvtsi32_si128(shift);
+
+   const __m256i low_field = _mm256_and_si256(_mm256_srl_epi64(low, count), mask);
+   const __m256i high_field = _mm256_and_si256(_mm256_srl_epi64(high, count), mask);
+   const __m256i interleaved = _mm256_blend_epi32(low_field, _mm256_slli_epi64(high_field, 32), 0xAA);
+   return _mm256_permutevar8x32_epi32(interleaved, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+}
+
+//Reads 8 pgroups (40 bytes, 46 bytes are loaded) into 32 bits lanes.
+TARGET_AVX2 static inline void unpack_8_pgroups_avx2(const uint8_t* pgroups, __m256i& cb, __m256i& y0, __m256i& cr, __m256i& y1)
+{
+   const __m256i shuffle = _mm256_setr_epi8(PGROUP_422_10BIT_UNSHUFFLE, PGROUP_422_10BIT_UNSHUFFLE);
+   const __m256i low = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pgroups))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pgroups + 10)), 1), shuffle);
+   const __m256i high = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pgroups + 20))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pgroups + 30)), 1), shuffle);
+
+   cb = gather_pgroup_field_avx2(low, high, 30);
+   y0 = gather_pgroup_field_avx2(low, high, 20);
+   cr = gather_pgroup_field_avx2(low, high, 10);
+   y1 = gather_pgroup_field_avx2(low, high, 0);
+}
+
+TARGET_AVX2 static inline __m256i pack_4_pgroups_avx2(__m128i cb, __m128i y0, __m128i cr, __m128i y1)
+{
+   const __m256i shuffle = _mm256_setr_epi8(PGROUP_422_10BIT_SHUFFLE, PGROUP_422_10BIT_SHUFFLE);
+
+   __m256i pgroup = _mm256_or_si256(_mm256_slli_epi64(_mm256_cvtepu32_epi64(cb), 30), _mm256_slli_epi64(_mm256_cvtepu32_epi64(y0), 20));
+   pgroup = _mm256_or_si256(pgroup, _mm256_or_si256(_mm256_slli_epi64(_mm256_cvtepu32_epi64(cr), 10), _mm256_cvtepu32_epi64(y1)));
+   return _mm256_shuffle_epi8(pgroup, shuffle);
+}
+
+//Writes 8 pgroups from 10 bits values in 32 bits lanes. 40 bytes are written with four 16 bytes stores, the last one overflows by 6 bytes.
+TARGET_AVX2 static inline void pack_8_pgroups_avx2(__m256i cb, __m256i y0, __m256i cr, __m256i y1, uint8_t* pgroups)
+{
+   const __m256i low = pack_4_pgroups_avx2(_mm256_castsi256_si128(cb), _mm256_castsi256_si128(y0), _mm256_castsi256_si128(cr), _mm256_castsi256_si128(y1));
+   const __m256i high = pack_4_pgroups_avx2(_mm256_extracti128_si256(cb, 1), _mm256_extracti128_si256(y0, 1), _mm256_extracti128_si256(cr, 1),
+      _mm256_extracti128_si256(y1, 1));
+
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups), _mm256_castsi256_si128(low));
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups + 10), _mm256_extracti128_si256(low, 1));
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups + 20), _mm256_castsi256_si128(high));
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(pgroups + 30), _mm256_extracti128_si256(high, 1));
+}
+
+//Builds a register whose lane j is taken from one of the 4 sources, at the lane given by index[j]. The masks tell which lanes
+//come from cb, y0 and cr, the other ones coming from y1.
+template <int cb_lanes, int y0_lanes, int cr_lanes>
+TARGET_AVX2 static inline __m256i select_samples_avx2(__m256i cb, __m256i y0, __m256i cr, __m256i y1, __m256i index)
+{
+   __m256i result = _mm256_permutevar8x32_epi32(y1, index);
+   result = _mm256_blend_epi32(result, _mm256_permutevar8x32_epi32(cb, index), cb_lanes);
+   result = _mm256_blend_epi32(result, _mm256_permutevar8x32_epi32(y0, index), y0_lanes);
+   return _mm256_blend_epi32(result, _mm256_permutevar8x32_epi32(cr, index), cr_lanes);
+}
+
+TARGET_AVX2 static void unpack_ycbcr422_10bit_pgroups_avx2(const uint8_t* pgroups, uint32_t pgroup_count, uint16_t* y, uint16_t* cb, uint16_t* cr)
+{
+   uint32_t i = 0;
+
+   //Each iteration loads 46 bytes for 8 pgroups, the 6 extra bytes must stay inside the buffer.
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      __m256i u, y0, v, y1;
+      unpack_8_pgroups_avx2(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+
+      //Both lumas of a pgroup fit in a 32 bits lane, in memory order.
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + 2 * i), _mm256_or_si256(y0, _mm256_slli_epi32(y1, 16)));
+
+      const __m256i chroma = _mm256_permute4x64_epi64(_mm256_packus_epi32(u, v), 0xD8);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(cb + i), _mm256_castsi256_si128(chroma));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(cr + i), _mm256_extracti128_si256(chroma, 1));
+   }
+
+   unpack_ycbcr422_10bit_pgroups_scalar(pgroups + i * ycbcr422_10bit_pgroup_size, pgroup_count - i, y + 2 * i, cb + i, cr + i);
+}
+
+TARGET_AVX2 static void convert_ycbcr422_10bit_pgroups_to_v210_avx2(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* v210)
+{
+   uint32_t i = 0;
+
+   //Each iteration converts 6 pgroups (12 pixels) into 8 v210 words. Lane j of sample_n holds the sample 3 * j + n of the run.
+   for (; i + 10 <= pgroup_count; i += 6)
+   {
+      __m256i u, y0, v, y1;
+      unpack_8_pgroups_avx2(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+
+      const __m256i sample_0 = select_samples_avx2<0x11, 0x88, 0x44>(u, y0, v, y1, _mm256_setr_epi32(0, 0, 1, 2, 3, 3, 4, 5));
+      const __m256i sample_1 = select_samples_avx2<0x22, 0x11, 0x88>(u, y0, v, y1, _mm256_setr_epi32(0, 1, 1, 2, 3, 4, 4, 5));
+      const __m256i sample_2 = select_samples_avx2<0x44, 0x22, 0x11>(u, y0, v, y1, _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5));
+
+      const __m256i words = _mm256_or_si256(sample_0, _mm256_or_si256(_mm256_slli_epi32(sample_1, 10), _mm256_slli_epi32(sample_2, 20)));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(v210 + (i / 3) * 16), words);
+   }
+
+   convert_ycbcr422_10bit_pgroups_to_v210_scalar(pgroups + i * ycbcr422_10bit_pgroup_size, pgroup_count - i, v210 + (i / 3) * 16);
+}
+
+TARGET_AVX2 static void convert_v210_to_ycbcr422_10bit_pgroups_avx2(const uint8_t* v210, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   const __m256i mask = _mm256_set1_epi32(0x3ff);
+   uint32_t i = 0;
+
+   //Each iteration converts 8 v210 words into 6 pgroups. 8 pgroups are written, the 2 last ones being overwritten by the next iteration.
+   for (; i + 10 <= pgroup_count; i += 6)
+   {
+      const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v210 + (i / 3) * 16));
+      const __m256i sample_0 = _mm256_and_si256(words, mask);
+      const __m256i sample_1 = _mm256_and_si256(_mm256_srli_epi32(words, 10), mask);
+      const __m256i sample_2 = _mm256_and_si256(_mm256_srli_epi32(words, 20), mask);
+
+      //Sample 4 * g + n of the run, n being the position in the pgroup, is in lane (4 * g + n) / 3 of sample_((4 * g + n) % 3).
+      const __m256i u = select_samples_avx2<0x00, 0x12, 0x24>(sample_0, sample_1, sample_2, sample_0, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+      const __m256i y0 = select_samples_avx2<0x00, 0x09, 0x12>(sample_0, sample_1, sample_2, sample_0, _mm256_setr_epi32(0, 1, 3, 4, 5, 7, 7, 7));
+      const __m256i v = select_samples_avx2<0x00, 0x24, 0x09>(sample_0, sample_1, sample_2, sample_0, _mm256_setr_epi32(0, 2, 3, 4, 6, 7, 7, 7));
+      const __m256i y1 = select_samples_avx2<0x00, 0x12, 0x24>(sample_0, sample_1, sample_2, sample_0, _mm256_setr_epi32(1, 2, 3, 5, 6, 7, 7, 7));
+
+      pack_8_pgroups_avx2(u, y0, v, y1, pgroups + i * ycbcr422_10bit_pgroup_size);
+   }
+
+   convert_v210_to_ycbcr422_10bit_pgroups_scalar(v210 + (i / 3) * 16, pgroup_count - i, pgroups + i * ycbcr422_10bit_pgroup_size);
+}
+
+TARGET_AVX2 static void convert_ycbcr422_10bit_pgroups_to_uyvy8_avx2(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* uyvy)
+{
+   uint32_t i = 0;
+
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      __m256i u, y0, v, y1;
+      unpack_8_pgroups_avx2(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+
+      __m256i samples = _mm256_or_si256(_mm256_srli_epi32(u, 2), _mm256_slli_epi32(_mm256_srli_epi32(y0, 2), 8));
+      samples = _mm256_or_si256(samples, _mm256_slli_epi32(_mm256_srli_epi32(v, 2), 16));
+      samples = _mm256_or_si256(samples, _mm256_slli_epi32(_mm256_srli_epi32(y1, 2), 24));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(uyvy + 4 * i), samples);
+   }
+
+   convert_ycbcr422_10bit_pgroups_to_uyvy8_scalar(pgroups + i * ycbcr422_10bit_pgroup_size, pgroup_count - i, uyvy + 4 * i);
+}
+
+TARGET_AVX2 static void convert_uyvy8_to_ycbcr422_10bit_pgroups_avx2(const uint8_t* uyvy, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   const __m256i mask = _mm256_set1_epi32(0xff);
+   uint32_t i = 0;
+
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uyvy + 4 * i));
+      const __m256i u = _mm256_slli_epi32(_mm256_and_si256(samples, mask), 2);
+      const __m256i y0 = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(samples, 8), mask), 2);
+      const __m256i v = _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(samples, 16), mask), 2);
+      const __m256i y1 = _mm256_slli_epi32(_mm256_srli_epi32(samples, 24), 2);
+
+      pack_8_pgroups_avx2(u, y0, v, y1, pgroups + i * ycbcr422_10bit_pgroup_size);
+   }
+
+   convert_uyvy8_to_ycbcr422_10bit_pgroups_scalar(uyvy + 4 * i, pgroup_count - i, pgroups + i * ycbcr422_10bit_pgroup_size);
+}
+
+TARGET_AVX2 static inline __m256i clamp_to_8bit_avx2(__m256i value)
+{
+   const __m256i rounded = _mm256_srai_epi32(_mm256_add_epi32(value, _mm256_set1_epi32(32768)), 16);
+   return _mm256_min_epi32(_mm256_max_epi32(rounded, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+}
+
+TARGET_AVX2 static inline __m256i ycbcr_to_rgba_avx2(__m256i luma, __m256i r_chroma, __m256i g_chroma, __m256i b_chroma)
+{
+   __m256i rgba = _mm256_or_si256(clamp_to_8bit_avx2(_mm256_add_epi32(luma, r_chroma)), _mm256_slli_epi32(clamp_to_8bit_avx2(_mm256_add_epi32(luma, g_chroma)), 8));
+   rgba = _mm256_or_si256(rgba, _mm256_slli_epi32(clamp_to_8bit_avx2(_mm256_add_epi32(luma, b_chroma)), 16));
+   return _mm256_or_si256(rgba, _mm256_set1_epi32(static_cast<int>(0xff000000u)));
+}
+
+TARGET_AVX2 static void convert_ycbcr422_10bit_pgroups_to_rgba8_avx2(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* rgba)
+{
+   const __m256i luma_offset = _mm256_set1_epi32(64);
+   const __m256i chroma_offset = _mm256_set1_epi32(512);
+   uint32_t i = 0;
+
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      __m256i u, y0, v, y1;
+      unpack_8_pgroups_avx2(pgroups + i * ycbcr422_10bit_pgroup_size, u, y0, v, y1);
+
+      const __m256i cb = _mm256_sub_epi32(u, chroma_offset);
+      const __m256i cr = _mm256_sub_epi32(v, chroma_offset);
+      const __m256i r_chroma = _mm256_mullo_epi32(cr, _mm256_set1_epi32(rgb_r_cr));
+      const __m256i g_chroma = _mm256_sub_epi32(_mm256_setzero_si256(),
+         _mm256_add_epi32(_mm256_mullo_epi32(cb, _mm256_set1_epi32(rgb_g_cb)), _mm256_mullo_epi32(cr, _mm256_set1_epi32(rgb_g_cr))));
+      const __m256i b_chroma = _mm256_mullo_epi32(cb, _mm256_set1_epi32(rgb_b_cb));
+
+      const __m256i first_pixels = ycbcr_to_rgba_avx2(_mm256_mullo_epi32(_mm256_sub_epi32(y0, luma_offset), _mm256_set1_epi32(rgb_luma_scale)),
+         r_chroma, g_chroma, b_chroma);
+      const __m256i second_pixels = ycbcr_to_rgba_avx2(_mm256_mullo_epi32(_mm256_sub_epi32(y1, luma_offset), _mm256_set1_epi32(rgb_luma_scale)),
+         r_chroma, g_chroma, b_chroma);
+
+      //Interleaves the two pixels of each pgroup back in memory order.
+      const __m256i low = _mm256_unpacklo_epi32(first_pixels, second_pixels);
+      const __m256i high = _mm256_unpackhi_epi32(first_pixels, second_pixels);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + 8 * i), _mm256_permute2x128_si256(low, high, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + 8 * i + 32), _mm256_permute2x128_si256(low, high, 0x31));
+   }
+
+   convert_ycbcr422_10bit_pgroups_to_rgba8_scalar(pgroups + i * ycbcr422_10bit_pgroup_size, pgroup_count - i, rgba + 8 * i);
+}
+
+TARGET_AVX2 static inline __m256i weighted_sum_avx2(__m256i r, __m256i g, __m256i b, int32_t r_weight, int32_t g_weight, int32_t b_weight, int32_t offset)
+{
+   __m256i sum = _mm256_add_epi32(_mm256_set1_epi32(offset), _mm256_mullo_epi32(r, _mm256_set1_epi32(r_weight)));
+   sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(g, _mm256_set1_epi32(g_weight)));
+   return _mm256_add_epi32(sum, _mm256_mullo_epi32(b, _mm256_set1_epi32(b_weight)));
+}
+
+TARGET_AVX2 static void convert_rgba8_to_ycbcr422_10bit_pgroups_avx2(const uint8_t* rgba, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   const __m256i mask = _mm256_set1_epi32(0xff);
+   const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+   uint32_t i = 0;
+
+   for (; i + 10 <= pgroup_count; i += 8)
+   {
+      //Separates the first and the second pixel of each pgroup.
+      const __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + 8 * i)), split);
+      const __m256i high = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + 8 * i + 32)), split);
+      const __m256i first_pixels = _mm256_permute2x128_si256(low, high, 0x20);
+      const __m256i second_pixels = _mm256_permute2x128_si256(low, high, 0x31);
+
+      const __m256i r0 = _mm256_and_si256(first_pixels, mask);
+      const __m256i g0 = _mm256_and_si256(_mm256_srli_epi32(first_pixels, 8), mask);
+      const __m256i b0 = _mm256_and_si256(_mm256_srli_epi32(first_pixels, 16), mask);
+      const __m256i r1 = _mm256_and_si256(second_pixels, mask);
+      const __m256i g1 = _mm256_and_si256(_mm256_srli_epi32(second_pixels, 8), mask);
+      const __m256i b1 = _mm256_and_si256(_mm256_srli_epi32(second_pixels, 16), mask);
+      const __m256i r = _mm256_add_epi32(r0, r1), g = _mm256_add_epi32(g0, g1), b = _mm256_add_epi32(b0, b1);
+
+      const __m256i y0 = _mm256_srli_epi32(weighted_sum_avx2(r0, g0, b0, y_r, y_g, y_b, (64 << 16) + 32768), 16);
+      const __m256i y1 = _mm256_srli_epi32(weighted_sum_avx2(r1, g1, b1, y_r, y_g, y_b, (64 << 16) + 32768), 16);
+      const __m256i u = _mm256_srli_epi32(weighted_sum_avx2(r, g, b, cb_r, cb_g, cb_b, (512 << 17) + 65536), 17);
+      const __m256i v = _mm256_srli_epi32(weighted_sum_avx2(r, g, b, cr_r, cr_g, cr_b, (512 << 17) + 65536), 17);
+
+      pack_8_pgroups_avx2(u, y0, v, y1, pgroups + i * ycbcr422_10bit_pgroup_size);
+   }
+
+   convert_rgba8_to_ycbcr422_10bit_pgroups_scalar(rgba + 8 * i, pgroup_count - i, pgroups + i * ycbcr422_10bit_pgroup_size);
+}
+
+#define SELECT_KERNEL(kernel) (get_cpu_features().avx2 ? kernel##_avx2 : kernel##_scalar)
+#else
+#define SELECT_KERNEL(kernel) (kernel##_scalar)
+#endif
+
+typedef void (*UnpackPgroupsFunction)(const uint8_t*, uint32_t, uint16_t*, uint16_t*, uint16_t*);
+typedef void (*ConvertFunction)(const uint8_t*, uint32_t, uint8_t*);
+
+void unpack_ycbcr422_10bit_pgroups(const uint8_t* pgroups, uint32_t pgroup_count, uint16_t* y, uint16_t* cb, uint16_t* cr)
+{
+   static const UnpackPgroupsFunction unpack = SELECT_KERNEL(unpack_ycbcr422_10bit_pgroups);
+   unpack(pgroups, pgroup_count, y, cb, cr);
+}
+
+void convert_ycbcr422_10bit_pgroups_to_v210(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* v210)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_ycbcr422_10bit_pgroups_to_v210);
+   convert(pgroups, pgroup_count, v210);
+}
+
+void convert_v210_to_ycbcr422_10bit_pgroups(const uint8_t* v210, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_v210_to_ycbcr422_10bit_pgroups);
+   convert(v210, pgroup_count, pgroups);
+}
+
+void convert_ycbcr422_10bit_pgroups_to_uyvy8(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* uyvy)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_ycbcr422_10bit_pgroups_to_uyvy8);
+   convert(pgroups, pgroup_count, uyvy);
+}
+
+void convert_uyvy8_to_ycbcr422_10bit_pgroups(const uint8_t* uyvy, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_uyvy8_to_ycbcr422_10bit_pgroups);
+   convert(uyvy, pgroup_count, pgroups);
+}
+
+void convert_ycbcr422_10bit_pgroups_to_rgba8(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* rgba)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_ycbcr422_10bit_pgroups_to_rgba8);
+   convert(pgroups, pgroup_count, rgba);
+}
+
+void convert_rgba8_to_ycbcr422_10bit_pgroups(const uint8_t* rgba, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   static const ConvertFunction convert = SELECT_KERNEL(convert_rgba8_to_ycbcr422_10bit_pgroups);
+   convert(rgba, pgroup_count, pgroups);
+}
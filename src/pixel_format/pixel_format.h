@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file pixel_format.h
+   @brief This file contains the conversions between ST2110-20 yuv 4:2:2 10bits big endian pgroups and the layouts used by
+   video tools : v210, planar 16 bits Y/Cb/Cr, 8 bits UYVY and RGBA8.
+
+   Every conversion works on a run of pgroups, typically one line. The vectorized kernels (AVX2) are selected at runtime
+   according to the CPU, the scalar kernels are the fallback and the reference for the vectorized ones.
+   The packing of planar 16 bits samples into pgroups is pack_ycbcr422_10bit_pgroups, from pgroup_packer.h.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include "pgroup_packer.h"
+
+/*!
+   @brief Gives the size of a v210 line. v210 packs 6 pixels in 16 bytes, and lines are padded to a multiple of 128 bytes.
+
+   @returns The size of a v210 line in bytes.
+*/
+constexpr uint32_t v210_line_size(uint32_t frame_width /*!< [in] Number of pixels of the line.*/)
+{
+   return (frame_width + 47) / 48 * 128;
+}
+
+/*!
+   @brief Unpacks yuv 4:2:2 10bits pgroups into planar 16 bits samples, holding the 10 bits values.
+*/
+void unpack_ycbcr422_10bit_pgroups(const uint8_t* pgroups /*!< [in] pgroup_count pgroups.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to unpack.*/
+   , uint16_t* y /*!< [out] Luma samples, 2 per pgroup.*/
+   , uint16_t* cb /*!< [out] Blue chroma samples, 1 per pgroup.*/
+   , uint16_t* cr /*!< [out] Red chroma samples, 1 per pgroup.*/
+);
+
+/*!
+   @brief Converts yuv 4:2:2 10bits pgroups into v210. The last 6 pixels group is padded with zeros if pgroup_count is not a multiple of 3.
+*/
+void convert_ycbcr422_10bit_pgroups_to_v210(const uint8_t* pgroups /*!< [in] pgroup_count pgroups.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to convert.*/
+   , uint8_t* v210 /*!< [out] v210 words, 16 bytes per started group of 3 pgroups.*/
+);
+
+/*!
+   @brief Converts v210 into yuv 4:2:2 10bits pgroups.
+*/
+void convert_v210_to_ycbcr422_10bit_pgroups(const uint8_t* v210 /*!< [in] v210 words, 16 bytes per started group of 3 pgroups.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to produce.*/
+   , uint8_t* pgroups /*!< [out] pgroup_count pgroups.*/
+);
+
+/*!
+   @brief Converts yuv 4:2:2 10bits pgroups into 8 bits UYVY. Samples are truncated to their 8 MSB.
+*/
+void convert_ycbcr422_10bit_pgroups_to_uyvy8(const uint8_t* pgroups /*!< [in] pgroup_count pgroups.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to convert.*/
+   , uint8_t* uyvy /*!< [out] 4 bytes per pgroup : Cb, Y0, Cr, Y1.*/
+);
+
+/*!
+   @brief Converts 8 bits UYVY into yuv 4:2:2 10bits pgroups.
+*/
+void convert_uyvy8_to_ycbcr422_10bit_pgroups(const uint8_t* uyvy /*!< [in] 4 bytes per pgroup : Cb, Y0, Cr, Y1.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to produce.*/
+   , uint8_t* pgroups /*!< [out] pgroup_count pgroups.*/
+);
+
+/*!
+   @brief Converts yuv 4:2:2 10bits pgroups (BT.709, narrow range) into full range RGBA8, alpha being opaque.
+*/
+void convert_ycbcr422_10bit_pgroups_to_rgba8(const uint8_t* pgroups /*!< [in] pgroup_count pgroups.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to convert.*/
+   , uint8_t* rgba /*!< [out] 8 bytes per pgroup : R, G, B, A of both pixels.*/
+);
+
+/*!
+   @brief Converts full range RGBA8 into yuv 4:2:2 10bits pgroups (BT.709, narrow range). Alpha is ignored and the chroma
+   of a pgroup is the average of its two pixels.
+*/
+void convert_rgba8_to_ycbcr422_10bit_pgroups(const uint8_t* rgba /*!< [in] 8 bytes per pgroup : R, G, B, A of both pixels.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to produce.*/
+   , uint8_t* pgroups /*!< [out] pgroup_count pgroups.*/
+);
+
+/*!
+   @brief Scalar references of the conversions above.
+*/
+void unpack_ycbcr422_10bit_pgroups_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint16_t* y, uint16_t* cb, uint16_t* cr);
+void convert_ycbcr422_10bit_pgroups_to_v210_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* v210);
+void convert_v210_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* v210, uint32_t pgroup_count, uint8_t* pgroups);
+void convert_ycbcr422_10bit_pgroups_to_uyvy8_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* uyvy);
+void convert_uyvy8_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* uyvy, uint32_t pgroup_count, uint8_t* pgroups);
+void convert_ycbcr422_10bit_pgroups_to_rgba8_scalar(const uint8_t* pgroups, uint32_t pgroup_count, uint8_t* rgba);
+void convert_rgba8_to_ycbcr422_10bit_pgroups_scalar(const uint8_t* rgba, uint32_t pgroup_count, uint8_t* pgroups);
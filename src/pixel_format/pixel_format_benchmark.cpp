@@ -0,0 +1,463 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+   @file pixel_format_benchmark.cpp
+   @brief Measures the throughput of the kernels of the pixel_format library, the scalar reference against the kernel selected for the running CPU,
+   and of the frame processing of the samples that does not depend on VideoMaster IP.
+
+   Each kernel processes a whole 1920x1080 yuv 4:2:2 10 bits frame per call, the throughput being the best of several runs,
+   in GB/s of the packed frame.
+*/
+
+#include "pixel_format.h"
+#include "pgroup_packer.h"
+#include "deinterlacer.h"
+#include "polyphase_scaler.h"
+#include "pcm_packer.h"
+#include "two_sample_interleave.h"
+#include "../cpu_features.h"
+#include "../frame_copy.h"
+#include "../sender/stripe_renderer.h"
+#include "../sender/audio_source.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t frame_width = 1920;
+constexpr uint32_t frame_height = 1080;
+constexpr uint32_t frame_pgroup_count = frame_width / ycbcr422_10bit_pgroup_pixels * frame_height;
+constexpr size_t frame_size = static_cast<size_t>(frame_pgroup_count) * ycbcr422_10bit_pgroup_size;
+
+static std::mt19937 random_generator(2110);
+
+static std::vector<uint8_t> random_bytes(size_t size)
+{
+   std::vector<uint8_t> bytes(size);
+   for (uint8_t& byte : bytes)
+      byte = static_cast<uint8_t>(random_generator());
+   return bytes;
+}
+
+//Calls a function over and over for about 100 ms per run, and gives the best throughput of 5 runs, in GB/s of size bytes per call.
+static double measure_throughput(size_t size, const std::function<void()>& function)
+{
+   double best_throughput = 0;
+   for (uint32_t run = 0; run < 5; run++)
+   {
+      uint64_t call_count = 0;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      std::chrono::duration<double> elapsed(0);
+      do
+      {
+         function();
+         call_count++;
+         elapsed = std::chrono::steady_clock::now() - start;
+      } while (elapsed.count() < 0.1);
+      best_throughput = std::max(best_throughput, call_count * static_cast<double>(size) / elapsed.count() / 1e9);
+   }
+   return best_throughput;
+}
+
+static void print_throughput(const std::string& kernel, double scalar_throughput, double selected_throughput)
+{
+   std::cout << "   " << std::left << std::setw(48) << kernel << std::right << std::fixed << std::setprecision(2)
+      << std::setw(8) << scalar_throughput << " GB/s scalar" << std::setw(8) << selected_throughput << " GB/s selected" << std::endl;
+}
+
+static void measure_pgroup_conversions()
+{
+   typedef void (*ConvertFunction)(const uint8_t*, uint32_t, uint8_t*);
+   struct Conversion
+   {
+      const char* name;
+      ConvertFunction kernel;
+      ConvertFunction reference;
+   };
+   const Conversion conversions[] = {
+      { "convert_ycbcr422_10bit_pgroups_to_v210", convert_ycbcr422_10bit_pgroups_to_v210, convert_ycbcr422_10bit_pgroups_to_v210_scalar },
+      { "convert_v210_to_ycbcr422_10bit_pgroups", convert_v210_to_ycbcr422_10bit_pgroups, convert_v210_to_ycbcr422_10bit_pgroups_scalar },
+      { "convert_ycbcr422_10bit_pgroups_to_uyvy8", convert_ycbcr422_10bit_pgroups_to_uyvy8, convert_ycbcr422_10bit_pgroups_to_uyvy8_scalar },
+      { "convert_uyvy8_to_ycbcr422_10bit_pgroups", convert_uyvy8_to_ycbcr422_10bit_pgroups, convert_uyvy8_to_ycbcr422_10bit_pgroups_scalar },
+      { "convert_ycbcr422_10bit_pgroups_to_rgba8", convert_ycbcr422_10bit_pgroups_to_rgba8, convert_ycbcr422_10bit_pgroups_to_rgba8_scalar },
+      { "convert_rgba8_to_ycbcr422_10bit_pgroups", convert_rgba8_to_ycbcr422_10bit_pgroups, convert_rgba8_to_ycbcr422_10bit_pgroups_scalar },
+   };
+
+   //Large enough for every layout, RGBA8 being the largest one.
+   const std::vector<uint8_t> input = random_bytes(static_cast<size_t>(frame_pgroup_count) * 8);
+   std::vector<uint8_t> output(static_cast<size_t>(frame_pgroup_count) * 8);
+
+   for (const Conversion& conversion : conversions)
+   {
+      print_throughput(conversion.name,
+         measure_throughput(frame_size, [&]() { conversion.reference(input.data(), frame_pgroup_count, output.data()); }),
+         measure_throughput(frame_size, [&]() { conversion.kernel(input.data(), frame_pgroup_count, output.data()); }));
+   }
+
+   std::vector<uint16_t> y(2 * static_cast<size_t>(frame_pgroup_count)), cb(frame_pgroup_count), cr(frame_pgroup_count);
+   print_throughput("unpack_ycbcr422_10bit_pgroups",
+      measure_throughput(frame_size, [&]() { unpack_ycbcr422_10bit_pgroups_scalar(input.data(), frame_pgroup_count, y.data(), cb.data(), cr.data()); }),
+      measure_throughput(frame_size, [&]() { unpack_ycbcr422_10bit_pgroups(input.data(), frame_pgroup_count, y.data(), cb.data(), cr.data()); }));
+   print_throughput("pack_ycbcr422_10bit_pgroups",
+      measure_throughput(frame_size, [&]() { pack_ycbcr422_10bit_pgroups_scalar(y.data(), cb.data(), cr.data(), frame_pgroup_count, output.data()); }),
+      measure_throughput(frame_size, [&]() { pack_ycbcr422_10bit_pgroups(y.data(), cb.data(), cr.data(), frame_pgroup_count, output.data()); }));
+}
+
+static void measure_deinterlacer()
+{
+   //Bob averages the lines of a field into the missing lines of the frame : half a frame per field.
+   const uint32_t line_size = frame_width / ycbcr422_10bit_pgroup_pixels * ycbcr422_10bit_pgroup_size;
+   const std::vector<uint8_t> fields = random_bytes(frame_size);
+   std::vector<uint8_t> frame(frame_size);
+   auto average_field = [&](bool (*average)(const uint8_t*, const uint8_t*, uint32_t, uint32_t, uint8_t*))
+   {
+      for (uint32_t line = 0; line + 1 < frame_height / 2; line++)
+         average(fields.data() + static_cast<size_t>(line) * line_size, fields.data() + static_cast<size_t>(line + 1) * line_size, line_size, 10, frame.data() + static_cast<size_t>(line) * line_size);
+   };
+
+   print_throughput("average_packed_lines 10 bits",
+      measure_throughput(frame_size / 2, [&]() { average_field(average_packed_lines_scalar); }),
+      measure_throughput(frame_size / 2, [&]() { average_field(average_packed_lines); }));
+}
+
+//Packs 1 ms of 48 kHz audio, the content of a 1 ms slot, with each kernel, and renders it with the AudioSource of the sender. The
+//cost is given in ns per channel per ms of audio, like the audio cost printed by the sender.
+static void measure_pcm_packer()
+{
+   typedef void (*PackPcmFunction)(const int32_t*, uint32_t, uint8_t*);
+   std::vector<std::pair<std::string, PackPcmFunction>> kernels = { { "scalar", pack_pcm24_be_scalar } };
+#if CPU_FEATURES_X86
+   if (get_cpu_features().sse41)
+      kernels.push_back({ "SSE4.1", pack_pcm24_be_sse41 });
+   if (get_cpu_features().avx2)
+      kernels.push_back({ "AVX2", pack_pcm24_be_avx2 });
+#endif
+   const uint32_t slot_sample_periods = audio_sample_rate / 1000;
+
+   for (uint32_t channel_count : { 2u, 8u, 64u })
+   {
+      const uint32_t sample_count = slot_sample_periods * channel_count;
+      std::vector<int32_t> samples(sample_count);
+      for (int32_t& sample : samples)
+         sample = static_cast<int32_t>(random_generator());
+      std::vector<uint8_t> slot(static_cast<size_t>(sample_count) * pcm24_sample_size);
+      const size_t slot_size = slot.size();
+
+      //A throughput of size bytes per call gives the time of a call as size / throughput.
+      auto nanoseconds_per_channel = [&](double throughput) { return slot_size / throughput / channel_count; };
+
+      std::cout << "   " << std::setw(2) << channel_count << " channels :" << std::fixed << std::setprecision(1);
+      for (const std::pair<std::string, PackPcmFunction>& kernel : kernels)
+         std::cout << " " << kernel.first << " " << nanoseconds_per_channel(measure_throughput(slot_size, [&]() { kernel.second(samples.data(), sample_count, slot.data()); }));
+
+      AudioSource audio_source(channel_count, AudioSignal::tone);
+      std::cout << ", AudioSource::render " << nanoseconds_per_channel(measure_throughput(slot_size, [&]() { audio_source.render(slot.data(), static_cast<uint32_t>(slot_size)); }))
+         << " ns per channel per ms" << std::endl;
+   }
+}
+
+//Scales frames to the preview sizes of the receiver, and the other way round, with 2 (bilinear), 4 and 6 taps. The filters are
+//measured on their own on a 1080p frame scaled to 800x450, the size of the default viewer window.
+static void measure_polyphase_scaler()
+{
+   for (uint32_t taps : { 2u, 4u, 6u })
+   {
+      PolyphaseFilter filter;
+      build_polyphase_filter(frame_width, 800, taps, 0.5, filter);
+      const uint32_t padding = filter.tap_count + filter.tap_stride;
+      std::vector<uint16_t> source(frame_width + 2 * padding);
+      for (uint16_t& sample : source)
+         sample = static_cast<uint16_t>(random_generator() & 0x3ff);
+      std::vector<int16_t> filtered(800);
+
+      //Luma and both chroma of each source line.
+      const size_t horizontal_size = static_cast<size_t>(frame_width) * ycbcr422_10bit_pgroup_size / ycbcr422_10bit_pgroup_pixels;
+      print_throughput("filter_samples_horizontally " + std::to_string(taps) + " taps",
+         measure_throughput(horizontal_size, [&]() { for (uint32_t pass = 0; pass < 2; pass++) filter_samples_horizontally_scalar(source.data() + padding, filter, filtered.data()); }),
+         measure_throughput(horizontal_size, [&]() { for (uint32_t pass = 0; pass < 2; pass++) filter_samples_horizontally(source.data() + padding, filter, filtered.data()); }));
+
+      PolyphaseFilter vertical_filter;
+      build_polyphase_filter(frame_height, 450, taps, 0.5, vertical_filter);
+      std::vector<std::vector<int16_t>> lines(vertical_filter.tap_count, std::vector<int16_t>(2 * 800));
+      std::vector<const int16_t*> line_pointers;
+      for (std::vector<int16_t>& line : lines)
+      {
+         for (int16_t& sample : line)
+            sample = static_cast<int16_t>(random_generator() & 0x3ff);
+         line_pointers.push_back(line.data());
+      }
+      std::vector<uint16_t> target(2 * 800);
+      const size_t vertical_size = static_cast<size_t>(800) * ycbcr422_10bit_pgroup_size / ycbcr422_10bit_pgroup_pixels;
+      print_throughput("filter_samples_vertically " + std::to_string(taps) + " taps",
+         measure_throughput(vertical_size, [&]() { filter_samples_vertically_scalar(line_pointers.data(), vertical_filter.coefficients.data(), vertical_filter.tap_count, 2 * 800, target.data()); }),
+         measure_throughput(vertical_size, [&]() { filter_samples_vertically(line_pointers.data(), vertical_filter.coefficients.data(), vertical_filter.tap_count, 2 * 800, target.data()); }));
+   }
+
+   struct Scaling
+   {
+      uint32_t source_width;
+      uint32_t source_height;
+      uint32_t target_width;
+      uint32_t target_height;
+   };
+   const Scaling scalings[] = { { 1920, 1080, 800, 450 }, { 3840, 2160, 800, 450 }, { 1280, 720, 800, 450 }, { 1920, 1080, 1280, 720 },
+                                { 3840, 2160, 1920, 1080 }, { 1920, 1080, 3840, 2160 }, { 720, 576, 1920, 1080 } };
+
+   for (const Scaling& scaling : scalings)
+   {
+      std::cout << "   " << std::setw(4) << scaling.source_width << "x" << std::left << std::setw(4) << scaling.source_height << " -> " << std::right
+         << std::setw(4) << scaling.target_width << "x" << std::left << std::setw(4) << scaling.target_height << std::right;
+      for (uint32_t taps : { 2u, 4u, 6u })
+      {
+         PolyphaseScaler scaler(scaling.source_width, scaling.source_height, scaling.target_width, scaling.target_height, taps);
+         const std::vector<uint8_t> source = random_bytes(scaler.source_frame_size());
+         std::vector<uint8_t> target(scaler.target_frame_size());
+
+         const double throughput = measure_throughput(scaler.source_frame_size(), [&]() { scaler.scale(source.data(), target.data()); });
+         std::cout << std::fixed << std::setprecision(1) << std::setw(8) << scaler.source_frame_size() / throughput / 1e6 << " ms (" << taps << " taps)";
+      }
+      std::cout << std::endl;
+   }
+}
+
+//Extracts and interleaves the pairs of samples of 2160p lines, then splits a 2160p frame into its four links and merges them back,
+//as the sender and the receiver of a quad-link.
+static void measure_two_sample_interleave()
+{
+   const uint32_t pair_size = get_sample_pair_size(true, 10);
+   TwoSampleInterleave division(3840, 2160, pair_size);
+   const uint32_t link_pair_count = division.link_line_size() / pair_size;
+   const std::vector<uint8_t> frame = random_bytes(division.frame_size());
+   std::vector<std::vector<uint8_t>> link_frames(quad_link_count, std::vector<uint8_t>(division.link_size()));
+
+   //A line is extracted twice, once per phase, and interleaved from two halves.
+   print_throughput("extract_sample_pairs 3840 pixels",
+      measure_throughput(division.frame_line_size(), [&]() { for (uint32_t phase = 0; phase < 2; phase++) extract_sample_pairs_scalar(frame.data(), link_pair_count, pair_size, phase, link_frames[phase].data()); }),
+      measure_throughput(division.frame_line_size(), [&]() { for (uint32_t phase = 0; phase < 2; phase++) extract_sample_pairs(frame.data(), link_pair_count, pair_size, phase, link_frames[phase].data()); }));
+
+   std::vector<uint8_t> merged_frame(division.frame_size());
+   print_throughput("interleave_sample_pairs 3840 pixels",
+      measure_throughput(division.frame_line_size(), [&]() { interleave_sample_pairs_scalar(link_frames[0].data(), link_frames[1].data(), link_pair_count, pair_size, merged_frame.data()); }),
+      measure_throughput(division.frame_line_size(), [&]() { interleave_sample_pairs(link_frames[0].data(), link_frames[1].data(), link_pair_count, pair_size, merged_frame.data()); }));
+
+   const double split_throughput = measure_throughput(division.frame_size(), [&]()
+   {
+      for (uint32_t link = 0; link < quad_link_count; link++)
+         division.split(frame.data(), link, link_frames[link].data());
+   });
+   const uint8_t* link_frame_pointers[quad_link_count] = { link_frames[0].data(), link_frames[1].data(), link_frames[2].data(), link_frames[3].data() };
+   const double merge_throughput = measure_throughput(division.frame_size(), [&]() { division.merge(link_frame_pointers, merged_frame.data()); });
+
+   std::cout << "   " << std::left << std::setw(48) << "TwoSampleInterleave 3840x2160" << std::right << std::fixed << std::setprecision(2)
+      << std::setw(8) << split_throughput << " GB/s split" << std::setw(9) << merge_throughput << " GB/s merge" << std::endl;
+}
+
+//Packs planar frames line by line, split in stripes over 1, 2, 4 and 8 threads, as the sender renders its patterns. Thread counts
+//beyond the cores of the machine are skipped.
+static void measure_stripe_rendering()
+{
+   for (const std::pair<uint32_t, uint32_t>& size : { std::make_pair(1920u, 1080u), std::make_pair(3840u, 2160u) })
+   {
+      const uint32_t line_pgroup_count = size.first / ycbcr422_10bit_pgroup_pixels;
+      const size_t line_size = static_cast<size_t>(line_pgroup_count) * ycbcr422_10bit_pgroup_size;
+      const size_t rendered_frame_size = line_size * size.second;
+      std::vector<uint16_t> y(static_cast<size_t>(size.first) * size.second), cb(static_cast<size_t>(line_pgroup_count) * size.second), cr(cb.size());
+      for (size_t sample = 0; sample < cb.size(); sample++)
+      {
+         y[2 * sample] = static_cast<uint16_t>(random_generator() & 0x3ff);
+         y[2 * sample + 1] = static_cast<uint16_t>(random_generator() & 0x3ff);
+         cb[sample] = static_cast<uint16_t>(random_generator() & 0x3ff);
+         cr[sample] = static_cast<uint16_t>(random_generator() & 0x3ff);
+      }
+      std::vector<uint8_t> frame(rendered_frame_size);
+
+      for (uint32_t thread_count : { 1u, 2u, 4u, 8u })
+      {
+         const std::vector<uint32_t> worker_cpu_core_os_ids = StripeRenderer::select_cpu_cores({}, thread_count - 1);
+         if (worker_cpu_core_os_ids.size() != thread_count - 1)
+            break;
+         StripeRenderer renderer(worker_cpu_core_os_ids);
+
+         const double throughput = measure_throughput(rendered_frame_size, [&]()
+         {
+            renderer.run(size.second, [&](uint32_t first_line, uint32_t line_count)
+            {
+               for (uint32_t line = first_line; line < first_line + line_count; line++)
+               {
+                  const size_t pgroup = static_cast<size_t>(line) * line_pgroup_count;
+                  pack_ycbcr422_10bit_pgroups(y.data() + 2 * pgroup, cb.data() + pgroup, cr.data() + pgroup, line_pgroup_count, frame.data() + line * line_size);
+               }
+            });
+         });
+         std::cout << "   " << size.first << "x" << size.second << " on " << thread_count << " thread(s)" << std::fixed << std::setprecision(2)
+            << std::setw(8) << throughput << " GB/s" << std::setprecision(1) << std::setw(8) << throughput * 1e9 / rendered_frame_size << " frames/s" << std::endl;
+      }
+   }
+}
+
+//Paced 1080p59.94 streams sharing a StripeRenderer, as the streams of one sender. Each frame of a stream packs the three lines of
+//a moving line into its slot through the renderer, the rest of the slot being left as it is. The CPU cost is the time of the
+//stream threads, VideoMaster IP excluded.
+static void measure_shared_renderer()
+{
+   const uint32_t line_pgroup_count = frame_width / ycbcr422_10bit_pgroup_pixels;
+   const size_t line_size = static_cast<size_t>(line_pgroup_count) * ycbcr422_10bit_pgroup_size;
+   const uint64_t frame_period = 1000000000ull * 1001 / 60000;
+   const uint32_t frame_count = 30;
+   std::vector<uint16_t> y(frame_width), cb(line_pgroup_count), cr(line_pgroup_count);
+   for (uint32_t pgroup = 0; pgroup < line_pgroup_count; pgroup++)
+   {
+      y[2 * pgroup] = y[2 * pgroup + 1] = static_cast<uint16_t>(random_generator() & 0x3ff);
+      cb[pgroup] = static_cast<uint16_t>(random_generator() & 0x3ff);
+      cr[pgroup] = static_cast<uint16_t>(random_generator() & 0x3ff);
+   }
+   StripeRenderer renderer(StripeRenderer::select_cpu_cores({}, std::min(std::thread::hardware_concurrency(), 4u) - 1));
+
+   for (uint32_t stream_count : { 1u, 2u, 4u, 8u, 16u, 32u })
+   {
+      std::vector<std::thread> streams;
+      std::vector<uint64_t> cpu_times(stream_count, 0);
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      for (uint32_t stream_index = 0; stream_index < stream_count; stream_index++)
+      {
+         streams.emplace_back([&, stream_index]()
+         {
+            std::vector<uint8_t> slot(frame_size);
+            const uint64_t start_cpu_time = get_thread_cpu_time();
+            for (uint32_t frame = 0; frame < frame_count; frame++)
+            {
+               std::this_thread::sleep_until(start + std::chrono::nanoseconds(frame * frame_period));
+               const uint32_t moving_line = frame * 3 % (frame_height - 2);
+               renderer.run(3, [&](uint32_t first_line, uint32_t line_count)
+               {
+                  for (uint32_t line = moving_line + first_line; line < moving_line + first_line + line_count; line++)
+                     pack_ycbcr422_10bit_pgroups(y.data(), cb.data(), cr.data(), line_pgroup_count, slot.data() + line * line_size);
+               });
+            }
+            cpu_times[stream_index] = get_thread_cpu_time() - start_cpu_time;
+         });
+      }
+      for (std::thread& stream : streams)
+         stream.join();
+
+      uint64_t total_cpu_time = 0;
+      for (uint64_t cpu_time : cpu_times)
+         total_cpu_time += cpu_time;
+      std::cout << "   " << std::setw(2) << stream_count << " stream(s) on " << renderer.thread_count() << " rendering thread(s) : " << std::fixed << std::setprecision(2)
+         << 100.0 * total_cpu_time / (static_cast<double>(frame_count) * frame_period) << " % of a core, "
+         << std::setprecision(1) << total_cpu_time / 1000.0 / (static_cast<double>(frame_count) * stream_count) << " us per frame per stream" << std::endl;
+   }
+}
+
+//Loads per second of a pointer chase over 4 MiB, a working set living in the last level cache, run on its own core while copy runs
+//on another one. Without copy, the chase runs alone for the same time as a copy of the frames.
+static double measure_co_runner(const std::vector<uint32_t>& cpu_core_os_ids, const std::function<void()>& copy)
+{
+   //A single cycle through every entry, in random order, defeats the prefetchers.
+   std::vector<uint32_t> chain((4 << 20) / sizeof(uint32_t));
+   for (uint32_t entry = 0; entry < chain.size(); entry++)
+      chain[entry] = entry;
+   for (uint32_t entry = static_cast<uint32_t>(chain.size()) - 1; entry > 0; entry--)
+      std::swap(chain[entry], chain[random_generator() % entry]);
+
+   std::atomic<bool> stopping(false);
+   uint64_t load_count = 0;
+   std::chrono::duration<double> elapsed(0);
+   std::thread co_runner([&]()
+   {
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      uint32_t entry = 0;
+      while (!stopping)
+      {
+         for (uint32_t load = 0; load < 1000; load++)
+            entry = chain[entry];
+         load_count += 1000;
+      }
+      elapsed = std::chrono::steady_clock::now() - start;
+      chain[0] = entry;
+   });
+   pin_thread(co_runner, cpu_core_os_ids[1]);
+
+   std::thread copier([&]()
+   {
+      if (copy)
+      {
+         for (uint32_t frame = 0; frame < 50; frame++)
+            copy();
+      }
+      else
+         std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      stopping = true;
+   });
+   pin_thread(copier, cpu_core_os_ids[0]);
+
+   copier.join();
+   co_runner.join();
+   return load_count / elapsed.count() / 1e6;
+}
+
+//Copies 2160p frames through the cache with memcpy, and with the non-temporal stores of copy_frame. Next to a co-runner, the copy
+//with non-temporal stores should leave the cache, and the throughput of the co-runner, alone.
+static void measure_frame_copy()
+{
+   const size_t copied_frame_size = static_cast<size_t>(3840) * 2160 * ycbcr422_10bit_pgroup_size / ycbcr422_10bit_pgroup_pixels;
+   const std::vector<uint8_t> source = random_bytes(copied_frame_size);
+   std::vector<uint8_t> destination(copied_frame_size);
+
+   print_throughput("copy_frame 3840x2160",
+      measure_throughput(copied_frame_size, [&]() { copy_frame_scalar(destination.data(), source.data(), copied_frame_size); }),
+      measure_throughput(copied_frame_size, [&]() { copy_frame(destination.data(), source.data(), copied_frame_size); }));
+
+   const std::vector<uint32_t> cpu_core_os_ids = StripeRenderer::select_cpu_cores({}, 2);
+   if (cpu_core_os_ids.size() < 2)
+   {
+      std::cout << "   Co-runner skipped : it needs a core of its own, next to the copy" << std::endl;
+      return;
+   }
+   std::cout << "   Co-runner, pointer chase over 4 MiB" << std::fixed << std::setprecision(1)
+      << " : alone " << measure_co_runner(cpu_core_os_ids, nullptr) << " Mloads/s"
+      << ", next to memcpy " << measure_co_runner(cpu_core_os_ids, [&]() { copy_frame_scalar(destination.data(), source.data(), copied_frame_size); }) << " Mloads/s"
+      << ", next to copy_frame " << measure_co_runner(cpu_core_os_ids, [&]() { copy_frame(destination.data(), source.data(), copied_frame_size); }) << " Mloads/s" << std::endl;
+}
+
+int main()
+{
+   std::cout << "Kernel selected for the running CPU : " << (get_cpu_features().avx2 ? "AVX2" : "scalar, AVX2 not supported") << std::endl;
+   std::cout << std::endl << "1920x1080 yuv 4:2:2 10 bits frame, GB/s of pgroups :" << std::endl;
+   measure_pgroup_conversions();
+   measure_deinterlacer();
+   std::cout << std::endl << "Quad-link 2SI division, 3840x2160 yuv 4:2:2 10 bits :" << std::endl;
+   measure_two_sample_interleave();
+   std::cout << std::endl << "PCM packing of a 1 ms slot, 48 kHz 24 bits :" << std::endl;
+   measure_pcm_packer();
+   std::cout << std::endl << "Polyphase scaler, GB/s of the pgroups filtered, then ms per frame :" << std::endl;
+   measure_polyphase_scaler();
+   std::cout << std::endl << "Frames packed in stripes, as the sender renders its patterns (" << std::thread::hardware_concurrency() << " core(s)) :" << std::endl;
+   measure_stripe_rendering();
+   std::cout << std::endl << "Streams sharing the rendering threads, paced at 1080p59.94 :" << std::endl;
+   measure_shared_renderer();
+   std::cout << std::endl << "Frame copies, GB/s of frames :" << std::endl;
+   measure_frame_copy();
+   return 0;
+}
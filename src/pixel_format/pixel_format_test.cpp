@@ -0,0 +1,421 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+   @file pixel_format_test.cpp
+   @brief Checks byte for byte every kernel of the pixel_format library selected for the running CPU against its scalar reference.
+
+   The inputs are random, on run lengths around the width of the vector loops so that their tails are exercised, and the
+   outputs are compared past their end to catch any store overflowing the destination. The CRC32C of the frame signatures
+   is checked the same way. Exits with 1 on the first mismatching kernel, after checking all of them.
+*/
+
+#include "pixel_format.h"
+#include "pgroup_packer.h"
+#include "pcm_packer.h"
+#include "deinterlacer.h"
+#include "polyphase_scaler.h"
+#include "two_sample_interleave.h"
+#include "../cpu_features.h"
+#include "../frame_signature.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::mt19937 random_generator(2110);
+static uint32_t failure_count = 0;
+
+//Run lengths from a few elements to a 2160p line, the first ones covering the tails of every vector loop.
+static std::vector<uint32_t> get_run_lengths()
+{
+   std::vector<uint32_t> run_lengths;
+   for (uint32_t count = 0; count <= 70; count++)
+      run_lengths.push_back(count);
+   for (uint32_t count : { 127u, 128u, 129u, 959u, 960u, 961u, 1919u, 1920u, 1921u })
+      run_lengths.push_back(count);
+   return run_lengths;
+}
+
+static std::vector<uint8_t> random_bytes(size_t size)
+{
+   std::vector<uint8_t> bytes(size);
+   for (uint8_t& byte : bytes)
+      byte = static_cast<uint8_t>(random_generator());
+   return bytes;
+}
+
+//Extra bytes past the end of every destination, which no kernel may write.
+constexpr size_t guard_size = 64;
+constexpr uint8_t guard_byte = 0xa5;
+
+//Counts a kernel whose output, guard bytes included, differs from the output of its reference.
+static void check(const std::string& kernel, uint32_t count, const std::vector<uint8_t>& output, const std::vector<uint8_t>& reference)
+{
+   if (output != reference)
+   {
+      std::cout << kernel << " differs from its scalar reference on " << count << " elements" << std::endl;
+      failure_count++;
+   }
+}
+
+static void check_pgroup_conversions()
+{
+   typedef void (*ConvertFunction)(const uint8_t*, uint32_t, uint8_t*);
+   struct Conversion
+   {
+      const char* name;
+      ConvertFunction kernel;
+      ConvertFunction reference;
+      size_t input_size; /*! Size of the input per pgroup, 0 for v210 */
+      size_t output_size; /*! Size of the output per pgroup, 0 for v210 */
+   };
+   const Conversion conversions[] = {
+      { "convert_ycbcr422_10bit_pgroups_to_v210", convert_ycbcr422_10bit_pgroups_to_v210, convert_ycbcr422_10bit_pgroups_to_v210_scalar, ycbcr422_10bit_pgroup_size, 0 },
+      { "convert_v210_to_ycbcr422_10bit_pgroups", convert_v210_to_ycbcr422_10bit_pgroups, convert_v210_to_ycbcr422_10bit_pgroups_scalar, 0, ycbcr422_10bit_pgroup_size },
+      { "convert_ycbcr422_10bit_pgroups_to_uyvy8", convert_ycbcr422_10bit_pgroups_to_uyvy8, convert_ycbcr422_10bit_pgroups_to_uyvy8_scalar, ycbcr422_10bit_pgroup_size, 4 },
+      { "convert_uyvy8_to_ycbcr422_10bit_pgroups", convert_uyvy8_to_ycbcr422_10bit_pgroups, convert_uyvy8_to_ycbcr422_10bit_pgroups_scalar, 4, ycbcr422_10bit_pgroup_size },
+      { "convert_ycbcr422_10bit_pgroups_to_rgba8", convert_ycbcr422_10bit_pgroups_to_rgba8, convert_ycbcr422_10bit_pgroups_to_rgba8_scalar, ycbcr422_10bit_pgroup_size, 8 },
+      { "convert_rgba8_to_ycbcr422_10bit_pgroups", convert_rgba8_to_ycbcr422_10bit_pgroups, convert_rgba8_to_ycbcr422_10bit_pgroups_scalar, 8, ycbcr422_10bit_pgroup_size },
+   };
+
+   for (const Conversion& conversion : conversions)
+   {
+      for (uint32_t pgroup_count : get_run_lengths())
+      {
+         const size_t input_size = conversion.input_size ? pgroup_count * conversion.input_size : v210_line_size(pgroup_count * ycbcr422_10bit_pgroup_pixels);
+         const size_t output_size = conversion.output_size ? pgroup_count * conversion.output_size : v210_line_size(pgroup_count * ycbcr422_10bit_pgroup_pixels);
+         const std::vector<uint8_t> input = random_bytes(input_size);
+         std::vector<uint8_t> output(output_size + guard_size, guard_byte), reference(output_size + guard_size, guard_byte);
+
+         conversion.kernel(input.data(), pgroup_count, output.data());
+         conversion.reference(input.data(), pgroup_count, reference.data());
+         check(conversion.name, pgroup_count, output, reference);
+      }
+   }
+
+   for (uint32_t pgroup_count : get_run_lengths())
+   {
+      const std::vector<uint8_t> pgroups = random_bytes(pgroup_count * ycbcr422_10bit_pgroup_size);
+      std::vector<uint16_t> y(2 * pgroup_count + guard_size, guard_byte), cb(pgroup_count + guard_size, guard_byte), cr(pgroup_count + guard_size, guard_byte);
+      std::vector<uint16_t> reference_y(y), reference_cb(cb), reference_cr(cr);
+
+      unpack_ycbcr422_10bit_pgroups(pgroups.data(), pgroup_count, y.data(), cb.data(), cr.data());
+      unpack_ycbcr422_10bit_pgroups_scalar(pgroups.data(), pgroup_count, reference_y.data(), reference_cb.data(), reference_cr.data());
+      if (y != reference_y || cb != reference_cb || cr != reference_cr)
+      {
+         std::cout << "unpack_ycbcr422_10bit_pgroups differs from its scalar reference on " << pgroup_count << " elements" << std::endl;
+         failure_count++;
+      }
+   }
+}
+
+static void check_pgroup_packer()
+{
+   for (uint32_t pgroup_count : get_run_lengths())
+   {
+      std::vector<uint16_t> y(2 * pgroup_count), cb(pgroup_count), cr(pgroup_count);
+      for (uint16_t& sample : y)
+         sample = static_cast<uint16_t>(random_generator() & 0x3ff);
+      for (uint32_t pgroup = 0; pgroup < pgroup_count; pgroup++)
+      {
+         cb[pgroup] = static_cast<uint16_t>(random_generator() & 0x3ff);
+         cr[pgroup] = static_cast<uint16_t>(random_generator() & 0x3ff);
+      }
+      std::vector<uint8_t> output(pgroup_count * ycbcr422_10bit_pgroup_size + guard_size, guard_byte), reference(output);
+
+      pack_ycbcr422_10bit_pgroups(y.data(), cb.data(), cr.data(), pgroup_count, output.data());
+      pack_ycbcr422_10bit_pgroups_scalar(y.data(), cb.data(), cr.data(), pgroup_count, reference.data());
+      check("pack_ycbcr422_10bit_pgroups", pgroup_count, output, reference);
+   }
+}
+
+struct Color
+{
+   uint16_t y;
+   uint16_t u;
+   uint16_t v;
+};
+
+//White, yellow, cyan, green, magenta, red, blue and black bars, from left to right.
+static const Color color_list[] = { {0x2D0,0x200,0x200}, {0x2A0,0xB0,0x220}, {0x244,0x24c,0xB0}, {0x214,0xfc,0xD0},
+                                    {0xfc,0x304,0x330}, {0xcc,0x184,0x350}, {0x70,0x350,0x1e0}, {0x40,0x200,0x200} };
+
+//Colorbar line as written by the scalar loop the pgroup packer replaced, 4 pgroups per 8 pixels of a bar, with the mask of
+//the 6 LSB of Cr given. The loop masked them with 0xcf, dropping bits 4 and 5 of Cr.
+static std::vector<uint8_t> write_reference_color_bar_line(uint32_t frame_width, uint8_t cr_mask)
+{
+   std::vector<uint8_t> line(frame_width / ycbcr422_10bit_pgroup_pixels * ycbcr422_10bit_pgroup_size);
+   uint32_t j = 0;
+
+   for (uint32_t pixel_x = 0; pixel_x < frame_width; pixel_x += 8)
+   {
+      const Color& color = color_list[pixel_x / (frame_width / 8)];
+      for (uint32_t i = 0; i < 4; i++)
+      {
+         line[(j * 20) + (i * 5) + 0] = static_cast<uint8_t>(color.u >> 2);
+         line[(j * 20) + (i * 5) + 1] = static_cast<uint8_t>(((color.u & 0x3) << 6) + ((color.y & 0x3f0) >> 4));
+         line[(j * 20) + (i * 5) + 2] = static_cast<uint8_t>(((color.v & 0x3c0) >> 6) + ((color.y & 0xf) << 4));
+         line[(j * 20) + (i * 5) + 3] = static_cast<uint8_t>(((color.v & cr_mask) << 2) + ((color.y & 0x300) >> 8));
+         line[(j * 20) + (i * 5) + 4] = static_cast<uint8_t>(color.y & 0xff);
+      }
+      j++;
+   }
+   return line;
+}
+
+//The packer writes the colorbar of the former scalar loop byte for byte, with the 6 LSB of Cr kept whole.
+static void check_color_bar()
+{
+   for (uint32_t frame_width : { 720u, 1280u, 1920u, 3840u })
+   {
+      const uint32_t pgroup_count = frame_width / ycbcr422_10bit_pgroup_pixels;
+      std::vector<uint16_t> y(frame_width), cb(pgroup_count), cr(pgroup_count);
+      for (uint32_t pgroup = 0; pgroup < pgroup_count; pgroup++)
+      {
+         //Colors change on 8 pixels boundaries.
+         const Color& color = color_list[(pgroup * ycbcr422_10bit_pgroup_pixels & ~7u) / (frame_width / 8)];
+         y[2 * pgroup] = y[2 * pgroup + 1] = color.y;
+         cb[pgroup] = color.u;
+         cr[pgroup] = color.v;
+      }
+      std::vector<uint8_t> line(pgroup_count * ycbcr422_10bit_pgroup_size);
+      pack_ycbcr422_10bit_pgroups(y.data(), cb.data(), cr.data(), pgroup_count, line.data());
+
+      check("pack_ycbcr422_10bit_pgroups colorbar", pgroup_count, line, write_reference_color_bar_line(frame_width, 0x3f));
+      if (line == write_reference_color_bar_line(frame_width, 0xcf))
+      {
+         std::cout << "pack_ycbcr422_10bit_pgroups colorbar drops bits 4 and 5 of Cr on " << pgroup_count << " elements" << std::endl;
+         failure_count++;
+      }
+   }
+}
+
+static void check_pcm_packer()
+{
+   typedef void (*PackPcmFunction)(const int32_t*, uint32_t, uint8_t*);
+   std::vector<std::pair<std::string, PackPcmFunction>> kernels = { { "pack_pcm24_be", pack_pcm24_be } };
+#if CPU_FEATURES_X86
+   if (get_cpu_features().sse41)
+      kernels.push_back({ "pack_pcm24_be_sse41", pack_pcm24_be_sse41 });
+   if (get_cpu_features().avx2)
+      kernels.push_back({ "pack_pcm24_be_avx2", pack_pcm24_be_avx2 });
+#endif
+
+   for (const std::pair<std::string, PackPcmFunction>& kernel : kernels)
+   {
+      for (uint32_t sample_count : get_run_lengths())
+      {
+         std::vector<int32_t> samples(sample_count);
+         for (int32_t& sample : samples)
+            sample = static_cast<int32_t>(random_generator());
+         std::vector<uint8_t> output(sample_count * pcm24_sample_size + guard_size, guard_byte), reference(output);
+
+         kernel.second(samples.data(), sample_count, output.data());
+         pack_pcm24_be_scalar(samples.data(), sample_count, reference.data());
+         check(kernel.first, sample_count, output, reference);
+      }
+   }
+}
+
+static void check_deinterlacer()
+{
+   //A line is a whole number of 4:2:2 pgroups of the depth.
+   const std::pair<uint32_t, uint32_t> depths[] = { { 8, 4 }, { 10, 5 }, { 12, 6 } };
+
+   for (const std::pair<uint32_t, uint32_t>& depth : depths)
+   {
+      for (uint32_t pgroup_count : get_run_lengths())
+      {
+         const uint32_t line_size = pgroup_count * depth.second;
+         const std::vector<uint8_t> line_a = random_bytes(line_size), line_b = random_bytes(line_size);
+         std::vector<uint8_t> output(line_size + guard_size, guard_byte), reference(output);
+
+         average_packed_lines(line_a.data(), line_b.data(), line_size, depth.first, output.data());
+         average_packed_lines_scalar(line_a.data(), line_b.data(), line_size, depth.first, reference.data());
+         check("average_packed_lines " + std::to_string(depth.first) + " bits", pgroup_count, output, reference);
+      }
+   }
+}
+
+static void check_polyphase_scaler()
+{
+   const std::pair<uint32_t, uint32_t> sizes[] = { { 1920, 800 }, { 3840, 800 }, { 1280, 1920 }, { 961, 17 }, { 17, 961 }, { 2, 3 } };
+
+   for (const std::pair<uint32_t, uint32_t>& size : sizes)
+   {
+      for (uint32_t taps = 2; taps <= 8; taps += 2)
+      {
+         PolyphaseFilter filter;
+         if (!build_polyphase_filter(size.first, size.second, taps, 0.5, filter))
+         {
+            std::cout << "build_polyphase_filter failed from " << size.first << " to " << size.second << " samples with " << taps << " taps" << std::endl;
+            failure_count++;
+            continue;
+         }
+
+         //The filter reads around the source near its borders.
+         const uint32_t padding = filter.tap_count + filter.tap_stride;
+         std::vector<uint16_t> source(size.first + 2 * padding);
+         for (uint16_t& sample : source)
+            sample = static_cast<uint16_t>(random_generator() & 0x3ff);
+         std::vector<int16_t> horizontal(size.second + guard_size, guard_byte), reference_horizontal(horizontal);
+
+         filter_samples_horizontally(source.data() + padding, filter, horizontal.data());
+         filter_samples_horizontally_scalar(source.data() + padding, filter, reference_horizontal.data());
+         if (horizontal != reference_horizontal)
+         {
+            std::cout << "filter_samples_horizontally differs from its scalar reference on " << size.second << " elements with " << taps << " taps" << std::endl;
+            failure_count++;
+         }
+
+         //Filtered samples stray out of the 10 bits range, which the vertical filter clamps.
+         std::vector<std::vector<int16_t>> lines(filter.tap_count, std::vector<int16_t>(size.second));
+         std::vector<const int16_t*> line_pointers;
+         for (std::vector<int16_t>& line : lines)
+         {
+            for (int16_t& sample : line)
+               sample = static_cast<int16_t>(random_generator() % 1600) - 300;
+            line_pointers.push_back(line.data());
+         }
+         const int16_t* coefficients = filter.coefficients.data() + filter.phases[size.second / 2] * filter.tap_stride;
+         std::vector<uint16_t> vertical(size.second + guard_size, guard_byte), reference_vertical(vertical);
+
+         filter_samples_vertically(line_pointers.data(), coefficients, filter.tap_count, size.second, vertical.data());
+         filter_samples_vertically_scalar(line_pointers.data(), coefficients, filter.tap_count, size.second, reference_vertical.data());
+         if (vertical != reference_vertical)
+         {
+            std::cout << "filter_samples_vertically differs from its scalar reference on " << size.second << " elements with " << taps << " taps" << std::endl;
+            failure_count++;
+         }
+      }
+   }
+}
+
+static void check_two_sample_interleave()
+{
+   //Pairs of 4:2:2 at 8, 10 and 12 bits have vectorized kernels, 4:4:4 at 12 bits is scalar only.
+   for (uint32_t pair_size : { 4u, 5u, 6u, 9u })
+   {
+      for (uint32_t pair_count : get_run_lengths())
+      {
+         const std::vector<uint8_t> line = random_bytes(2 * pair_count * pair_size);
+         for (uint32_t phase = 0; phase < 2; phase++)
+         {
+            std::vector<uint8_t> output(pair_count * pair_size + guard_size, guard_byte), reference(output);
+
+            extract_sample_pairs(line.data(), pair_count, pair_size, phase, output.data());
+            extract_sample_pairs_scalar(line.data(), pair_count, pair_size, phase, reference.data());
+            check("extract_sample_pairs of " + std::to_string(pair_size) + " bytes", pair_count, output, reference);
+         }
+
+         const std::vector<uint8_t> even_pairs = random_bytes(pair_count * pair_size), odd_pairs = random_bytes(pair_count * pair_size);
+         std::vector<uint8_t> output(2 * pair_count * pair_size + guard_size, guard_byte), reference(output);
+
+         interleave_sample_pairs(even_pairs.data(), odd_pairs.data(), pair_count, pair_size, output.data());
+         interleave_sample_pairs_scalar(even_pairs.data(), odd_pairs.data(), pair_count, pair_size, reference.data());
+         check("interleave_sample_pairs of " + std::to_string(pair_size) + " bytes", pair_count, output, reference);
+      }
+   }
+
+   //A 2SI division follows the lines and pairs of the four links, and merges back into the frame it was split from.
+   TwoSampleInterleave division(64, 6, get_sample_pair_size(true, 10));
+   const std::vector<uint8_t> frame = random_bytes(division.frame_size());
+   std::vector<std::vector<uint8_t>> link_frames(quad_link_count, std::vector<uint8_t>(division.link_size()));
+   const uint8_t* link_frame_pointers[quad_link_count];
+   const uint32_t pair_size = get_sample_pair_size(true, 10);
+   const uint32_t link_pair_count = division.link_line_size() / pair_size;
+
+   for (uint32_t link = 0; link < quad_link_count; link++)
+   {
+      std::vector<uint8_t> reference(division.link_size());
+      for (uint32_t line = 0; line < division.link_height(); line++)
+      {
+         const uint8_t* frame_line = frame.data() + static_cast<size_t>(2 * line + link / 2) * division.frame_line_size();
+         for (uint32_t pair = 0; pair < link_pair_count; pair++)
+            memcpy(reference.data() + static_cast<size_t>(line) * division.link_line_size() + pair * pair_size, frame_line + (2 * pair + link % 2) * pair_size, pair_size);
+      }
+
+      division.split(frame.data(), link, link_frames[link].data());
+      link_frame_pointers[link] = link_frames[link].data();
+      check("TwoSampleInterleave::split of link " + std::to_string(link), link_pair_count, link_frames[link], reference);
+   }
+
+   std::vector<uint8_t> merged_frame(division.frame_size());
+   division.merge(link_frame_pointers, merged_frame.data());
+   check("TwoSampleInterleave::merge", link_pair_count, merged_frame, frame);
+}
+
+static void check_crc32c()
+{
+   //Check value of the CRC32C catalogue.
+   const char check_string[] = "123456789";
+   const uint32_t check_value = 0xe3069283;
+   for (const auto& kernel : { std::make_pair("crc32c", crc32c(reinterpret_cast<const uint8_t*>(check_string), 9)), std::make_pair("crc32c_scalar", crc32c_scalar(reinterpret_cast<const uint8_t*>(check_string), 9)) })
+   {
+      if (kernel.second != check_value)
+      {
+         std::cout << kernel.first << " of \"123456789\" is 0x" << std::hex << kernel.second << " instead of 0x" << check_value << std::dec << std::endl;
+         failure_count++;
+      }
+   }
+
+   //Random offsets cover the unaligned head of the hardware kernel, the lengths its three lanes of 8192 bytes and its tail, the seeds the chaining of the blocks.
+   const std::vector<uint8_t> data = random_bytes(4 * 3 * 8192);
+   std::vector<size_t> sizes;
+   for (uint32_t count : get_run_lengths())
+      sizes.push_back(count);
+   for (size_t size : { 3 * 8192 - 1, 3 * 8192, 3 * 8192 + 1, 2 * 3 * 8192 + 7 })
+      sizes.push_back(size);
+   for (uint32_t i = 0; i < 200; i++)
+      sizes.push_back(random_generator() % (3 * 3 * 8192));
+
+   for (size_t size : sizes)
+   {
+      const size_t offset = random_generator() % (data.size() - size + 1);
+      const uint32_t seed = (size % 2) ? static_cast<uint32_t>(random_generator()) : 0;
+      const uint32_t crc = crc32c(data.data() + offset, size, seed);
+      const uint32_t reference = crc32c_scalar(data.data() + offset, size, seed);
+      if (crc != reference)
+      {
+         std::cout << "crc32c differs from its scalar reference on " << size << " bytes at offset " << offset << " with seed 0x" << std::hex << seed << std::dec << std::endl;
+         failure_count++;
+      }
+   }
+}
+
+int main()
+{
+   std::cout << "Kernels checked against their scalar reference : " << (get_cpu_features().avx2 ? "AVX2" : "scalar, AVX2 not supported") << std::endl;
+
+   check_pgroup_conversions();
+   check_pgroup_packer();
+   check_color_bar();
+   check_pcm_packer();
+   check_deinterlacer();
+   check_polyphase_scaler();
+   check_two_sample_interleave();
+   check_crc32c();
+
+   if (failure_count != 0)
+   {
+      std::cout << failure_count << " kernel(s) differ from their scalar reference" << std::endl;
+      return 1;
+   }
+   std::cout << "Every kernel matches its scalar reference" << std::endl;
+   return 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "polyphase_scaler.h"
+#include "pixel_format.h"
+#include "../cpu_features.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+constexpr uint32_t phase_count = 64; /*! Positions of a target sample between two source samples */
+constexpr int coefficient_bits = 14;
+constexpr int32_t coefficient_one = 1 << coefficient_bits;
+constexpr int32_t coefficient_rounding = 1 << (coefficient_bits - 1);
+constexpr uint32_t max_taps = 16;
+constexpr int16_t max_sample = 1023;
+
+//Lanczos kernel of a lobes, the triangle of the bilinear filter for a single lobe.
+static double lanczos(double x, double lobes)
+{
+   const double pi = 3.14159265358979323846;
+   x = std::fabs(x);
+   if (x >= lobes)
+      return 0.0;
+   if (lobes <= 1.0)
+      return 1.0 - x;
+   if (x < 1e-9)
+      return 1.0;
+   return lobes * std::sin(pi * x) * std::sin(pi * x / lobes) / (pi * pi * x * x);
+}
+
+bool build_polyphase_filter(uint32_t source_size, uint32_t target_size, uint32_t taps, double position_offset, PolyphaseFilter& filter)
+{
+   if (source_size == 0 || target_size == 0 || taps < 2 || taps > max_taps || taps % 2 != 0)
+      return false;
+
+   //Scaling down, the kernel is stretched over the source samples covered by a target sample.
+   const double ratio = static_cast<double>(source_size) / target_size;
+   const double support = std::max(ratio, 1.0);
+   const double lobes = taps / 2.0;
+   filter.tap_count = 2 * static_cast<uint32_t>(std::ceil(lobes * support));
+   filter.tap_stride = (filter.tap_count + 7) / 8 * 8;
+
+   filter.coefficients.assign(static_cast<size_t>(phase_count) * filter.tap_stride, 0);
+   std::vector<double> weights(filter.tap_count);
+   const int32_t center_tap = static_cast<int32_t>(filter.tap_count / 2) - 1;
+   for (uint32_t phase = 0; phase < phase_count; phase++)
+   {
+      //Tap center_tap is the source sample at or before the target sample, at distance phase / phase_count.
+      double sum = 0.0;
+      for (uint32_t tap = 0; tap < filter.tap_count; tap++)
+      {
+         weights[tap] = lanczos((static_cast<int32_t>(tap) - center_tap - static_cast<double>(phase) / phase_count) / support, lobes);
+         sum += weights[tap];
+      }
+
+      int16_t* coefficients = filter.coefficients.data() + static_cast<size_t>(phase) * filter.tap_stride;
+      int32_t total = 0;
+      uint32_t largest_tap = 0;
+      for (uint32_t tap = 0; tap < filter.tap_count; tap++)
+      {
+         coefficients[tap] = static_cast<int16_t>(std::lround(weights[tap] / sum * coefficient_one));
+         total += coefficients[tap];
+         if (coefficients[tap] > coefficients[largest_tap])
+            largest_tap = tap;
+      }
+      //The rounding error goes to the largest coefficient, so that a flat picture stays flat.
+      coefficients[largest_tap] = static_cast<int16_t>(coefficients[largest_tap] + coefficient_one - total);
+   }
+
+   filter.first_taps.resize(target_size);
+   filter.phases.resize(target_size);
+   for (uint32_t target = 0; target < target_size; target++)
+   {
+      const double position = (target + position_offset) * ratio - position_offset;
+      double before = std::floor(position);
+      uint32_t phase = static_cast<uint32_t>(std::lround((position - before) * phase_count));
+      if (phase == phase_count)
+      {
+         before += 1.0;
+         phase = 0;
+      }
+      filter.first_taps[target] = static_cast<int32_t>(before) - center_tap;
+      filter.phases[target] = phase;
+   }
+   return true;
+}
+
+static inline int16_t saturate_sample(int32_t value)
+{
+   return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(value, INT16_MIN), INT16_MAX));
+}
+
+static inline int32_t horizontal_sample(const uint16_t* source, const PolyphaseFilter& filter, uint32_t target)
+{
+   const uint16_t* samples = source + filter.first_taps[target];
+   const int16_t* coefficients = filter.coefficients.data() + static_cast<size_t>(filter.phases[target]) * filter.tap_stride;
+   int32_t sum = 0;
+   for (uint32_t tap = 0; tap < filter.tap_stride; tap++)
+      sum += static_cast<int16_t>(samples[tap]) * coefficients[tap];
+   return (sum + coefficient_rounding) >> coefficient_bits;
+}
+
+void filter_samples_horizontally_scalar(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target)
+{
+   for (uint32_t i = 0; i < filter.phases.size(); i++)
+      target[i] = saturate_sample(horizontal_sample(source, filter, i));
+}
+
+void filter_samples_vertically_scalar(const int16_t* const* lines, const int16_t* coefficients, uint32_t tap_count, uint32_t sample_count, uint16_t* target)
+{
+   for (uint32_t x = 0; x < sample_count; x++)
+   {
+      int32_t sum = 0;
+      for (uint32_t tap = 0; tap < tap_count; tap++)
+         sum += lines[tap][x] * coefficients[tap];
+      target[x] = static_cast<uint16_t>(std::min<int32_t>(std::max<int32_t>((sum + coefficient_rounding) >> coefficient_bits, 0), max_sample));
+   }
+}
+
+#if CPU_FEATURES_X86
+TARGET_AVX2 static inline __m256i horizontal_sums_avx2(const uint16_t* source, const PolyphaseFilter& filter, uint32_t target)
+{
+   const uint16_t* samples = source + filter.first_taps[target];
+   const int16_t* coefficients = filter.coefficients.data() + static_cast<size_t>(filter.phases[target]) * filter.tap_stride;
+   __m256i sum = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coefficients)));
+   for (uint32_t tap = 16; tap < filter.tap_stride; tap += 16)
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + tap)),
+         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coefficients + tap))));
+   return sum;
+}
+
+//Eight target samples at a time, for filters of a multiple of 16 taps : each one is a dot product of tap_stride samples,
+//the eight sums being reduced together. hadd works within 128 bits lanes, the halves of each sum are added last.
+TARGET_AVX2 static void filter_samples_horizontally_16_avx2(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target)
+{
+   const uint32_t sample_count = static_cast<uint32_t>(filter.phases.size());
+   const __m256i rounding = _mm256_set1_epi32(coefficient_rounding);
+
+   uint32_t i = 0;
+   for (; i + 8 <= sample_count; i += 8)
+   {
+      const __m256i first_half = _mm256_hadd_epi32(_mm256_hadd_epi32(horizontal_sums_avx2(source, filter, i), horizontal_sums_avx2(source, filter, i + 1)),
+         _mm256_hadd_epi32(horizontal_sums_avx2(source, filter, i + 2), horizontal_sums_avx2(source, filter, i + 3)));
+      const __m256i second_half = _mm256_hadd_epi32(_mm256_hadd_epi32(horizontal_sums_avx2(source, filter, i + 4), horizontal_sums_avx2(source, filter, i + 5)),
+         _mm256_hadd_epi32(horizontal_sums_avx2(source, filter, i + 6), horizontal_sums_avx2(source, filter, i + 7)));
+      __m256i result = _mm256_add_epi32(_mm256_permute2x128_si256(first_half, second_half, 0x20), _mm256_permute2x128_si256(first_half, second_half, 0x31));
+      result = _mm256_srai_epi32(_mm256_add_epi32(result, rounding), coefficient_bits);
+      const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), packed);
+   }
+
+   for (; i < sample_count; i++)
+      target[i] = saturate_sample(horizontal_sample(source, filter, i));
+}
+
+//Eight target samples at a time, for the other filters : each 256 bits sum holds two target samples, one per 128 bits lane.
+TARGET_AVX2 static inline __m256i horizontal_sum_pair_avx2(const uint16_t* source, const PolyphaseFilter& filter, uint32_t target)
+{
+   const uint16_t* first_samples = source + filter.first_taps[target];
+   const uint16_t* second_samples = source + filter.first_taps[target + 1];
+   const int16_t* first_coefficients = filter.coefficients.data() + static_cast<size_t>(filter.phases[target]) * filter.tap_stride;
+   const int16_t* second_coefficients = filter.coefficients.data() + static_cast<size_t>(filter.phases[target + 1]) * filter.tap_stride;
+   __m256i sum = _mm256_setzero_si256();
+   for (uint32_t tap = 0; tap < filter.tap_stride; tap += 8)
+   {
+      const __m256i samples = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first_samples + tap))),
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(second_samples + tap)), 1);
+      const __m256i coefficients = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first_coefficients + tap))),
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(second_coefficients + tap)), 1);
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(samples, coefficients));
+   }
+   return sum;
+}
+
+TARGET_AVX2 static void filter_samples_horizontally_8_avx2(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target)
+{
+   const uint32_t sample_count = static_cast<uint32_t>(filter.phases.size());
+   const __m256i rounding = _mm256_set1_epi32(coefficient_rounding);
+   const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7); //Sums 0, 2, 4, 6 are in the low lane, 1, 3, 5, 7 in the high lane
+
+   uint32_t i = 0;
+   for (; i + 8 <= sample_count; i += 8)
+   {
+      __m256i result = _mm256_hadd_epi32(_mm256_hadd_epi32(horizontal_sum_pair_avx2(source, filter, i), horizontal_sum_pair_avx2(source, filter, i + 2)),
+         _mm256_hadd_epi32(horizontal_sum_pair_avx2(source, filter, i + 4), horizontal_sum_pair_avx2(source, filter, i + 6)));
+      result = _mm256_permutevar8x32_epi32(result, order);
+      result = _mm256_srai_epi32(_mm256_add_epi32(result, rounding), coefficient_bits);
+      const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), packed);
+   }
+
+   for (; i < sample_count; i++)
+      target[i] = saturate_sample(horizontal_sample(source, filter, i));
+}
+
+TARGET_AVX2 static void filter_samples_horizontally_avx2(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target)
+{
+   if (filter.tap_stride % 16 == 0)
+      filter_samples_horizontally_16_avx2(source, filter, target);
+   else
+      filter_samples_horizontally_8_avx2(source, filter, target);
+}
+
+//Sixteen target samples at a time : the lines are taken by pairs, interleaved so that madd weights both of them at once.
+TARGET_AVX2 static void filter_samples_vertically_avx2(const int16_t* const* lines, const int16_t* coefficients, uint32_t tap_count, uint32_t sample_count, uint16_t* target)
+{
+   const __m256i rounding = _mm256_set1_epi32(coefficient_rounding);
+   const __m256i minimum = _mm256_setzero_si256();
+   const __m256i maximum = _mm256_set1_epi16(max_sample);
+
+   uint32_t x = 0;
+   for (; x + 16 <= sample_count; x += 16)
+   {
+      __m256i low = _mm256_setzero_si256(), high = _mm256_setzero_si256();
+      for (uint32_t tap = 0; tap < tap_count; tap += 2)
+      {
+         const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lines[tap] + x));
+         const bool has_pair = (tap + 1 < tap_count);
+         const __m256i b = has_pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lines[tap + 1] + x)) : _mm256_setzero_si256();
+         const uint32_t pair = static_cast<uint16_t>(coefficients[tap]) | (has_pair ? static_cast<uint32_t>(static_cast<uint16_t>(coefficients[tap + 1])) << 16 : 0);
+         const __m256i weights = _mm256_set1_epi32(static_cast<int32_t>(pair));
+         low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights));
+         high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights));
+      }
+
+      //unpacklo/unpackhi and packs both work within 128 bits lanes, so the samples come back in order.
+      low = _mm256_srai_epi32(_mm256_add_epi32(low, rounding), coefficient_bits);
+      high = _mm256_srai_epi32(_mm256_add_epi32(high, rounding), coefficient_bits);
+      const __m256i result = _mm256_min_epi16(_mm256_max_epi16(_mm256_packs_epi32(low, high), minimum), maximum);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x), result);
+   }
+
+   for (; x < sample_count; x++)
+   {
+      int32_t sum = 0;
+      for (uint32_t tap = 0; tap < tap_count; tap++)
+         sum += lines[tap][x] * coefficients[tap];
+      target[x] = static_cast<uint16_t>(std::min<int32_t>(std::max<int32_t>((sum + coefficient_rounding) >> coefficient_bits, 0), max_sample));
+   }
+}
+
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (get_cpu_features().avx2 ? avx2_kernel : scalar_kernel)
+#else
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (scalar_kernel)
+#endif
+
+typedef void (*HorizontalFilterFunction)(const uint16_t*, const PolyphaseFilter&, int16_t*);
+typedef void (*VerticalFilterFunction)(const int16_t* const*, const int16_t*, uint32_t, uint32_t, uint16_t*);
+
+void filter_samples_horizontally(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target)
+{
+   static const HorizontalFilterFunction filter_samples = SELECT_KERNEL(filter_samples_horizontally_avx2, filter_samples_horizontally_scalar);
+   filter_samples(source, filter, target);
+}
+
+void filter_samples_vertically(const int16_t* const* lines, const int16_t* coefficients, uint32_t tap_count, uint32_t sample_count, uint16_t* target)
+{
+   static const VerticalFilterFunction filter_samples = SELECT_KERNEL(filter_samples_vertically_avx2, filter_samples_vertically_scalar);
+   filter_samples(lines, coefficients, tap_count, sample_count, target);
+}
+
+PolyphaseScaler::PolyphaseScaler(uint32_t source_width, uint32_t source_height, uint32_t target_width, uint32_t target_height, uint32_t taps)
+   : source_width(source_width), source_height(source_height), target_width(target_width), target_height(target_height)
+   , source_line_size(source_width / ycbcr422_10bit_pgroup_pixels * ycbcr422_10bit_pgroup_size)
+   , target_line_size(target_width / ycbcr422_10bit_pgroup_pixels * ycbcr422_10bit_pgroup_size)
+   , valid(false), luma_padding(0), chroma_padding(0)
+{
+   if (source_width % 2 != 0 || target_width % 2 != 0)
+      return;
+
+   //Luma samples are centered on the pixels, chroma samples are on the even ones : target chroma sample i is at source chroma position (i + 0.25) * ratio - 0.25.
+   if (!build_polyphase_filter(source_width, target_width, taps, 0.5, luma_filter)
+      || !build_polyphase_filter(source_width / 2, target_width / 2, taps, 0.25, chroma_filter)
+      || !build_polyphase_filter(source_height, target_height, taps, 0.5, vertical_filter))
+      return;
+
+   luma_padding = luma_filter.tap_count + luma_filter.tap_stride;
+   chroma_padding = chroma_filter.tap_count + chroma_filter.tap_stride;
+   unpacked_y.resize(source_width + 2 * luma_padding);
+   unpacked_cb.resize(source_width / 2 + 2 * chroma_padding);
+   unpacked_cr.resize(source_width / 2 + 2 * chroma_padding);
+
+   filtered_lines.resize(static_cast<size_t>(vertical_filter.tap_count) * target_width * 2);
+   filtered_line_numbers.assign(vertical_filter.tap_count, -1);
+   line_pointers.resize(vertical_filter.tap_count);
+   target_y.resize(target_width);
+   target_cb.resize(target_width / 2);
+   target_cr.resize(target_width / 2);
+   valid = true;
+}
+
+void PolyphaseScaler::filter_source_line(const uint8_t* source, uint32_t line, int16_t* filtered)
+{
+   uint16_t* y = unpacked_y.data() + luma_padding;
+   uint16_t* cb = unpacked_cb.data() + chroma_padding;
+   uint16_t* cr = unpacked_cr.data() + chroma_padding;
+   const uint32_t chroma_width = source_width / 2;
+
+   unpack_ycbcr422_10bit_pgroups(source + static_cast<size_t>(line) * source_line_size, source_width / 2, y, cb, cr);
+
+   //The samples on the borders are repeated in the padding.
+   std::fill(unpacked_y.begin(), unpacked_y.begin() + luma_padding, y[0]);
+   std::fill(unpacked_y.begin() + luma_padding + source_width, unpacked_y.end(), y[source_width - 1]);
+   std::fill(unpacked_cb.begin(), unpacked_cb.begin() + chroma_padding, cb[0]);
+   std::fill(unpacked_cb.begin() + chroma_padding + chroma_width, unpacked_cb.end(), cb[chroma_width - 1]);
+   std::fill(unpacked_cr.begin(), unpacked_cr.begin() + chroma_padding, cr[0]);
+   std::fill(unpacked_cr.begin() + chroma_padding + chroma_width, unpacked_cr.end(), cr[chroma_width - 1]);
+
+   filter_samples_horizontally(y, luma_filter, filtered);
+   filter_samples_horizontally(cb, chroma_filter, filtered + target_width);
+   filter_samples_horizontally(cr, chroma_filter, filtered + target_width + target_width / 2);
+}
+
+bool PolyphaseScaler::scale(const uint8_t* source, uint8_t* target)
+{
+   if (!valid || source == nullptr || target == nullptr)
+      return false;
+
+   const uint32_t tap_count = vertical_filter.tap_count;
+   const uint32_t chroma_width = target_width / 2;
+   std::fill(filtered_line_numbers.begin(), filtered_line_numbers.end(), -1);
+
+   for (uint32_t line = 0; line < target_height; line++)
+   {
+      //The source lines of a target line are consecutive, each one is filtered horizontally once and kept in the ring
+      //until the target lines stop using it. The lines outside of the source repeat the first or the last one.
+      const int32_t first_tap = vertical_filter.first_taps[line];
+      for (uint32_t tap = 0; tap < tap_count; tap++)
+      {
+         const int32_t source_line = std::min(std::max(first_tap + static_cast<int32_t>(tap), 0), static_cast<int32_t>(source_height) - 1);
+         const uint32_t entry = static_cast<uint32_t>(source_line) % tap_count;
+         int16_t* filtered = filtered_lines.data() + static_cast<size_t>(entry) * target_width * 2;
+         if (filtered_line_numbers[entry] != source_line)
+         {
+            filter_source_line(source, static_cast<uint32_t>(source_line), filtered);
+            filtered_line_numbers[entry] = source_line;
+         }
+         line_pointers[tap] = filtered;
+      }
+
+      const int16_t* coefficients = vertical_filter.coefficients.data() + static_cast<size_t>(vertical_filter.phases[line]) * vertical_filter.tap_stride;
+      filter_samples_vertically(line_pointers.data(), coefficients, tap_count, target_width, target_y.data());
+      for (uint32_t tap = 0; tap < tap_count; tap++)
+         line_pointers[tap] += target_width;
+      filter_samples_vertically(line_pointers.data(), coefficients, tap_count, chroma_width, target_cb.data());
+      for (uint32_t tap = 0; tap < tap_count; tap++)
+         line_pointers[tap] += chroma_width;
+      filter_samples_vertically(line_pointers.data(), coefficients, tap_count, chroma_width, target_cr.data());
+
+      pack_ycbcr422_10bit_pgroups(target_y.data(), target_cb.data(), target_cr.data(), chroma_width, target + static_cast<size_t>(line) * target_line_size);
+   }
+   return true;
+}
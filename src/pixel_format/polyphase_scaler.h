@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file polyphase_scaler.h
+   @brief This file contains the scaling of yuv 4:2:2 10bits pgroup frames to another size, down or up.
+
+   The scaler is separable : each source line is unpacked to planar samples and filtered horizontally once, the
+   filtered lines being kept in a ring from which the vertical filter builds each target line before it is packed
+   back into pgroups. The filter is a Lanczos windowed sinc of a configurable number of taps, widened by the
+   scaling ratio when scaling down so that it does not alias. Its coefficients are 14 bits fixed point, computed
+   once for a set of phases (the position of the target sample between two source samples).
+   Chroma samples are co-sited with the even luma samples, as in ST2110-20.
+
+   The filters are vectorized (AVX2) and selected at runtime, the scalar ones being the reference : both give the same result.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+#include <vector>
+
+/*!
+   @brief Coefficients of a one dimension polyphase filter, from a source size to a target size.
+*/
+struct PolyphaseFilter
+{
+   uint32_t tap_count = 0; /*! Number of source samples contributing to a target sample */
+   uint32_t tap_stride = 0; /*! Number of coefficients stored per phase, tap_count rounded up to a multiple of 8, the extra ones being zero */
+   std::vector<int32_t> first_taps; /*! Position of the first source sample of each target sample, outside of the source near its borders */
+   std::vector<uint32_t> phases; /*! Phase of each target sample */
+   std::vector<int16_t> coefficients; /*! tap_stride coefficients per phase, 14 bits fixed point, summing to 1 */
+};
+
+class PolyphaseScaler
+{
+public:
+
+   PolyphaseScaler(uint32_t source_width /*!< [in] Width of the source frames in pixels. Must be even.*/
+      , uint32_t source_height /*!< [in] Height of the source frames in lines.*/
+      , uint32_t target_width /*!< [in] Width of the target frames in pixels. Must be even.*/
+      , uint32_t target_height /*!< [in] Height of the target frames in lines.*/
+      , uint32_t taps = 4 /*!< [in] Number of taps of the filter at scale 1 : 2 for bilinear, 4 for Lanczos-2, 6 for Lanczos-3.*/
+   );
+
+   /*!
+      @brief Tells if the sizes and taps given to the constructor can be scaled.
+   */
+   bool is_valid() const { return valid; }
+
+   /*!
+      @brief Scales a frame.
+
+      @returns false if the scaler is not valid, nothing being written.
+   */
+   bool scale(const uint8_t* source /*!< [in] Source frame, source_height lines of source_width / 2 pgroups.*/
+      , uint8_t* target /*!< [out] Target frame, target_height lines of target_width / 2 pgroups. Must not overlap the source.*/
+   );
+
+   size_t source_frame_size() const { return static_cast<size_t>(source_line_size) * source_height; }
+   size_t target_frame_size() const { return static_cast<size_t>(target_line_size) * target_height; }
+
+private:
+
+   void filter_source_line(const uint8_t* source, uint32_t line, int16_t* filtered);
+
+   uint32_t source_width;
+   uint32_t source_height;
+   uint32_t target_width;
+   uint32_t target_height;
+   uint32_t source_line_size;
+   uint32_t target_line_size;
+   bool valid;
+
+   PolyphaseFilter luma_filter; /*! Horizontal filter of the luma samples */
+   PolyphaseFilter chroma_filter; /*! Horizontal filter of the chroma samples */
+   PolyphaseFilter vertical_filter; /*! Vertical filter, of every sample */
+   uint32_t luma_padding; /*! Samples repeated on each side of an unpacked luma line, so that the filter never reads outside of it */
+   uint32_t chroma_padding; /*! Same for the chroma lines */
+
+   std::vector<uint16_t> unpacked_y, unpacked_cb, unpacked_cr; /*! Source line, unpacked, with its padding */
+   std::vector<int16_t> filtered_lines; /*! Ring of horizontally filtered lines : luma then both chroma, target_width * 2 samples each */
+   std::vector<int32_t> filtered_line_numbers; /*! Source line held by each entry of the ring, -1 if none */
+   std::vector<const int16_t*> line_pointers; /*! Filtered lines used by the target line, from the ring */
+   std::vector<uint16_t> target_y, target_cb, target_cr; /*! Target line before it is packed */
+};
+
+/*!
+   @brief Builds the coefficients of a polyphase filter.
+
+   @returns false if the sizes or taps are not supported.
+*/
+bool build_polyphase_filter(uint32_t source_size /*!< [in] Number of source samples.*/
+   , uint32_t target_size /*!< [in] Number of target samples.*/
+   , uint32_t taps /*!< [in] Number of taps at scale 1, even.*/
+   , double position_offset /*!< [in] Position of target sample 0 in target samples, from the position of source sample 0 in source samples (0.5 for centered samples).*/
+   , PolyphaseFilter& filter /*!< [out] Filter.*/
+);
+
+/*!
+   @brief Filters one line horizontally, target sample i being the sum of the tap_stride samples from source + first_taps[i] weighted by its phase.
+*/
+void filter_samples_horizontally(const uint16_t* source /*!< [in] Source samples. source + first_taps[i] must be readable for tap_stride samples.*/
+   , const PolyphaseFilter& filter /*!< [in] Filter.*/
+   , int16_t* target /*!< [out] One sample per target sample of the filter.*/
+);
+
+/*!
+   @brief Filters lines vertically, target sample x being the sum of the samples x of the lines weighted by the coefficients. The result is clamped to 10 bits.
+*/
+void filter_samples_vertically(const int16_t* const* lines /*!< [in] tap_count lines.*/
+   , const int16_t* coefficients /*!< [in] tap_count coefficients, 14 bits fixed point.*/
+   , uint32_t tap_count /*!< [in] Number of lines.*/
+   , uint32_t sample_count /*!< [in] Number of samples per line.*/
+   , uint16_t* target /*!< [out] sample_count samples.*/
+);
+
+void filter_samples_horizontally_scalar(const uint16_t* source, const PolyphaseFilter& filter, int16_t* target);
+void filter_samples_vertically_scalar(const int16_t* const* lines, const int16_t* coefficients, uint32_t tap_count, uint32_t sample_count, uint16_t* target);
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+   @file render_ahead_test.cpp
+   @brief Checks the render-ahead ring of the sender with a producer and a consumer running at different paces.
+
+   Each frame is filled with its index, so that the consumer can tell the frame it is given : the next frame in order
+   when one was rendered ahead, the previous frame again only when the ring ran dry. A frame overwritten while it is
+   held shows up as a mix of indexes. Exits with 1 if any run breaks these rules, after running all of them.
+*/
+
+#include "../sender/render_ahead.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+static std::mt19937 random_generator(2110);
+static uint32_t failure_count = 0;
+
+constexpr size_t frame_word_count = 1024; /*! Frame of 8 KiB, the index being written in each of its words */
+
+//Counts a run whose frames or statistics break the rules of the ring.
+static bool check(const std::string& run, bool condition, const std::string& message)
+{
+   if (!condition)
+   {
+      std::cout << run << " : " << message << std::endl;
+      failure_count++;
+   }
+   return condition;
+}
+
+//Reads the index of a frame, UINT64_MAX if its words do not all hold the same index.
+static uint64_t read_frame_index(const uint8_t* frame)
+{
+   uint64_t words[frame_word_count];
+   memcpy(words, frame, sizeof(words));
+   for (uint64_t word : words)
+   {
+      if (word != words[0])
+         return UINT64_MAX;
+   }
+   return words[0];
+}
+
+//Takes frame_requests frames from the ring, the producer rendering a frame every render_period and the consumer requesting one every request_period.
+static void check_ring(const std::string& run, RenderAheadRing& ring, uint64_t first_frame_index, uint32_t frame_requests,
+                       std::chrono::microseconds render_period, std::chrono::microseconds request_period, bool expect_dry_ring)
+{
+   if (!check(run, ring.is_allocated(), "the ring is not allocated"))
+      return;
+
+   const bool started = ring.start(first_frame_index, [render_period](uint64_t frame_index, uint8_t* frame)
+   {
+      //The rendering time jitters around its period, from nothing to twice the period.
+      std::this_thread::sleep_for(render_period * (random_generator() % 3) / 2);
+      for (size_t word = 0; word < frame_word_count; word++)
+         memcpy(frame + word * sizeof(uint64_t), &frame_index, sizeof(uint64_t));
+   }, -1);
+   if (!check(run, started, "the producer did not start"))
+      return;
+   check(run, ring.queued_frames() == ring.frame_count(), "the ring is not full once started");
+
+   uint64_t expected_frame_index = first_frame_index;
+   uint64_t dry_ring = 0;
+   uint32_t requests = 0;
+   //A run stops on its first wrong frame, the following ones being wrong as well.
+   for (bool in_order = true; requests < frame_requests && in_order; requests++)
+   {
+      const uint8_t* frame = ring.next_frame();
+      const bool ran_dry = ring.get_statistics().dry_ring != dry_ring;
+      dry_ring = ring.get_statistics().dry_ring;
+
+      const uint64_t frame_index = frame ? read_frame_index(frame) : UINT64_MAX;
+      if (ran_dry)
+         in_order = check(run, frame_index == expected_frame_index - 1, "request " + std::to_string(requests) + " ran dry but did not repeat the previous frame");
+      else
+      {
+         in_order = check(run, frame_index == expected_frame_index, "request " + std::to_string(requests) + " gave frame " + std::to_string(frame_index) + " instead of " + std::to_string(expected_frame_index));
+         expected_frame_index++;
+      }
+
+      //The frame is held until the next request : the producer must not overwrite it in the meantime.
+      std::this_thread::sleep_for(request_period);
+      if (in_order && frame)
+         in_order = check(run, read_frame_index(frame) == frame_index, "frame " + std::to_string(frame_index) + " was overwritten while it was held");
+   }
+
+   ring.stop();
+   const RenderAheadStatistics& statistics = ring.get_statistics();
+   check(run, statistics.frames_taken == expected_frame_index - first_frame_index, "the statistics do not count the frames taken");
+   check(run, statistics.frames_taken + statistics.dry_ring == requests, "the statistics do not count every request");
+   check(run, statistics.frames_rendered >= statistics.frames_taken, "more frames were taken than rendered");
+   check(run, statistics.maximum_queued_frames <= ring.frame_count(), "more frames were queued than the ring holds");
+   if (expect_dry_ring)
+      check(run, statistics.dry_ring != 0, "the ring never ran dry");
+}
+
+int main()
+{
+   const size_t frame_size = frame_word_count * sizeof(uint64_t);
+
+   //A slow consumer finds the ring full, a fast one makes it run dry.
+   RenderAheadRing ring(frame_size, 4);
+   check_ring("slow consumer", ring, 0, 500, std::chrono::microseconds(20), std::chrono::microseconds(200), false);
+
+   //The ring is restarted on another frame index, as after a reconfiguration of the stream.
+   check_ring("fast consumer", ring, 1000, 500, std::chrono::microseconds(400), std::chrono::microseconds(50), true);
+
+   RenderAheadRing two_frame_ring(frame_size, 2);
+   check_ring("two frame ring", two_frame_ring, 7, 500, std::chrono::microseconds(100), std::chrono::microseconds(100), false);
+
+   if (failure_count != 0)
+   {
+      std::cout << failure_count << " check(s) of the render-ahead ring failed" << std::endl;
+      return 1;
+   }
+   std::cout << "The render-ahead ring gives its frames in order, repeating one only when it runs dry" << std::endl;
+   return 0;
+}
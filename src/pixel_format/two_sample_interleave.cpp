@@ -0,0 +1,231 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "two_sample_interleave.h"
+#include "../cpu_features.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#endif
+
+uint32_t get_sample_pair_size(bool chroma_subsampled, uint32_t sample_depth)
+{
+   const uint32_t pair_bits = (chroma_subsampled ? 4 : 6) * sample_depth;
+   return (pair_bits % 8 == 0) ? pair_bits / 8 : 0;
+}
+
+//The pairs are copied with a size known at compile time for the usual formats, the copy becoming a couple of moves.
+template <uint32_t pair_size>
+static void extract_pairs_scalar(const uint8_t* line, uint32_t pair_count, uint32_t phase, uint8_t* pairs)
+{
+   const uint8_t* source = line + phase * pair_size;
+   for (uint32_t pair = 0; pair < pair_count; pair++)
+      std::memcpy(pairs + pair * pair_size, source + 2 * pair * pair_size, pair_size);
+}
+
+template <uint32_t pair_size>
+static void interleave_pairs_scalar(const uint8_t* even_pairs, const uint8_t* odd_pairs, uint32_t pair_count, uint8_t* line)
+{
+   for (uint32_t pair = 0; pair < pair_count; pair++)
+   {
+      std::memcpy(line + 2 * pair * pair_size, even_pairs + pair * pair_size, pair_size);
+      std::memcpy(line + (2 * pair + 1) * pair_size, odd_pairs + pair * pair_size, pair_size);
+   }
+}
+
+void extract_sample_pairs_scalar(const uint8_t* line, uint32_t pair_count, uint32_t pair_size, uint32_t phase, uint8_t* pairs)
+{
+   switch (pair_size)
+   {
+   case 4: extract_pairs_scalar<4>(line, pair_count, phase, pairs); return;
+   case 5: extract_pairs_scalar<5>(line, pair_count, phase, pairs); return;
+   case 6: extract_pairs_scalar<6>(line, pair_count, phase, pairs); return;
+   default:
+      for (uint32_t pair = 0; pair < pair_count; pair++)
+         std::memcpy(pairs + static_cast<size_t>(pair) * pair_size, line + static_cast<size_t>(2 * pair + phase) * pair_size, pair_size);
+      return;
+   }
+}
+
+void interleave_sample_pairs_scalar(const uint8_t* even_pairs, const uint8_t* odd_pairs, uint32_t pair_count, uint32_t pair_size, uint8_t* line)
+{
+   switch (pair_size)
+   {
+   case 4: interleave_pairs_scalar<4>(even_pairs, odd_pairs, pair_count, line); return;
+   case 5: interleave_pairs_scalar<5>(even_pairs, odd_pairs, pair_count, line); return;
+   case 6: interleave_pairs_scalar<6>(even_pairs, odd_pairs, pair_count, line); return;
+   default:
+      for (uint32_t pair = 0; pair < pair_count; pair++)
+      {
+         std::memcpy(line + static_cast<size_t>(2 * pair) * pair_size, even_pairs + static_cast<size_t>(pair) * pair_size, pair_size);
+         std::memcpy(line + static_cast<size_t>(2 * pair + 1) * pair_size, odd_pairs + static_cast<size_t>(pair) * pair_size, pair_size);
+      }
+      return;
+   }
+}
+
+#if CPU_FEATURES_X86
+TARGET_AVX2 static inline __m256i load_lanes_avx2(const uint8_t* low_lane, const uint8_t* high_lane)
+{
+   return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low_lane))),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(high_lane)), 1);
+}
+
+//Each 128 bits lane gathers group_pairs pairs out of the 2 * group_pairs - 1 pairs it loads. Each lane is stored with
+//16 bytes, the bytes after the gathered pairs being rewritten by the next store.
+template <uint32_t pair_size>
+TARGET_AVX2 static void extract_pairs_avx2(const uint8_t* line, uint32_t pair_count, uint32_t phase, uint8_t* pairs)
+{
+   constexpr uint32_t group_pairs = (16 / pair_size + 1) / 2; /*! 2 pairs for 4 and 5 bytes, 1 pair for 6 bytes */
+   constexpr uint32_t group_size = group_pairs * pair_size;
+
+   alignas(32) int8_t gather[32];
+   for (int lane = 0; lane < 2; lane++)
+      for (int byte = 0; byte < 16; byte++)
+         gather[16 * lane + byte] = (byte < static_cast<int>(group_size)) ? static_cast<int8_t>(2 * (byte / pair_size) * pair_size + byte % pair_size) : -1;
+   const __m256i gather_shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(gather));
+
+   const uint8_t* source = line + phase * pair_size;
+   const size_t source_size = static_cast<size_t>(2 * pair_count - phase) * pair_size;
+   const size_t pairs_size = static_cast<size_t>(pair_count) * pair_size;
+
+   uint32_t pair = 0;
+   for (; static_cast<size_t>(pair) * pair_size + group_size + 16 <= pairs_size && 2 * static_cast<size_t>(pair) * pair_size + 2 * group_size + 16 <= source_size; pair += 2 * group_pairs)
+   {
+      const uint8_t* input = source + 2 * static_cast<size_t>(pair) * pair_size;
+      const __m256i gathered = _mm256_shuffle_epi8(load_lanes_avx2(input, input + 2 * group_size), gather_shuffle);
+      uint8_t* output = pairs + static_cast<size_t>(pair) * pair_size;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(gathered));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + group_size), _mm256_extracti128_si256(gathered, 1));
+   }
+
+   extract_pairs_scalar<pair_size>(line + 2 * static_cast<size_t>(pair) * pair_size, pair_count - pair, phase, pairs + static_cast<size_t>(pair) * pair_size);
+}
+
+//Each 128 bits lane builds 2 * group_pairs pairs of the line from group_pairs pairs of each input, the two shuffles
+//leaving zeros in the bytes of the other input.
+template <uint32_t pair_size>
+TARGET_AVX2 static void interleave_pairs_avx2(const uint8_t* even_pairs, const uint8_t* odd_pairs, uint32_t pair_count, uint8_t* line)
+{
+   constexpr uint32_t group_pairs = 16 / (2 * pair_size); /*! 2 pairs for 4 bytes, 1 pair for 5 and 6 bytes */
+   constexpr uint32_t group_size = group_pairs * pair_size;
+
+   alignas(32) int8_t to_even[32], to_odd[32];
+   for (int lane = 0; lane < 2; lane++)
+   {
+      for (int byte = 0; byte < 16; byte++)
+      {
+         const int line_pair = byte / pair_size, source = (line_pair / 2) * pair_size + byte % pair_size;
+         const bool in_group = byte < static_cast<int>(2 * group_size);
+         to_even[16 * lane + byte] = (in_group && line_pair % 2 == 0) ? static_cast<int8_t>(source) : -1;
+         to_odd[16 * lane + byte] = (in_group && line_pair % 2 == 1) ? static_cast<int8_t>(source) : -1;
+      }
+   }
+   const __m256i even_shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(to_even));
+   const __m256i odd_shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(to_odd));
+
+   const size_t pairs_size = static_cast<size_t>(pair_count) * pair_size;
+
+   uint32_t pair = 0;
+   for (; static_cast<size_t>(pair) * pair_size + group_size + 16 <= pairs_size; pair += 2 * group_pairs)
+   {
+      const size_t input = static_cast<size_t>(pair) * pair_size;
+      const __m256i even = _mm256_shuffle_epi8(load_lanes_avx2(even_pairs + input, even_pairs + input + group_size), even_shuffle);
+      const __m256i odd = _mm256_shuffle_epi8(load_lanes_avx2(odd_pairs + input, odd_pairs + input + group_size), odd_shuffle);
+      const __m256i interleaved = _mm256_or_si256(even, odd);
+      uint8_t* output = line + 2 * input;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm256_castsi256_si128(interleaved));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * group_size), _mm256_extracti128_si256(interleaved, 1));
+   }
+
+   interleave_pairs_scalar<pair_size>(even_pairs + static_cast<size_t>(pair) * pair_size, odd_pairs + static_cast<size_t>(pair) * pair_size, pair_count - pair,
+      line + 2 * static_cast<size_t>(pair) * pair_size);
+}
+
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (get_cpu_features().avx2 ? avx2_kernel : scalar_kernel)
+#else
+#define SELECT_KERNEL(avx2_kernel, scalar_kernel) (scalar_kernel)
+#endif
+
+typedef void (*ExtractPairsFunction)(const uint8_t*, uint32_t, uint32_t, uint8_t*);
+typedef void (*InterleavePairsFunction)(const uint8_t*, const uint8_t*, uint32_t, uint8_t*);
+
+void extract_sample_pairs(const uint8_t* line, uint32_t pair_count, uint32_t pair_size, uint32_t phase, uint8_t* pairs)
+{
+   static const ExtractPairsFunction extract_4 = SELECT_KERNEL(extract_pairs_avx2<4>, extract_pairs_scalar<4>);
+   static const ExtractPairsFunction extract_5 = SELECT_KERNEL(extract_pairs_avx2<5>, extract_pairs_scalar<5>);
+   static const ExtractPairsFunction extract_6 = SELECT_KERNEL(extract_pairs_avx2<6>, extract_pairs_scalar<6>);
+
+   switch (pair_size)
+   {
+   case 4: extract_4(line, pair_count, phase, pairs); return;
+   case 5: extract_5(line, pair_count, phase, pairs); return;
+   case 6: extract_6(line, pair_count, phase, pairs); return;
+   default: extract_sample_pairs_scalar(line, pair_count, pair_size, phase, pairs); return;
+   }
+}
+
+void interleave_sample_pairs(const uint8_t* even_pairs, const uint8_t* odd_pairs, uint32_t pair_count, uint32_t pair_size, uint8_t* line)
+{
+   static const InterleavePairsFunction interleave_4 = SELECT_KERNEL(interleave_pairs_avx2<4>, interleave_pairs_scalar<4>);
+   static const InterleavePairsFunction interleave_5 = SELECT_KERNEL(interleave_pairs_avx2<5>, interleave_pairs_scalar<5>);
+   static const InterleavePairsFunction interleave_6 = SELECT_KERNEL(interleave_pairs_avx2<6>, interleave_pairs_scalar<6>);
+
+   switch (pair_size)
+   {
+   case 4: interleave_4(even_pairs, odd_pairs, pair_count, line); return;
+   case 5: interleave_5(even_pairs, odd_pairs, pair_count, line); return;
+   case 6: interleave_6(even_pairs, odd_pairs, pair_count, line); return;
+   default: interleave_sample_pairs_scalar(even_pairs, odd_pairs, pair_count, pair_size, line); return;
+   }
+}
+
+TwoSampleInterleave::TwoSampleInterleave(uint32_t frame_width, uint32_t frame_height, uint32_t pair_size)
+   : frame_height(frame_height), pair_size(pair_size), line_size(frame_width / 2 * pair_size)
+{
+   if (frame_width == 0 || frame_width % 4 != 0 || frame_height == 0 || frame_height % 2 != 0)
+      this->pair_size = 0;
+}
+
+bool TwoSampleInterleave::split(const uint8_t* frame, uint32_t link, uint8_t* link_frame, uint32_t first_line, uint32_t line_count) const
+{
+   if (!is_valid() || frame == nullptr || link_frame == nullptr || link >= quad_link_count)
+      return false;
+
+   //Links 1 and 2 take the even lines of the frame, links 3 and 4 the odd ones, each link every other pair of its lines.
+   const uint32_t last_line = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(first_line) + line_count, link_height()));
+   for (uint32_t line = first_line; line < last_line; line++)
+      extract_sample_pairs(frame + static_cast<size_t>(2 * line + link / 2) * line_size, line_size / pair_size / 2, pair_size, link % 2,
+         link_frame + static_cast<size_t>(line) * link_line_size());
+   return true;
+}
+
+bool TwoSampleInterleave::merge(const uint8_t* const link_frames[quad_link_count], uint8_t* frame, uint32_t first_line, uint32_t line_count) const
+{
+   if (!is_valid() || frame == nullptr || link_frames == nullptr || std::find(link_frames, link_frames + quad_link_count, nullptr) != link_frames + quad_link_count)
+      return false;
+
+   const uint32_t last_line = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(first_line) + line_count, frame_height));
+   for (uint32_t line = first_line; line < last_line; line++)
+   {
+      const size_t link_line = static_cast<size_t>(line / 2) * link_line_size();
+      interleave_sample_pairs(link_frames[2 * (line % 2)] + link_line, link_frames[2 * (line % 2) + 1] + link_line, line_size / pair_size / 2, pair_size,
+         frame + static_cast<size_t>(line) * line_size);
+   }
+   return true;
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file two_sample_interleave.h
+   @brief This file contains the division of a UHD frame into four quad-link sub-images with two-sample interleave (2SI), and their merge.
+
+   2SI (SMPTE ST 2082-10, SMPTE ST 425-5) divides a frame into four sub-images of half its width and half its height,
+   each carried by a link of its own : the even lines of the frame go to links 1 and 2, the odd lines to links 3 and 4,
+   and along a line the pairs of adjacent samples alternate between the two links of the line. Every sub-image is then
+   a full picture at a quarter of the resolution, which 1080p equipment can show on its own.
+
+   A pair of samples is a whole number of bytes for every 4:2:2 format (a pgroup) and for 4:4:4 at 8 and 12 bits, so
+   the lines are split and merged by moving runs of bytes, whatever the sampling. The vectorized kernels (AVX2) are
+   selected at runtime, the scalar ones being the reference.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+
+constexpr uint32_t quad_link_count = 4; /*! Number of links of a 2SI division */
+
+/*!
+   @brief Gives the size of a pair of adjacent samples in the packed ST2110-20 layout.
+
+   @returns The size of the pair in bytes, 0 if it does not end on a byte boundary (4:4:4 at 10 bits).
+*/
+uint32_t get_sample_pair_size(bool chroma_subsampled /*!< [in] 4:2:2 sampling, a pair holding 4 samples. 4:4:4 and RGB otherwise, a pair holding 6 samples.*/
+   , uint32_t sample_depth /*!< [in] Number of bits of a sample.*/
+);
+
+/*!
+   @brief Copies every other pair of samples of a line, starting at the first or the second pair.
+*/
+void extract_sample_pairs(const uint8_t* line /*!< [in] Line of 2 * pair_count pairs.*/
+   , uint32_t pair_count /*!< [in] Number of pairs to extract.*/
+   , uint32_t pair_size /*!< [in] Size of a pair in bytes.*/
+   , uint32_t phase /*!< [in] 0 for the even pairs, 1 for the odd pairs.*/
+   , uint8_t* pairs /*!< [out] pair_count pairs. Must not overlap the line.*/
+);
+
+void extract_sample_pairs_scalar(const uint8_t* line, uint32_t pair_count, uint32_t pair_size, uint32_t phase, uint8_t* pairs);
+
+/*!
+   @brief Builds a line from its even and its odd pairs of samples, alternating them.
+*/
+void interleave_sample_pairs(const uint8_t* even_pairs /*!< [in] pair_count pairs, going to the even positions.*/
+   , const uint8_t* odd_pairs /*!< [in] pair_count pairs, going to the odd positions.*/
+   , uint32_t pair_count /*!< [in] Number of pairs of each input.*/
+   , uint32_t pair_size /*!< [in] Size of a pair in bytes.*/
+   , uint8_t* line /*!< [out] Line of 2 * pair_count pairs. Must not overlap the inputs.*/
+);
+
+void interleave_sample_pairs_scalar(const uint8_t* even_pairs, const uint8_t* odd_pairs, uint32_t pair_count, uint32_t pair_size, uint8_t* line);
+
+class TwoSampleInterleave
+{
+public:
+
+   TwoSampleInterleave(uint32_t frame_width /*!< [in] Width of the frame in pixels. Must be a multiple of 4.*/
+      , uint32_t frame_height /*!< [in] Height of the progressive frame in lines. Must be even.*/
+      , uint32_t pair_size /*!< [in] Size of a pair of samples in bytes, as given by get_sample_pair_size.*/
+   );
+
+   /*!
+      @brief Tells if the frame given to the constructor can be divided.
+   */
+   bool is_valid() const { return pair_size != 0; }
+
+   /*!
+      @brief Writes lines of the sub-image of a link.
+
+      @returns false if the division or the link is not valid, nothing being written.
+   */
+   bool split(const uint8_t* frame /*!< [in] Frame of frame_size() bytes.*/
+      , uint32_t link /*!< [in] Link, from 0 to 3.*/
+      , uint8_t* link_frame /*!< [out] Sub-image of link_size() bytes. Must not overlap the frame.*/
+      , uint32_t first_line = 0 /*!< [in] First line of the sub-image to write.*/
+      , uint32_t line_count = UINT32_MAX /*!< [in] Number of lines to write, up to the end of the sub-image.*/
+   ) const;
+
+   /*!
+      @brief Writes lines of the frame from the sub-images of the four links.
+
+      @returns false if the division is not valid or a sub-image is missing, nothing being written.
+   */
+   bool merge(const uint8_t* const link_frames[quad_link_count] /*!< [in] Sub-images of link_size() bytes, in link order.*/
+      , uint8_t* frame /*!< [out] Frame of frame_size() bytes. Must not overlap the sub-images.*/
+      , uint32_t first_line = 0 /*!< [in] First line of the frame to write.*/
+      , uint32_t line_count = UINT32_MAX /*!< [in] Number of lines to write, up to the end of the frame.*/
+   ) const;
+
+   size_t frame_size() const { return static_cast<size_t>(line_size) * frame_height; }
+   size_t link_size() const { return frame_size() / quad_link_count; }
+   uint32_t frame_line_size() const { return line_size; }
+   uint32_t link_line_size() const { return line_size / 2; }
+   uint32_t link_height() const { return frame_height / 2; }
+
+private:
+
+   uint32_t frame_height;
+   uint32_t pair_size;
+   uint32_t line_size; /*! Size of a line of the frame in bytes */
+};
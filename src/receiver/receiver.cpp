@@ -13,7 +13,10 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 #include <thread>
@@ -24,14 +27,6 @@
 #include <stdint.h>
 #endif
 
-#if defined (__linux__) || defined (__APPLE__)
-#include "../keyboard.h"
-#else
-#include <conio.h>
-#define init_keyboard()
-#define close_keyboard()
-#endif
-
 #include "nmos/model.h"
 #include "nmos/log_model.h"
 #include "nmos/log_gate.h"
@@ -39,7 +34,14 @@
 #include "nmos/node_server.h"
 
 #include "../tools.h"
+#include "../stop_request.h"
+#include "../startup_sequence.h"
 #include "../nmos_tools.h"
+#include "../frame_signature.h"
+#include "../frame_copy.h"
+#include "deinterlacer.h"
+#include "polyphase_scaler.h"
+#include "two_sample_interleave.h"
 
 #include "videoviewer/videoviewer.hpp"
 
@@ -61,7 +63,7 @@ void render_video(Deltacast::VideoViewer& viewer,int window_width, int window_he
 int main(int argc, char* argv[])
 {
    //Stream parameters
-   const std::string media_nic_name = "eno1";  //Streaming network interface controller name
+   const std::vector<std::string> media_nic_names = { "eno1" };  //Streaming network interface controller names, add a second one to receive both paths of a redundant stream (ST2022-7)
 
    //VMIP parameters
    const uint32_t conductor_cpu_core_os_id = 1; //IPVC Conductor CPU core index
@@ -72,6 +74,7 @@ int main(int argc, char* argv[])
    const std::string management_nic_name = "eno2";  //Management network interface controller name
    const std::string management_nic_ip = "192.168.0.10"; //Management network interface controller
    const uint32_t default_destination_address = 0xe0010107; //default IP destination address used for resolving "auto" nmos parameter
+   const uint32_t default_redundant_destination_address = 0xe0020107; //default IP destination address of the second path used for resolving "auto" nmos parameter
    const uint16_t default_destination_udp_port = 1025; //default UDP destination port used for resolving "auto" nmos parameter IP address
 
    //Node parameters
@@ -83,102 +86,132 @@ int main(int argc, char* argv[])
    const int node_api_port = 3212; //port used by the node to expose its registry API
    const int connection_api_port = 3215; //port used by the node to expose its connection API
 
+   //Viewer
+   const uint32_t viewer_window_width = 800; //Initial size of the viewer window
+   const uint32_t viewer_window_height = 600;
+   const uint32_t preview_scaler_taps = 4; //Taps of the filter scaling the frames larger than the window down to its size (2 bilinear, 4 or 6 Lanczos), 0 to show them at full size
+   const DeinterlaceMode deinterlace_mode = DeinterlaceMode::weave; //Deinterlacing method of the interlaced frames shown by the viewer
+
+   //Quad-link
+   const bool quad_link = false; //Receive the four links of a two-sample interleave (2SI) quad-link and merge them into one frame. The NMOS receiver is connected to the first link,
+                                 //the next links being received on the following multicast groups, as sent by the sender with --quad-link
+   const uint32_t max_alignment_slots = 8; //Slots of a link dropped at most per frame to catch up with the other links
+
 
-   HANDLE vcs_context = nullptr, stream = nullptr, slot = nullptr;
+   const uint32_t link_count = quad_link ? quad_link_count : 1; //A VMIP stream per link
+   HANDLE vcs_context = nullptr;
+   std::vector<HANDLE> streams(link_count, nullptr), slots(link_count, nullptr);
    VMIP_VCS_STATUS vcs_status;
-   uint64_t media_nic_id = (uint64_t)-1;
+   std::vector<uint64_t> media_nic_ids;
    VMIP_STREAMTYPE stream_type = VMIP_ST_RX;
    VMIP_STREAM_COMMON_STATUS stream_status;
    uint64_t conductor_id = (uint64_t)-1;
    VMIP_ERRORCODE result = VMIPERR_NOERROR;
    Deltacast::VideoViewer viewer;
+   std::vector<FrameSignatureVerifier> signature_verifiers(link_count);
+   std::unique_ptr<TwoSampleInterleave> quad_link_division;
+   std::vector<uint8_t> merged_frame;
+   std::unique_ptr<Deinterlacer> deinterlacer;
+   std::unique_ptr<PolyphaseScaler> preview_scaler;
+   std::vector<uint8_t> deinterlaced_frame;
 
    uint32_t frame_width;
    uint32_t frame_height;
    uint32_t frame_rate;
    bool8_t interlaced;
    bool8_t is_us;
+   uint32_t sample_depth = 10;
+   VMIP_VIDEO_SAMPLING video_sampling = VMIP_VIDEO_SAMPLING_YCBCR_422;
 
-   //Buffer that will be created and filled by the API
-   uint8_t* buffer = nullptr;
-   uint32_t buffer_size = 0, index = 0;
+   //Buffers that will be created and filled by the API, one per link
+   std::vector<uint8_t*> buffers(link_count, nullptr);
+   std::vector<uint32_t> buffer_sizes(link_count, 0);
+   uint32_t index = 0;
+
+   //Alignment of the links of a quad-link
+   std::vector<uint64_t> alignment_dropped_slots(link_count, 0); //Slots dropped per link to catch up with the other links
+   uint64_t misaligned_frames = 0; //Frames merged from links still carrying different frames
+   uint64_t max_link_skew = 0; //Largest difference between the sequence numbers of the links, in frames
+   uint64_t merged_frames = 0; //Frames merged from the four links
 
    bool exit = false;
 
-   init_keyboard();
+   start_stop_request_listener();
 
    std::cout << "IP VIRTUAL CARD NMOS ST2110-20 RECEPTION SAMPLE APPLICATION\n(c) DELTACAST\n--------------------------------------------------------" << std::endl << std::endl;
 
+   //The phases that do not depend on each other run concurrently, the breakdown of the startup being printed once the sample is ready.
+   StartupSequence startup;
+
    //Creates the context in which the stream will be created. This handle will be needed for all following calls.
-   result = VMIP_CreateVCSContext("http://localhost:8080/", &vcs_context);
-   if(result == VMIPERR_NOERROR)
+   result = startup.run("VCS context", [&]()
    {
-      result = VMIP_GetVCSStatus(vcs_context, &vcs_status);
-      if (result != VMIPERR_NOERROR)
+      VMIP_ERRORCODE context_result = VMIP_CreateVCSContext("http://localhost:8080/", &vcs_context);
+      if(context_result == VMIPERR_NOERROR)
       {
-         std::cout << "Error when getting the VCS status"<< " [" << to_string(result) << "]" << std::endl;
+         context_result = VMIP_GetVCSStatus(vcs_context, &vcs_status);
+         if (context_result != VMIPERR_NOERROR)
+         {
+            std::cout << "Error when getting the VCS status"<< " [" << to_string(context_result) << "]" << std::endl;
+         }
+         else
+            std::cout << "Connection established to VCS " << version_to_string(vcs_status.VcsVersion) << std::endl;
       }
       else
-         std::cout << "Connection established to VCS " << version_to_string(vcs_status.VcsVersion) << std::endl;
-   }
-   else
-      std::cout << "Error when Creating the context" << " [" << to_string(result) << "]" << std::endl;
-
-   if(result == VMIPERR_NOERROR)
-   {
-      print_cpu_cores_info(vcs_context);
-
-      print_nics_info(vcs_context);
+         std::cout << "Error when Creating the context" << " [" << to_string(context_result) << "]" << std::endl;
 
-      //Conductor creation and configuration.
-      //The conductor will be responsible of receiving the packets at the fastest possible rate.
-      result = configure_conductor(conductor_cpu_core_os_id, vcs_context, &conductor_id);
-      if(result == VMIPERR_NOERROR)
+      if(context_result == VMIPERR_NOERROR)
       {
-         //Conductor start. At this point, the associated CPU core will be used 100%
-         result = VMIP_StartConductor(vcs_context, conductor_id);
-         if (result != VMIPERR_NOERROR)
-            std::cout << "Error when starting conductor" << " [" << to_string(result) << "]" << std::endl;
+         print_cpu_cores_info(vcs_context);
+
+         print_nics_info(vcs_context);
       }
-   }
+      return context_result;
+   });
 
    if(result == VMIPERR_NOERROR)
    {
-      result = get_nic_id_from_name(vcs_context, media_nic_name, &media_nic_id);
+      if (media_nic_names.empty() || media_nic_names.size() > nmos_tools::max_path_count)
+      {
+         std::cout << "The receiver needs one or " << nmos_tools::max_path_count << " media NICs" << std::endl;
+         result = VMIPERR_BAD_CONFIGURATION;
+      }
+
+      for (size_t leg = 0; leg < media_nic_names.size() && result == VMIPERR_NOERROR; leg++)
+      {
+         uint64_t media_nic_id = (uint64_t)-1;
+         result = get_nic_id_from_name(vcs_context, media_nic_names[leg], &media_nic_id);
+         if (result == VMIPERR_NOERROR)
+            media_nic_ids.push_back(media_nic_id);
+      }
       
-      if (result == VMIPERR_NOERROR)
+      for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
       {
-         result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &stream);
+         result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &streams[link]);
          if (result != VMIPERR_NOERROR)
             std::cout << "Error when creating stream" << " [" << to_string(result) << "]" << std::endl;
       }
    }
 
-   nmos_tools::NodeServerReceiver::TransportParams resolve_auto_transport_params;
+   //Each leg listens on its own NIC and multicast group. The legs without a NIC stay disabled.
+   nmos_tools::NodeServerReceiver::TransportLegs resolve_auto_transport_params = {};
 
-   if(result == VMIPERR_NOERROR)
+   for (size_t leg = 0; leg < media_nic_ids.size() && result == VMIPERR_NOERROR; leg++)
    {
-      result = get_nic_id_from_name(vcs_context, media_nic_name, &media_nic_id);
+      VMIP_NETWORK_ITF_CONFIG network_interface_config;
+      result = VMIP_GetNetworkInterfaceConfig(vcs_context, media_nic_ids[leg], &network_interface_config);
       if(result != VMIPERR_NOERROR)
       {
-         std::cout << "Error when getting the NIC ID from name" << " [" << to_string(result) << "]" << std::endl;
+         std::cout << "Error when getting the network interface configuration" << " [" << to_string(result) << "]" << std::endl;
       }
       else
       {
-         VMIP_NETWORK_ITF_CONFIG network_interface_config;
-         result = VMIP_GetNetworkInterfaceConfig(vcs_context, media_nic_id, &network_interface_config);
-         if(result != VMIPERR_NOERROR)
-         {
-            std::cout << "Error when getting the network interface configuration" << " [" << to_string(result) << "]" << std::endl;
-         }
-         else
-         {
-            resolve_auto_transport_params.ip_interface = network_interface_config.InterfaceIpAddress;
-         }
+         resolve_auto_transport_params[leg].ip_interface = network_interface_config.InterfaceIpAddress;
       }
-      resolve_auto_transport_params.ip_multicast = default_destination_address;
-      resolve_auto_transport_params.ip_src = 0; //no filtering on source ip
-      resolve_auto_transport_params.port_dst = default_destination_udp_port;
+      resolve_auto_transport_params[leg].ip_multicast = (leg == 0) ? default_destination_address : default_redundant_destination_address;
+      resolve_auto_transport_params[leg].ip_src = 0; //no filtering on source ip
+      resolve_auto_transport_params[leg].port_dst = default_destination_udp_port;
+      resolve_auto_transport_params[leg].rtp_enabled = true;
    }
 
    nmos::node_model node_model;
@@ -206,23 +239,55 @@ int main(int argc, char* argv[])
    log_model.settings = node_model.settings;
    log_model.level = nmos::fields::logging_level(log_model.settings);
 
-   nmos_tools::NodeServerReceiver::TransportParams active_transport_params = resolve_auto_transport_params;
-   nmos_tools::NodeServerReceiver node_server(node_model, log_model, gate, device_name, device_description, resolve_auto_transport_params, active_transport_params, media_nic_name);  
+   nmos_tools::NodeServerReceiver::TransportLegs active_transport_params = resolve_auto_transport_params;
+   nmos_tools::NodeServerReceiver node_server(node_model, log_model, gate, device_name, device_description, resolve_auto_transport_params, active_transport_params, media_nic_names);  
    
-   if(!node_server.node_implementation_init())
+   //The node does not call VMIP while it starts : it is brought up while the conductor is configured. The name of its error code is taken here.
+   const std::string node_error_name = to_string(VMIPERR_OPERATIONFAILED);
+   if (result == VMIPERR_NOERROR)
    {
-      result = VMIPERR_OPERATIONFAILED;
-      std::cout << "Error when initializing the node server" << " [" << to_string(result) << "]" << std::endl;
+      startup.launch("NMOS node", [&]()
+      {
+         if(!node_server.node_implementation_init())
+         {
+            std::cout << "Error when initializing the node server" << " [" << node_error_name << "]" << std::endl;
+            return VMIPERR_OPERATIONFAILED;
+         }
+
+         node_server.start();
+         std::cout << "NMOS: node ready for connections" << std::endl;
+         return VMIPERR_NOERROR;
+      });
    }
 
-   if (result == VMIPERR_NOERROR)
+   //Conductor creation and configuration.
+   //The conductor will be responsible of receiving the packets at the fastest possible rate. It is configured after the stream is created,
+   //the VMIP calls being made one after the other, and the stream is only configured toward it once a sender is connected.
+   if(result == VMIPERR_NOERROR)
    {
-      node_server.start();
-      std::cout << "NMOS: node ready for connections" << std::endl;
+      result = startup.run("conductor", [&]()
+      {
+         VMIP_ERRORCODE conductor_result = configure_conductor(conductor_cpu_core_os_id, vcs_context, &conductor_id);
+         if(conductor_result == VMIPERR_NOERROR)
+         {
+            //Conductor start. At this point, the associated CPU core will be used 100%
+            conductor_result = VMIP_StartConductor(vcs_context, conductor_id);
+            if (conductor_result != VMIPERR_NOERROR)
+               std::cout << "Error when starting conductor" << " [" << to_string(conductor_result) << "]" << std::endl;
+         }
+         return conductor_result;
+      });
    }
 
-   nmos_tools::NodeServerReceiver::TransportParams previous_transport_params = resolve_auto_transport_params;
+   const VMIP_ERRORCODE startup_result = startup.wait_all();
+   if (result == VMIPERR_NOERROR)
+      result = startup_result;
+   if (result == VMIPERR_NOERROR)
+      startup.print_report();
+
+   nmos_tools::NodeServerReceiver::TransportLegs previous_transport_params = resolve_auto_transport_params;
    std::string previous_sdp = "INVALID SDP";
+   uint64_t scheduled_switch_time = 0; //Frame boundary of the scheduled activation being applied, 0 if none
 
    //Get the system parameters and apply new PTP parameters
    nmos_tools::NmosPtpSystemParameters ptp_system_parameters = {};
@@ -233,9 +298,8 @@ int main(int argc, char* argv[])
       //Wait for the stream to be enabled
       while(node_server.is_enabled == false)
       {
-         if (_kbhit())
-         { 
-            _getch();
+         if (is_stop_requested())
+         {
             exit = true;
             break;
          }
@@ -251,7 +315,7 @@ int main(int argc, char* argv[])
             if(memcmp(&ptp_system_parameters, &previous_ptp_system_parameters, sizeof(nmos_tools::NmosPtpSystemParameters)) != 0)
             {
                //ptp_system_parameters were changed, we need to update the ptp configuration
-               result = apply_ptp_parameters(vcs_context,static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout), media_nic_id);
+               result = apply_ptp_parameters(vcs_context,static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout), media_nic_ids[0]);
                if(result != VMIPERR_NOERROR)
                {   
                   exit = true;
@@ -271,41 +335,88 @@ int main(int argc, char* argv[])
          break;
 
       std::string sdp = node_server.get_sdp();
-      if(memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerReceiver::TransportParams)) != 0 || sdp != previous_sdp)
+      if(memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerReceiver::TransportLegs)) != 0 || sdp != previous_sdp)
       {
-         //active parameters were changed, we need to update the stream
-         result = VMIP_DestroyStream(stream);
-         if (result != VMIPERR_NOERROR)
-            std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+         //active parameters were changed, we need to update the streams of the links
+         for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
+         {
+            result = VMIP_DestroyStream(streams[link]);
+            streams[link] = nullptr;
+            if (result != VMIPERR_NOERROR)
+               std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+         }
 
-         if (result == VMIPERR_NOERROR)
+         for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
          {
-            result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &stream);
+            result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &streams[link]);
             if (result != VMIPERR_NOERROR)
                std::cout << "Error when creating stream" << " [" << to_string(result) << "]" << std::endl;
          }
          if(result == VMIPERR_NOERROR)
          {
-            result = configure_stream_from_sdp(vcs_context, stream_type, processinge_cpu_core_os_id,
-                                          sdp, active_transport_params.ip_multicast , active_transport_params.port_dst, {media_nic_id}, conductor_id, management_thread_cpu_core_os_id, stream);
+            //The paths of the SDP are received on the enabled legs, in their order.
+            std::vector<uint32_t> destination_ips;
+            std::vector<uint16_t> destination_udp_ports;
+            std::vector<uint64_t> enabled_nic_ids;
+            for (size_t leg = 0; leg < media_nic_ids.size(); leg++)
+            {
+               if (!active_transport_params[leg].rtp_enabled)
+                  continue;
+               destination_ips.push_back(active_transport_params[leg].ip_multicast);
+               destination_udp_ports.push_back(active_transport_params[leg].port_dst);
+               enabled_nic_ids.push_back(media_nic_ids[leg]);
+            }
+            if (enabled_nic_ids.empty())
+            {
+               destination_ips.push_back(active_transport_params[0].ip_multicast);
+               destination_udp_ports.push_back(active_transport_params[0].port_dst);
+               enabled_nic_ids.push_back(media_nic_ids[0]);
+            }
+
+            //The links of a quad-link share the format of the SDP, each link being sent to the multicast group following the one of the previous link.
+            for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
+            {
+               std::vector<uint32_t> link_destination_ips = destination_ips;
+               for (uint32_t& link_destination_ip : link_destination_ips)
+                  link_destination_ip += link;
+               result = configure_stream_from_sdp(vcs_context, stream_type, processinge_cpu_core_os_id,
+                                             sdp, link_destination_ips, destination_udp_ports, enabled_nic_ids, conductor_id, management_thread_cpu_core_os_id, streams[link]);
+            }
             previous_transport_params = active_transport_params;
             previous_sdp = sdp;
          }
          if(result == VMIPERR_NOERROR)
          {
             VMIP_STREAM_ESSENCE_CONFIG essence_config;
-            result = VMIP_GetStreamEssenceConfig(stream, &essence_config);
+            result = VMIP_GetStreamEssenceConfig(streams[0], &essence_config);
             if(result == VMIPERR_NOERROR)
             {
                result = VMIP_GetVideoStandardInfo(essence_config.EssenceS2110_20Prop.VideoStandard, &frame_width, &frame_height, &frame_rate, &interlaced, &is_us);
+               sample_depth = nmos_tools::to_bit_depth(essence_config.EssenceS2110_20Prop.UserBitDepth);
+               video_sampling = essence_config.EssenceS2110_20Prop.UserBitSampling;
+            }
+         }
+
+         //The merged frame is twice as wide and twice as high as the links.
+         quad_link_division.reset();
+         if(result == VMIPERR_NOERROR && quad_link)
+         {
+            frame_width *= 2;
+            frame_height *= 2;
+            quad_link_division = std::make_unique<TwoSampleInterleave>(frame_width, frame_height, get_sample_pair_size(video_sampling == VMIP_VIDEO_SAMPLING_YCBCR_422, sample_depth));
+            if (interlaced || !quad_link_division->is_valid())
+            {
+               result = VMIPERR_BAD_CONFIGURATION;
+               std::cout << "Error when merging the links of a " << frame_width << "x" << frame_height << (interlaced ? "i " : "p ") << to_string(video_sampling) << " " << sample_depth
+                  << " bits quad-link" << " [" << to_string(result) << "]" << std::endl;
             }
          }
 
       }
 
-      if(result == VMIPERR_NOERROR)
+      for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
       {
-         result = VMIP_StartStream(stream);
+         result = VMIP_StartStream(streams[link]);
          if (result != VMIPERR_NOERROR)
          {
             std::cout << "Error when starting stream" << " [" << to_string(result) << "]" << std::endl;
@@ -319,19 +430,113 @@ int main(int argc, char* argv[])
 
          uint32_t slot_timeout = 0;
 
+         //Frames larger than the window are scaled down to it, keeping their aspect ratio, before being handed to the viewer.
+         uint32_t preview_width = frame_width, preview_height = frame_height;
+         preview_scaler.reset();
+         if (preview_scaler_taps != 0 && video_sampling == VMIP_VIDEO_SAMPLING_YCBCR_422 && sample_depth == 10
+            && (frame_width > viewer_window_width || frame_height > viewer_window_height))
+         {
+            if (static_cast<uint64_t>(frame_width) * viewer_window_height > static_cast<uint64_t>(frame_height) * viewer_window_width)
+            {
+               preview_width = viewer_window_width;
+               preview_height = static_cast<uint32_t>(static_cast<uint64_t>(frame_height) * viewer_window_width / frame_width);
+            }
+            else
+            {
+               preview_width = static_cast<uint32_t>(static_cast<uint64_t>(frame_width) * viewer_window_height / frame_height);
+               preview_height = viewer_window_height;
+            }
+            preview_width &= ~1u;
+
+            preview_scaler = std::make_unique<PolyphaseScaler>(frame_width, frame_height, preview_width, preview_height, preview_scaler_taps);
+            if (preview_scaler->is_valid())
+               std::cout << "Preview scaled from " << frame_width << "x" << frame_height << " to " << preview_width << "x" << preview_height << std::endl;
+            else
+            {
+               preview_scaler.reset();
+               preview_width = frame_width;
+               preview_height = frame_height;
+            }
+         }
+
          //start viewer
-         std::thread viewerthread(render_video, std::ref(viewer), 800, 600, node_name.c_str(), frame_width, frame_height, Deltacast::VideoViewer::InputFormat::ycbcr_422_10_be, 100);
+         std::thread viewerthread(render_video, std::ref(viewer), viewer_window_width, viewer_window_height, node_name.c_str(), preview_width, preview_height, Deltacast::VideoViewer::InputFormat::ycbcr_422_10_be, 100);
          bool stop_monitoring = false;
-         std::thread monitoring_thread (monitor_rx_stream_status, stream, &stop_monitoring, &slot_timeout);
+         std::thread monitoring_thread (monitor_rx_stream_status, streams[0], &stop_monitoring, &slot_timeout);
          uint8_t* data = nullptr;
          uint64_t size = 0;
+         for (FrameSignatureVerifier& signature_verifier : signature_verifiers)
+            signature_verifier.reset();
+         deinterlacer.reset();
+
+         //The slots locked on the links are handed back together, a link missing its slot dropping the slots of the others.
+         auto unlock_slots = [&]()
+         {
+            VMIP_ERRORCODE unlock_result = VMIPERR_NOERROR;
+            for (uint32_t link = 0; link < link_count; link++)
+            {
+               if (slots[link] == nullptr)
+                  continue;
+               const VMIP_ERRORCODE link_result = VMIP_UnlockSlot(streams[link], slots[link]);
+               slots[link] = nullptr;
+               if (unlock_result == VMIPERR_NOERROR)
+                  unlock_result = link_result;
+            }
+            return unlock_result;
+         };
+
+         //The sub-images of a frame are only merged once the four links carry it : the links behind the most advanced one drop their
+         //slots until they catch up. The frame is told by its signature, unsigned links being assumed to be aligned.
+         auto align_links = [&]()
+         {
+            for (uint32_t attempt = 0; attempt <= max_alignment_slots; attempt++)
+            {
+               uint64_t sequences[quad_link_count] = {};
+               for (uint32_t link = 0; link < link_count; link++)
+               {
+                  if (!read_frame_sequence(buffers[link], buffer_sizes[link], &sequences[link]))
+                     return VMIPERR_NOERROR;
+               }
+
+               const uint64_t newest_sequence = *std::max_element(sequences, sequences + link_count);
+               const uint64_t oldest_sequence = *std::min_element(sequences, sequences + link_count);
+               if (newest_sequence == oldest_sequence)
+                  return VMIPERR_NOERROR;
+               max_link_skew = std::max(max_link_skew, newest_sequence - oldest_sequence);
+               if (attempt == max_alignment_slots)
+                  break;
+
+               for (uint32_t link = 0; link < link_count; link++)
+               {
+                  if (sequences[link] == newest_sequence)
+                     continue;
+
+                  VMIP_ERRORCODE link_result = VMIP_UnlockSlot(streams[link], slots[link]);
+                  slots[link] = nullptr;
+                  if (link_result == VMIPERR_NOERROR)
+                     link_result = VMIP_LockSlot(streams[link], &slots[link]);
+                  if (link_result != VMIPERR_NOERROR)
+                  {
+                     slots[link] = nullptr;
+                     return link_result;
+                  }
+                  link_result = VMIP_GetSlotBuffer(streams[link], slots[link], VMIP_ST2110_20_BT_VIDEO, &buffers[link], &buffer_sizes[link]);
+                  if (link_result != VMIPERR_NOERROR)
+                     return link_result;
+                  alignment_dropped_slots[link]++;
+               }
+            }
+
+            //The links keep drifting apart, the frame is shown as it is.
+            misaligned_frames++;
+            return VMIPERR_NOERROR;
+         };
          
          //Reception loop
          while (1)
          {
-            if (_kbhit())
+            if (is_stop_requested())
             {
-               _getch();
                exit = true;
                break;
             }
@@ -342,13 +547,25 @@ int main(int argc, char* argv[])
             }
 
             sdp = node_server.get_sdp();
-            if(!node_server.is_enabled || memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerReceiver::TransportParams)) != 0 || sdp != previous_sdp)
+            if(!node_server.is_enabled)
+            {
+               scheduled_switch_time = 0;
                break;
+            }
+            if(memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerReceiver::TransportLegs)) != 0 || sdp != previous_sdp)
+            {
+               //A scheduled activation lands on the first frame boundary at or after its time, the current stream being received until then.
+               scheduled_switch_time = (node_server.activation_time != 0) ? next_frame_boundary(node_server.activation_time, frame_rate * (is_us ? 1000 : 1001), 1001) : 0;
+               if (scheduled_switch_time == 0 || nmos_tools::get_tai_time() >= scheduled_switch_time)
+                  break;
+            }
 
-            //Try to lock the next slot.
-            result = VMIP_LockSlot(stream, &slot);
+            //Try to lock the next slot of each link.
+            for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
+               result = VMIP_LockSlot(streams[link], &slots[link]);
             if (result != VMIPERR_NOERROR)
             {
+               unlock_slots();
                if (result == VMIPERR_TIMEOUT)
                {
                   slot_timeout++;
@@ -359,26 +576,88 @@ int main(int argc, char* argv[])
                break;
             }
 
-            //Get the video buffer associated to the slot.
-            result = VMIP_GetSlotBuffer(stream, slot, VMIP_ST2110_20_BT_VIDEO, &buffer, &buffer_size);
-            if (result != VMIPERR_NOERROR)
+            //Get the video buffer associated to the slot of each link.
+            for (uint32_t link = 0; link < link_count && result == VMIPERR_NOERROR; link++)
             {
-               std::cout << "Error when getting slot buffer at slot " << index << " [" << to_string(result) << "]" << std::endl;
+               result = VMIP_GetSlotBuffer(streams[link], slots[link], VMIP_ST2110_20_BT_VIDEO, &buffers[link], &buffer_sizes[link]);
+               if (result != VMIPERR_NOERROR)
+                  std::cout << "Error when getting slot buffer at slot " << index << " [" << to_string(result) << "]" << std::endl;
             }
 
+            if (result == VMIPERR_NOERROR && quad_link_division)
+            {
+               result = align_links();
+               if (result == VMIPERR_TIMEOUT)
+               {
+                  slot_timeout++;
+                  result = VMIPERR_NOERROR;
+                  unlock_slots();
+                  continue;
+               }
+               if (result != VMIPERR_NOERROR)
+                  std::cout << "Error when aligning the links at slot " << index << " [" << to_string(result) << "]" << std::endl;
+            }
+
+            //Frames stamped by the sender carry a sequence number and a CRC32C, unsigned frames are only counted. Each link is signed on its own.
+            if (result == VMIPERR_NOERROR)
+            {
+               for (uint32_t link = 0; link < link_count; link++)
+                  signature_verifiers[link].verify(buffers[link], buffer_sizes[link]);
+            }
+
+            //The first frame of the stream of a scheduled activation tells when the switch happened.
+            if (scheduled_switch_time != 0)
+            {
+               print_switch_error(vcs_context, std::string(), scheduled_switch_time, nmos_tools::get_tai_time());
+               scheduled_switch_time = 0;
+            }
+
+            const uint8_t* buffer = buffers[0];
+            const size_t frame_size = quad_link_division ? quad_link_division->frame_size() : buffer_sizes[0];
             viewer.lock_data(&data, &size);
-            if(size != buffer_size)
+            if(size != (preview_scaler ? preview_scaler->target_frame_size() : frame_size) || (preview_scaler && frame_size != preview_scaler->source_frame_size()))
             {
-               std::cout << "Buffer size ("<< buffer_size <<") does not match with videoviewer data size (" << size << ")" << std::endl;
+               std::cout << "Buffer size ("<< frame_size <<") does not match with videoviewer data size (" << size << ")" << std::endl;
             }
-            else
+            else if (result == VMIPERR_NOERROR)
             {
-               memcpy(data, buffer, size);
+               const uint8_t* picture = buffer;
+               if (quad_link_division)
+               {
+                  //The sub-images of the links are merged straight into the viewer buffer, or before being scaled.
+                  merged_frame.resize(preview_scaler ? frame_size : 0);
+                  uint8_t* merged = preview_scaler ? merged_frame.data() : data;
+                  const uint8_t* link_frames[quad_link_count] = { buffers[0], buffers[1], buffers[2], buffers[3] };
+                  if (buffer_sizes[1] == buffer_sizes[0] && buffer_sizes[2] == buffer_sizes[0] && buffer_sizes[3] == buffer_sizes[0]
+                     && buffer_sizes[0] >= quad_link_division->link_size() && quad_link_division->merge(link_frames, merged))
+                  {
+                     merged_frames++;
+                     picture = merged;
+                  }
+               }
+               else if (interlaced)
+               {
+                  //Interlaced slots hold the two fields one after the other, they are deinterlaced straight into the viewer buffer, or before being scaled.
+                  if (!deinterlacer)
+                     deinterlacer = std::make_unique<Deinterlacer>(buffer_sizes[0] / frame_height, frame_height, sample_depth);
+                  deinterlaced_frame.resize(preview_scaler ? frame_size : 0);
+                  uint8_t* progressive_frame = preview_scaler ? deinterlaced_frame.data() : data;
+                  if (deinterlacer->deinterlace(deinterlace_mode, buffer, progressive_frame))
+                     picture = progressive_frame;
+               }
+
+               if (preview_scaler)
+                  preview_scaler->scale(picture, data);
+               else if (picture != data)
+               {
+                  //The frame is not read again by this thread, it is copied without polluting the cache of the conductor.
+                  copy_frame(data, picture, size);
+               }
             }
             viewer.unlock_data();
 
-            //Unlock the slot. buffer wont be available anymore
-            result = VMIP_UnlockSlot(stream, slot);
+            //Unlock the slots. The buffers wont be available anymore
+            result = unlock_slots();
             if (result != VMIPERR_NOERROR)
             {
                std::cout << "Error when unlocking slot at slot " << index << " [" << to_string(result) << "]" << std::endl;
@@ -394,22 +673,44 @@ int main(int argc, char* argv[])
          viewer.stop();
          viewerthread.join();
 
-         VMIP_ERRORCODE result_stop_stream; //temporary variable to not overwrite result if an error occured in the transmission loop
+         for (uint32_t link = 0; link < link_count; link++)
+         {
+            const FrameSignatureStatistics& signature_statistics = signature_verifiers[link].get_statistics();
+            std::cout << std::endl << "Frame signatures" << (quad_link ? " of link " + std::to_string(link + 1) : std::string()) << " : " << signature_statistics.verified << " verified, " << signature_statistics.corrupt << " corrupt, "
+               << signature_statistics.repeated << " repeated, " << signature_statistics.skipped << " skipped, " << signature_statistics.out_of_order << " out of order, "
+               << signature_statistics.unsigned_frames << " unsigned";
+            if (quad_link)
+               std::cout << ", " << alignment_dropped_slots[link] << " slots dropped to align";
+            std::cout << std::endl;
+         }
 
-         result_stop_stream = VMIP_StopStream(stream);
-         if (result_stop_stream != VMIPERR_NOERROR)
+         //How far apart the links were received.
+         if (quad_link_division)
+            std::cout << "Quad-link merge : " << merged_frames << " frames, " << misaligned_frames << " frames merged misaligned, links up to "
+               << max_link_skew << " frames apart" << std::endl;
+
+         for (uint32_t link = 0; link < link_count; link++)
          {
-            std::cout << "Error when stopping the stream" << " [" << to_string(result_stop_stream) << "]" << std::endl;
-            result = result_stop_stream;
+            VMIP_ERRORCODE result_stop_stream; //temporary variable to not overwrite result if an error occured in the transmission loop
+
+            result_stop_stream = VMIP_StopStream(streams[link]);
+            if (result_stop_stream != VMIPERR_NOERROR)
+            {
+               std::cout << "Error when stopping the stream" << " [" << to_string(result_stop_stream) << "]" << std::endl;
+               result = result_stop_stream;
+            }
          }
       }
    }
    
-   if(stream)
+   for (HANDLE stream : streams)
    {
-      result = VMIP_DestroyStream(stream);
-      if (result != VMIPERR_NOERROR)
-         std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+      if(stream)
+      {
+         result = VMIP_DestroyStream(stream);
+         if (result != VMIPERR_NOERROR)
+            std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+      }
    }
 
    if(conductor_id != (uint64_t)-1)
@@ -430,7 +731,7 @@ int main(int argc, char* argv[])
          std::cout << "Error when destroying the context" << " [" << to_string(result) << "]" << std::endl;
    }
 
-   close_keyboard();
+   stop_stop_request_listener();
 
    node_server.stop();
 
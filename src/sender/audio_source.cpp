@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "audio_source.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+constexpr uint32_t min_batch_sample_count = 2048; /*! The tone table is repeated until it holds that many samples, for long enough batches */
+constexpr double tone_level = 0.125892541; /*! -18 dBFS, the alignment level of EBU R68 */
+
+bool parse_audio_signal(const std::string& name, AudioSignal& signal)
+{
+   for (AudioSignal candidate : { AudioSignal::tone, AudioSignal::silence })
+   {
+      if (name == to_string(candidate))
+      {
+         signal = candidate;
+         return true;
+      }
+   }
+   return false;
+}
+
+std::string to_string(AudioSignal signal)
+{
+   std::string result = "Undefined";
+
+   switch (signal)
+   {
+   case AudioSignal::tone: result = "tone"; break;
+   case AudioSignal::silence: result = "silence"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+AudioSource::AudioSource(uint32_t channel_count, AudioSignal signal, uint32_t tone_frequency)
+   : channel_count(std::max(channel_count, 1u)), signal(signal), tone_periods(0), tone_position(0), sample_periods(0)
+{
+   if (signal == AudioSignal::tone)
+   {
+      //48000 / gcd sample periods hold a whole number of periods of the tone : 48 sample periods for 1 kHz.
+      tone_frequency = std::min(std::max(tone_frequency, 1u), audio_sample_rate / 2);
+      const uint32_t period_count = audio_sample_rate / std::gcd(audio_sample_rate, tone_frequency);
+      const uint32_t repetitions = std::max((min_batch_sample_count + period_count * this->channel_count - 1) / (period_count * this->channel_count), 1u);
+
+      tone_periods = period_count * repetitions;
+      tone.resize(static_cast<size_t>(tone_periods) * this->channel_count);
+      for (uint32_t i = 0; i < tone_periods; i++)
+      {
+         const int32_t sample = static_cast<int32_t>(std::lround(tone_level * 2147483647.0 * std::sin(2.0 * M_PI * tone_frequency * (i % period_count) / audio_sample_rate)));
+         std::fill_n(tone.begin() + static_cast<size_t>(i) * this->channel_count, this->channel_count, sample);
+      }
+   }
+}
+
+void AudioSource::render(uint8_t* slot, uint32_t size)
+{
+   const uint32_t period_size = channel_count * pcm24_sample_size;
+   const uint32_t slot_periods = size / period_size;
+
+   if (signal == AudioSignal::silence)
+      memset(slot, 0, static_cast<size_t>(slot_periods) * period_size);
+   else
+   {
+      //Each batch runs from the current position up to the end of the slot, or of the table where the tone loops.
+      for (uint32_t first_period = 0; first_period < slot_periods;)
+      {
+         const uint32_t period_count = std::min(tone_periods - tone_position, slot_periods - first_period);
+         pack_pcm24_be(tone.data() + static_cast<size_t>(tone_position) * channel_count, period_count * channel_count, slot + static_cast<size_t>(first_period) * period_size);
+
+         first_period += period_count;
+         tone_position += period_count;
+         if (tone_position == tone_periods)
+            tone_position = 0;
+      }
+   }
+
+   sample_periods += slot_periods;
+}
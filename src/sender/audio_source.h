@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file audio_source.h
+   @brief This file contains the source of the transmitted ST2110-30 audio, written straight into each slot in 24 bits PCM.
+
+   A tone is held in 32 bits, channels interleaved, in a table holding a whole number of its periods : it loops without
+   discontinuity from one slot to the next, and the samples of a slot are packed straight from the table by the vectorized
+   PCM packer, in batches running up to the end of the table. Nothing is computed per sample while transmitting.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "pcm_packer.h"
+
+constexpr uint32_t audio_sample_rate = 48000; /*! Sampling rate of the audio streams, in Hz */
+constexpr uint32_t max_audio_channel_count = 64; /*! Most channels of an ST2110-30 stream, conformance level C */
+constexpr uint32_t max_audio_packet_payload = 1440; /*! Most bytes of samples in an ST2110-30 packet */
+
+/*!
+   @brief Signals sent on the audio channels.
+*/
+enum class AudioSignal
+{
+   tone, /*! Sine tone at -18 dBFS on every channel */
+   silence /*! Digital silence */
+};
+
+/*!
+   @brief Finds an audio signal from its name, as given on the command line.
+
+   @returns true if the name is a known signal.
+*/
+bool parse_audio_signal(const std::string& name /*!< [in] Name of the signal.*/
+   , AudioSignal& signal /*!< [out] Signal corresponding to the name.*/
+);
+
+/*!
+   @brief This function provides a string representation of the AudioSignal enumeration value.
+
+   @returns the name of the signal, as accepted by parse_audio_signal.
+*/
+std::string to_string(AudioSignal signal /*!< [in] Signal that we want to stringify.*/);
+
+class AudioSource
+{
+public:
+
+   AudioSource(uint32_t channel_count /*!< [in] Number of channels, interleaved in each sample period.*/
+      , AudioSignal signal /*!< [in] Signal sent on every channel.*/
+      , uint32_t tone_frequency = 1000 /*!< [in] Frequency of the tone in Hz, below the Nyquist frequency.*/
+   );
+
+   /*!
+      @brief Writes the next sample periods of the stream into a slot buffer, as many as the slot holds.
+      The signal carries on from the last sample period written in the previous slot.
+   */
+   void render(uint8_t* slot /*!< [out] Slot buffer, receiving the 24 bits PCM.*/
+      , uint32_t size /*!< [in] Size of the slot buffer in bytes.*/
+   );
+
+   uint32_t get_channel_count() const { return channel_count; }
+
+   /*!
+      @returns the number of sample periods written since the source was created.
+   */
+   uint64_t get_sample_periods() const { return sample_periods; }
+
+private:
+
+   uint32_t channel_count;
+   AudioSignal signal;
+   std::vector<int32_t> tone; /*! Whole number of periods of the tone, channels interleaved */
+   uint32_t tone_periods; /*! Sample periods in the tone table */
+   uint32_t tone_position; /*! Next sample period of the tone table to be sent */
+   uint64_t sample_periods;
+};
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "deadline_monitor.h"
+
+#include <algorithm>
+
+DeadlineMonitor::DeadlineMonitor(uint64_t slot_period)
+   : period(slot_period), misses(0), statistics()
+{
+}
+
+void DeadlineMonitor::slot_unlocked()
+{
+   const std::chrono::steady_clock::time_point unlock_time = std::chrono::steady_clock::now();
+   if (period == 0)
+      return;
+
+   const uint64_t busy_time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(unlock_time - lock_time).count());
+   const uint64_t rendering_time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(render_time - lock_time).count());
+
+   statistics.slots++;
+   statistics.total_busy_time += busy_time;
+   statistics.max_busy_time = std::max(statistics.max_busy_time, busy_time);
+   statistics.max_render_time = std::max(statistics.max_render_time, rendering_time);
+
+   if (busy_time > period)
+   {
+      statistics.misses++;
+      statistics.max_overrun = std::max(statistics.max_overrun, busy_time - period);
+      misses.store(statistics.misses, std::memory_order_relaxed);
+      return;
+   }
+
+   //Bucket i holds the slacks of i significant bits in microseconds, the last bucket every larger slack.
+   uint64_t slack = (period - busy_time) / 1000;
+   uint32_t bucket = 0;
+   while (slack != 0 && bucket < slack_bucket_count - 1)
+   {
+      slack >>= 1;
+      bucket++;
+   }
+   statistics.slack_histogram[bucket]++;
+}
+
+DeadlineStatistics DeadlineMonitor::get_statistics() const
+{
+   return statistics;
+}
+
+void DeadlineMonitor::get_bucket_range(uint32_t bucket, uint64_t& min_slack, uint64_t& max_slack)
+{
+   min_slack = (bucket == 0) ? 0 : (1ull << (bucket - 1));
+   max_slack = 1ull << bucket;
+}
+
+void write_deadline_dump(std::ostream& output, const std::vector<std::string>& stream_names, const std::vector<const DeadlineMonitor*>& monitors)
+{
+   output << "{\n  \"streams\": [";
+   bool first_stream = true;
+   for (size_t stream_index = 0; stream_index < monitors.size() && stream_index < stream_names.size(); stream_index++)
+   {
+      const DeadlineMonitor* monitor = monitors[stream_index];
+      if (monitor == nullptr)
+         continue;
+
+      const DeadlineStatistics statistics = monitor->get_statistics();
+      output << (first_stream ? "\n" : ",\n")
+         << "    {\n"
+         << "      \"name\": \"" << stream_names[stream_index] << "\",\n"
+         << "      \"slot_period_ns\": " << monitor->slot_period() << ",\n"
+         << "      \"slots\": " << statistics.slots << ",\n"
+         << "      \"deadline_misses\": " << statistics.misses << ",\n"
+         << "      \"mean_busy_ns\": " << (statistics.slots != 0 ? statistics.total_busy_time / statistics.slots : 0) << ",\n"
+         << "      \"max_busy_ns\": " << statistics.max_busy_time << ",\n"
+         << "      \"max_render_ns\": " << statistics.max_render_time << ",\n"
+         << "      \"max_overrun_ns\": " << statistics.max_overrun << ",\n"
+         << "      \"slack_histogram\": [";
+      for (uint32_t bucket = 0; bucket < slack_bucket_count; bucket++)
+      {
+         uint64_t min_slack = 0, max_slack = 0;
+         DeadlineMonitor::get_bucket_range(bucket, min_slack, max_slack);
+         output << (bucket == 0 ? "\n" : ",\n") << "        { \"min_us\": " << min_slack << ", \"max_us\": " << max_slack << ", \"slots\": " << statistics.slack_histogram[bucket] << " }";
+      }
+      output << "\n      ]\n    }";
+      first_stream = false;
+   }
+   output << "\n  ]\n}\n";
+}
@@ -0,0 +1,123 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file deadline_monitor.h
+   @brief This file contains the monitoring of the time spent on each slot of a TX stream, against the period of the slots.
+
+   The work between the lock and the unlock of a slot must fit in a slot period, or the stream runs out of queued
+   slots and starts to underrun. The monitor timestamps the lock, the end of the rendering and the unlock of every
+   slot with a monotonic clock, and keeps the slack left in the period in a histogram of power of two buckets. A slot
+   taking longer than the period is a deadline miss : misses show up long before the network status reports lost
+   packets, as long as enough slots are queued.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+constexpr uint32_t slack_bucket_count = 24; /*! Buckets of the slack histogram, the last one holding every slack from 2^22 us */
+
+/*!
+   @brief Statistics of the deadlines of a stream.
+*/
+struct DeadlineStatistics
+{
+   uint64_t slots; /*! Number of slots timed */
+   uint64_t misses; /*! Number of slots whose work took longer than the slot period */
+   uint64_t total_busy_time; /*! Sum of the times from lock to unlock, in nanoseconds */
+   uint64_t max_busy_time; /*! Longest time from lock to unlock, in nanoseconds */
+   uint64_t max_render_time; /*! Longest time from lock to the end of the rendering, in nanoseconds */
+   uint64_t max_overrun; /*! Longest time beyond the slot period, in nanoseconds */
+   std::array<uint64_t, slack_bucket_count> slack_histogram; /*! Slots per slack bucket : bucket 0 below 1 us, bucket i from 2^(i-1) to 2^i us */
+};
+
+class DeadlineMonitor
+{
+public:
+
+   DeadlineMonitor(uint64_t slot_period = 0 /*!< [in] Period of the slots in nanoseconds, 0 if it is only known with the first slot.*/
+   );
+
+   DeadlineMonitor(const DeadlineMonitor&) = delete;
+   DeadlineMonitor& operator=(const DeadlineMonitor&) = delete;
+
+   /*!
+      @brief Sets the period of the slots, for the streams whose slots are only known once locked.
+   */
+   void set_slot_period(uint64_t slot_period /*!< [in] Period of the slots in nanoseconds.*/
+   ) { period = slot_period; }
+
+   uint64_t slot_period() const { return period; }
+
+   /*!
+      @brief Timestamps the lock of a slot, when VMIP_LockSlot returns.
+   */
+   void slot_locked() { lock_time = std::chrono::steady_clock::now(); render_time = lock_time; }
+
+   /*!
+      @brief Timestamps the end of the rendering of the locked slot, before it is unlocked.
+   */
+   void slot_rendered() { render_time = std::chrono::steady_clock::now(); }
+
+   /*!
+      @brief Timestamps the unlock of the slot, and accounts for its slack. Slots are not timed until the period is known.
+   */
+   void slot_unlocked();
+
+   /*!
+      @brief Gives the number of deadline misses. Can be read from any thread, for a status line.
+   */
+   const std::atomic<uint64_t>& get_misses() const { return misses; }
+
+   /*!
+      @brief Gives the statistics. Must be called from the thread timing the slots, or once it is stopped.
+   */
+   DeadlineStatistics get_statistics() const;
+
+   /*!
+      @brief Gives the range of slack of a bucket of the histogram, in microseconds.
+   */
+   static void get_bucket_range(uint32_t bucket /*!< [in] Bucket of the histogram.*/
+      , uint64_t& min_slack /*!< [out] Smallest slack of the bucket.*/
+      , uint64_t& max_slack /*!< [out] Slack above the bucket.*/
+   );
+
+private:
+
+   uint64_t period;
+   std::chrono::steady_clock::time_point lock_time;
+   std::chrono::steady_clock::time_point render_time;
+   std::atomic<uint64_t> misses;
+   DeadlineStatistics statistics;
+};
+
+/*!
+   @brief Writes the statistics of the deadlines of several streams as a JSON document.
+*/
+void write_deadline_dump(std::ostream& output /*!< [out] Stream in which the JSON document is written.*/
+   , const std::vector<std::string>& stream_names /*!< [in] Name of each stream.*/
+   , const std::vector<const DeadlineMonitor*>& monitors /*!< [in] Monitor of each stream, nullptr for the streams that are not timed.*/
+);
@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_arena.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+FrameArena::FrameArena() : memory(nullptr), allocated_size(0), huge_pages(false)
+{
+}
+
+FrameArena::~FrameArena()
+{
+   release();
+}
+
+bool FrameArena::allocate(size_t size)
+{
+   release();
+
+   //Rounding to the huge page size is required by MAP_HUGETLB and harmless otherwise.
+   const size_t rounded_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+   if (rounded_size == 0)
+      return false;
+
+#if defined(_WIN32)
+   //Large pages require the SeLockMemoryPrivilege, the regular allocation is the usual case.
+   const size_t large_page_minimum = GetLargePageMinimum();
+   if (large_page_minimum != 0 && rounded_size % large_page_minimum == 0)
+   {
+      memory = static_cast<uint8_t*>(VirtualAlloc(nullptr, rounded_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+      huge_pages = (memory != nullptr);
+   }
+   if (memory == nullptr)
+      memory = static_cast<uint8_t*>(VirtualAlloc(nullptr, rounded_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+#ifdef MAP_HUGETLB
+   void* address = mmap(nullptr, rounded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   huge_pages = (address != MAP_FAILED);
+#else
+   void* address = MAP_FAILED;
+#endif
+   if (address == MAP_FAILED)
+   {
+      address = mmap(nullptr, rounded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+      if (address != MAP_FAILED)
+         madvise(address, rounded_size, MADV_HUGEPAGE);
+#endif
+   }
+   memory = (address != MAP_FAILED) ? static_cast<uint8_t*>(address) : nullptr;
+#endif
+
+   if (memory == nullptr)
+   {
+      huge_pages = false;
+      return false;
+   }
+
+   allocated_size = rounded_size;
+   return true;
+}
+
+void FrameArena::release()
+{
+   if (memory == nullptr)
+      return;
+
+#if defined(_WIN32)
+   VirtualFree(memory, 0, MEM_RELEASE);
+#else
+   munmap(memory, allocated_size);
+#endif
+
+   memory = nullptr;
+   allocated_size = 0;
+   huge_pages = false;
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file frame_arena.h
+   @brief This file contains a single memory arena, backed by huge pages when the system allows it, holding pre-rendered frames.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+
+class FrameArena
+{
+public:
+
+   FrameArena();
+   ~FrameArena();
+
+   FrameArena(const FrameArena&) = delete;
+   FrameArena& operator=(const FrameArena&) = delete;
+
+   /*!
+      @brief Allocates the arena. Explicit huge pages are tried first, then transparent huge pages, then regular pages.
+      Any previous allocation is released.
+
+      @returns true if the arena could be allocated.
+   */
+   bool allocate(size_t size /*!< [in] Size of the arena in bytes.*/);
+
+   /*!
+      @brief Releases the arena.
+   */
+   void release();
+
+   uint8_t* data() const { return memory; }
+   size_t size() const { return allocated_size; }
+
+   /*!
+      @brief Tells if the arena is backed by explicitly reserved huge pages.
+   */
+   bool uses_huge_pages() const { return huge_pages; }
+
+private:
+
+   static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+   uint8_t* memory;
+   size_t allocated_size;
+   bool huge_pages;
+};
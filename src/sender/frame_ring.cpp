@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "frame_ring.h"
+#include "pgroup_packer.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+constexpr uint16_t black_level = 0x40; /*! 10 bits luma black level */
+constexpr uint16_t white_level = 0x3AC; /*! 10 bits luma white level */
+constexpr uint16_t grey_level = 0x1F6; /*! 10 bits luma level halfway between black and white */
+constexpr uint16_t neutral_chroma = 0x200; /*! 10 bits chroma level of a grey pixel */
+constexpr size_t frame_alignment = 4096; /*! Frames start on page boundaries in the arena */
+
+//Triangle wave going from 0 to 1 and back to 0 while position goes from 0 to period, so that the motion loops.
+static double triangle_wave(uint32_t position, uint32_t period)
+{
+   const double phase = static_cast<double>(position % period) / period;
+   return 1.0 - std::fabs(2.0 * phase - 1.0);
+}
+
+bool parse_pattern_type(const std::string& name, PatternType& type)
+{
+   const std::array<PatternType, 5> types = { PatternType::color_bar, PatternType::luma_ramp, PatternType::zone_plate,
+                                              PatternType::moving_box, PatternType::prbs_noise };
+   for (PatternType candidate : types)
+   {
+      if (name == to_string(candidate))
+      {
+         type = candidate;
+         return true;
+      }
+   }
+   return false;
+}
+
+std::string to_string(PatternType type)
+{
+   std::string result = "Undefined";
+
+   switch (type)
+   {
+   case PatternType::color_bar: result = "colorbar"; break;
+   case PatternType::luma_ramp: result = "luma_ramp"; break;
+   case PatternType::zone_plate: result = "zone_plate"; break;
+   case PatternType::moving_box: result = "moving_box"; break;
+   case PatternType::prbs_noise: result = "prbs_noise"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+FrameRing::FrameRing(const PatternEngine& engine) : engine(engine), frame_stride(0), frames(0)
+{
+}
+
+bool FrameRing::render(PatternType type, uint32_t animation_frames, size_t memory_budget, StripeRenderer* renderer)
+{
+   frames = 0;
+
+   if (type == PatternType::color_bar)
+   {
+      std::cout << "The colorbar pattern is not an animated pattern" << std::endl;
+      return false;
+   }
+
+   frame_stride = (engine.frame_size() + frame_alignment - 1) / frame_alignment * frame_alignment;
+   if (frame_stride == 0)
+      return false;
+
+   const uint32_t frames_in_budget = static_cast<uint32_t>(std::min<size_t>(memory_budget / frame_stride, UINT32_MAX));
+   if (frames_in_budget < animation_frames)
+      std::cout << "The animation is reduced to " << frames_in_budget << " frames to fit in the memory budget of " << memory_budget / (1024 * 1024) << " MiB" << std::endl;
+
+   const uint32_t frame_count = std::min(animation_frames, frames_in_budget);
+   if (frame_count == 0)
+   {
+      std::cout << "No frame of the animation fits in the memory budget" << std::endl;
+      return false;
+   }
+
+   if (!arena.allocate(frame_stride * frame_count))
+   {
+      std::cout << "Could not allocate the frame arena (" << frame_stride * frame_count / (1024 * 1024) << " MiB)" << std::endl;
+      return false;
+   }
+
+   //Rendering writes every page of the arena, so that no page fault happens later in the transmission loop.
+   //Stripes only touch their own lines, so that the pages of a frame are spread over the workers.
+   for (uint32_t frame_index = 0; frame_index < frame_count; frame_index++)
+   {
+      uint8_t* frame = arena.data() + frame_index * frame_stride;
+      if (renderer)
+         renderer->run(engine.frame_height(), [&](uint32_t first_line, uint32_t line_count) {
+            render_frame(type, frame_index, frame_count, frame, first_line, line_count);
+         });
+      else
+         render_frame(type, frame_index, frame_count, frame, 0, engine.frame_height());
+   }
+
+   frames = frame_count;
+   return true;
+}
+
+const uint8_t* FrameRing::frame(uint64_t frame_index) const
+{
+   if (frames == 0)
+      return nullptr;
+   return arena.data() + (frame_index % frames) * frame_stride;
+}
+
+void FrameRing::render_frame(PatternType type, uint32_t frame_index, uint32_t animation_frames, uint8_t* frame,
+   uint32_t first_line, uint32_t line_count) const
+{
+   const uint32_t width = engine.frame_width();
+   const uint32_t height = engine.frame_height();
+   const uint32_t pgroup_count = width / ycbcr422_10bit_pgroup_pixels;
+   const uint32_t last_line = std::min(first_line + line_count, height);
+   std::vector<uint16_t> y(width), cb(pgroup_count, neutral_chroma), cr(pgroup_count, neutral_chroma);
+
+   switch (type)
+   {
+   case PatternType::luma_ramp:
+   {
+      //Every line is the same ramp, shifted by a fraction of the width on each frame.
+      const uint32_t shift = static_cast<uint32_t>(static_cast<uint64_t>(frame_index) * width / animation_frames);
+      for (uint32_t x = 0; x < width; x++)
+         y[x] = static_cast<uint16_t>(black_level + (static_cast<uint64_t>((x + shift) % width) * (white_level - black_level)) / std::max(width - 1, 1u));
+      for (uint32_t line = first_line; line < last_line; line++)
+         engine.render_line(frame, line, y.data(), cb.data(), cr.data());
+      break;
+   }
+   case PatternType::zone_plate:
+   {
+      //The phase is expressed in 1/1024 of a turn. The frequency grows with the radius and reaches Nyquist on the frame border.
+      std::array<uint16_t, 1024> cosine;
+      for (uint32_t i = 0; i < cosine.size(); i++)
+         cosine[i] = static_cast<uint16_t>(grey_level + (white_level - grey_level) * std::cos(2.0 * M_PI * i / cosine.size()));
+
+      const int64_t radius = std::max<int64_t>(std::max(width, height) / 2, 1);
+      const uint64_t phase = static_cast<uint64_t>(frame_index) * cosine.size() / animation_frames;
+      for (uint32_t line = first_line; line < last_line; line++)
+      {
+         const int64_t dy = static_cast<int64_t>(line) - height / 2;
+         for (uint32_t x = 0; x < width; x++)
+         {
+            const int64_t dx = static_cast<int64_t>(x) - width / 2;
+            y[x] = cosine[(static_cast<uint64_t>(dx * dx + dy * dy) * 256 / radius + phase) % cosine.size()];
+         }
+         engine.render_line(frame, line, y.data(), cb.data(), cr.data());
+      }
+      break;
+   }
+   case PatternType::moving_box:
+   {
+      //The box goes back and forth horizontally once per animation and vertically twice, starting on a pgroup boundary.
+      const uint32_t box_width = std::max(width / 8, 2u) & ~1u;
+      const uint32_t box_height = std::max(height / 8, 1u);
+      const uint32_t box_x = static_cast<uint32_t>(triangle_wave(frame_index, animation_frames) * (width - box_width)) & ~1u;
+      const uint32_t box_y = static_cast<uint32_t>(triangle_wave(2 * frame_index, animation_frames) * (height - box_height));
+
+      std::vector<uint16_t> box_y_samples(width, grey_level);
+      std::fill(box_y_samples.begin() + box_x, box_y_samples.begin() + box_x + box_width, white_level);
+      std::fill(y.begin(), y.end(), grey_level);
+
+      for (uint32_t line = first_line; line < last_line; line++)
+      {
+         const bool in_box = (line >= box_y && line < box_y + box_height);
+         engine.render_line(frame, line, in_box ? box_y_samples.data() : y.data(), cb.data(), cr.data());
+      }
+      break;
+   }
+   case PatternType::prbs_noise:
+   {
+      for (uint32_t line = first_line; line < last_line; line++)
+      {
+         //xorshift32 sequence seeded by the frame and the line, so that lines can be rendered in any order.
+         uint32_t state = (frame_index + 1) * 0x9E3779B9u ^ (line + 1) * 0x85EBCA6Bu;
+         if (state == 0)
+            state = 1;
+         auto next = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+         };
+
+         //Samples are spread on the 10 bits range excluding the reserved values 0x000-0x003 and 0x3FC-0x3FF.
+         for (uint32_t x = 0; x < width; x++)
+            y[x] = static_cast<uint16_t>(4 + ((static_cast<uint64_t>(next()) * 0x3F8) >> 32));
+         for (uint32_t pgroup = 0; pgroup < pgroup_count; pgroup++)
+         {
+            cb[pgroup] = static_cast<uint16_t>(4 + ((static_cast<uint64_t>(next()) * 0x3F8) >> 32));
+            cr[pgroup] = static_cast<uint16_t>(4 + ((static_cast<uint64_t>(next()) * 0x3F8) >> 32));
+         }
+         engine.render_line(frame, line, y.data(), cb.data(), cr.data());
+      }
+      break;
+   }
+   case PatternType::color_bar:
+   default:
+      break;
+   }
+}
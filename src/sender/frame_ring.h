@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file frame_ring.h
+   @brief This file contains the animated test patterns, pre-rendered in a ring of frames.
+
+   Every frame of the animation is rendered once at startup in a single arena, the motion looping seamlessly
+   over the ring. The transmission loop then only has to pick the next frame and copy it.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+#include <string>
+
+#include "frame_arena.h"
+#include "pattern_engine.h"
+#include "stripe_renderer.h"
+
+/*!
+   @brief Test patterns available in the sender.
+*/
+enum class PatternType
+{
+   color_bar, /*! Static colorbar with a moving white line */
+   luma_ramp, /*! Horizontal luma ramp scrolling from right to left */
+   zone_plate, /*! Circular zone plate with a moving phase */
+   moving_box, /*! White box bouncing over a grey background */
+   prbs_noise /*! Pseudo-random noise, different on every frame */
+};
+
+/*!
+   @brief Finds a pattern from its name, as given on the command line.
+
+   @returns true if the name is a known pattern.
+*/
+bool parse_pattern_type(const std::string& name /*!< [in] Name of the pattern.*/
+   , PatternType& type /*!< [out] Pattern corresponding to the name.*/
+);
+
+/*!
+   @brief This function provides a string representation of the PatternType enumeration value.
+
+   @returns the name of the pattern, as accepted by parse_pattern_type.
+*/
+std::string to_string(PatternType type /*!< [in] Pattern that we want to stringify.*/);
+
+class FrameRing
+{
+public:
+
+   FrameRing(const PatternEngine& engine /*!< [in] Engine giving the layout of the frames. Must outlive the ring.*/);
+
+   /*!
+      @brief Pre-renders the animation of an animated pattern. The number of frames is reduced if the animation does not fit in the memory budget.
+
+      @returns true if at least one frame could be rendered.
+   */
+   bool render(PatternType type /*!< [in] Animated pattern to render, color_bar is not supported.*/
+      , uint32_t animation_frames /*!< [in] Requested length of the animation in frames.*/
+      , size_t memory_budget /*!< [in] Maximum size of the arena holding the frames, in bytes.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, each frame is rendered in stripes by the renderer workers.*/
+   );
+
+   /*!
+      @brief Gives the frame to transmit for a given frame counter. The ring loops at the end of the animation.
+   */
+   const uint8_t* frame(uint64_t frame_index /*!< [in] Frame counter.*/) const;
+
+   uint32_t frame_count() const { return frames; }
+   size_t frame_size() const { return engine.frame_size(); }
+   bool uses_huge_pages() const { return arena.uses_huge_pages(); }
+
+   /*!
+      @brief Renders one frame of an animation. The motion of frame frame_index loops over animation_frames frames.
+   */
+   void render_frame(PatternType type /*!< [in] Animated pattern to render.*/
+      , uint32_t frame_index /*!< [in] Position of the frame in the animation.*/
+      , uint32_t animation_frames /*!< [in] Length of the animation in frames.*/
+      , uint8_t* frame /*!< [out] Frame buffer of engine.frame_size() bytes.*/
+      , uint32_t first_line /*!< [in] First picture line to render.*/
+      , uint32_t line_count /*!< [in] Number of picture lines to render.*/
+   ) const;
+
+private:
+
+   const PatternEngine& engine;
+   FrameArena arena;
+   size_t frame_stride;
+   uint32_t frames;
+};
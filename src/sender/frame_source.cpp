@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_source.h"
+#include "pattern.h"
+#include "../frame_copy.h"
+
+#include <algorithm>
+
+ColorBarSource::ColorBarSource(PatternEngine& engine, bool delta_update, StripeRenderer* renderer)
+   : engine(engine), white_line_row(engine.add_row_template(white_line_color)), tracker(engine, color_bar_rows(engine), delta_update, renderer)
+{
+}
+
+std::vector<uint32_t> ColorBarSource::color_bar_rows(PatternEngine& engine)
+{
+   return std::vector<uint32_t>(engine.frame_height(), add_color_bar_row_template(engine));
+}
+
+void ColorBarSource::render(uint64_t frame_index, uint8_t* frame, uint32_t size)
+{
+   //Bring the frame back to the colorbar, then draw the moving line over it.
+   const uint32_t line = static_cast<uint32_t>(frame_index % engine.frame_height());
+   tracker.restore(frame, size);
+
+   if (size >= engine.frame_size())
+   {
+      engine.render_line(frame, line, white_line_row);
+      tracker.mark_dirty(frame, line);
+   }
+}
+
+AnimatedPatternSource::AnimatedPatternSource(const PatternEngine& engine, PatternType type, uint32_t animation_frames, StripeRenderer* renderer)
+   : engine(engine), pattern(engine), type(type), animation_frames(std::max(animation_frames, 1u)), renderer(renderer)
+{
+}
+
+void AnimatedPatternSource::render(uint64_t frame_index, uint8_t* frame, uint32_t size)
+{
+   if (size < engine.frame_size())
+      return;
+
+   const uint32_t animation_frame = static_cast<uint32_t>(frame_index % animation_frames);
+   if (renderer)
+      renderer->run(engine.frame_height(), [&](uint32_t first_line, uint32_t line_count) {
+         pattern.render_frame(type, animation_frame, animation_frames, frame, first_line, line_count);
+      });
+   else
+      pattern.render_frame(type, animation_frame, animation_frames, frame, 0, engine.frame_height());
+}
+
+StoredFrameSource::StoredFrameSource(const FrameFunction& stored_frame, size_t frame_size, StripeRenderer* renderer)
+   : stored_frame(stored_frame), frame_size(frame_size), renderer(renderer)
+{
+}
+
+void StoredFrameSource::render(uint64_t frame_index, uint8_t* frame, uint32_t size)
+{
+   const uint8_t* source = stored_frame(frame_index);
+   if (source == nullptr)
+      return;
+
+   if (renderer)
+      renderer->copy(frame, source, std::min<size_t>(size, frame_size));
+   else
+      copy_frame(frame, source, std::min<size_t>(size, frame_size));
+}
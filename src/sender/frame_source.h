@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file frame_source.h
+   @brief This file contains the sources of the transmitted frames, writing each frame straight into the buffer it is sent from.
+
+   A source writes a frame directly into the locked slot, or into a frame of the render-ahead ring : generated content
+   goes through memory once, with no intermediate frame to copy from. The colorbar is rewritten from its row templates
+   and the animated patterns can be rendered line by line in the slot. Pre-rendered animations and video files are
+   copied from the frames they hold.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "frame_ring.h"
+#include "pattern_engine.h"
+#include "slot_tracker.h"
+#include "stripe_renderer.h"
+
+class FrameSource
+{
+public:
+
+   virtual ~FrameSource() = default;
+
+   /*!
+      @brief Writes a frame of the stream into a frame buffer.
+   */
+   virtual void render(uint64_t frame_index /*!< [in] Frame counter.*/
+      , uint8_t* frame /*!< [out] Slot buffer, or frame of the render-ahead ring.*/
+      , uint32_t size /*!< [in] Size of the frame buffer in bytes.*/
+   ) = 0;
+
+   /*!
+      @brief Gives the tracker of the lines drawn over the frames, for the sources that only rewrite the lines that changed.
+      Whatever is drawn over a frame after render must be marked dirty in it.
+
+      @returns nullptr if the source rewrites the whole frame every time.
+   */
+   virtual SlotTracker* slot_tracker() { return nullptr; }
+};
+
+/*!
+   @brief Static colorbar with a white line moving down by one line per frame.
+*/
+class ColorBarSource : public FrameSource
+{
+public:
+
+   ColorBarSource(PatternEngine& engine /*!< [in] Engine in which the rows are packed. Must outlive the source.*/
+      , bool delta_update /*!< [in] Only rewrite the lines that changed since a frame buffer was last used.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, whole frames are written in stripes by the renderer workers.*/
+   );
+
+   void render(uint64_t frame_index, uint8_t* frame, uint32_t size) override;
+   SlotTracker* slot_tracker() override { return &tracker; }
+
+private:
+
+   static std::vector<uint32_t> color_bar_rows(PatternEngine& engine);
+
+   const PatternEngine& engine;
+   uint32_t white_line_row;
+   SlotTracker tracker;
+};
+
+/*!
+   @brief Animated pattern rendered line by line straight into each frame buffer, with no pre-rendered frames.
+*/
+class AnimatedPatternSource : public FrameSource
+{
+public:
+
+   AnimatedPatternSource(const PatternEngine& engine /*!< [in] Engine giving the layout of the frames. Must outlive the source.*/
+      , PatternType type /*!< [in] Animated pattern, color_bar is not supported.*/
+      , uint32_t animation_frames /*!< [in] Length of the animation in frames, the motion looping over them.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, each frame is rendered in stripes by the renderer workers.*/
+   );
+
+   void render(uint64_t frame_index, uint8_t* frame, uint32_t size) override;
+
+private:
+
+   const PatternEngine& engine;
+   FrameRing pattern; /*! Used for its line renderer only, no frame is pre-rendered */
+   PatternType type;
+   uint32_t animation_frames;
+   StripeRenderer* renderer;
+};
+
+/*!
+   @brief Frames held in memory, pre-rendered animation or video file, copied into each frame buffer.
+*/
+class StoredFrameSource : public FrameSource
+{
+public:
+
+   /*!
+      @brief Function giving the stored frame of a frame counter.
+   */
+   typedef std::function<const uint8_t*(uint64_t frame_index)> FrameFunction;
+
+   StoredFrameSource(const FrameFunction& stored_frame /*!< [in] Function giving the frame to copy.*/
+      , size_t frame_size /*!< [in] Size of the stored frames in bytes.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, each copy is split over the renderer workers.*/
+   );
+
+   void render(uint64_t frame_index, uint8_t* frame, uint32_t size) override;
+
+private:
+
+   FrameFunction stored_frame;
+   size_t frame_size;
+   StripeRenderer* renderer;
+};
@@ -14,11 +14,13 @@
  */
 
 #include "pattern.h"
+#include "pattern_engine.h"
+#include "pgroup_packer.h"
 
-#include <iostream>
+#include <algorithm>
 #include <vector>
 
-void create_color_bar_pattern(uint8_t* user_buffer, uint32_t frame_height, uint32_t frame_width)
+uint32_t add_color_bar_row_template(PatternEngine& engine)
 {
    const Yuv10Bit white = {0x2D0,0x200,0x200};
    const Yuv10Bit yellow = {0x2A0,0xB0,0x220};
@@ -28,68 +30,23 @@ void create_color_bar_pattern(uint8_t* user_buffer, uint32_t frame_height, uint3
    const Yuv10Bit red = {0xcc,0x184,0x350};
    const Yuv10Bit blue = {0x70,0x350,0x1e0};
    const Yuv10Bit black = {0x40,0x200,0x200};
-   std::vector<Yuv10Bit> color_list = {white,yellow,cyan,green,magenta,red,blue,black};
+   const std::vector<Yuv10Bit> color_list = {white,yellow,cyan,green,magenta,red,blue,black};
 
-   uint32_t color_id=0;
-   int j=0;
-   
-   if (user_buffer == nullptr)
-   {
-      std::cout << std::endl << "The  user_buffer pointer is invalid" << std::endl;
-      return;
-   }
-
-   for(uint32_t pixel_y = 0; pixel_y < frame_height; pixel_y++)
-   {
-      for (uint32_t pixel_x = 0; pixel_x < frame_width; pixel_x+=8)
-      {
-         color_id = pixel_x/(frame_width/static_cast<uint32_t>(color_list.size()));
-         for(int i=0; i<4; i++)
-         {
-            user_buffer[(j*20)+(i*5)+0] = (color_list[color_id].u >> 2);
-            user_buffer[(j*20)+(i*5)+1] = ((color_list[color_id].u & 0x3)<<6) + ((color_list[color_id].y & 0x3f0)>>4);
-            user_buffer[(j*20)+(i*5)+2] = ((color_list[color_id].v & 0x3c0)>>6) + ((color_list[color_id].y & 0xf)<<4);
-            user_buffer[(j*20)+(i*5)+3] = ((color_list[color_id].v & 0xcf)<<2) + ((color_list[color_id].y & 0x300)>>8);
-            user_buffer[(j*20)+(i*5)+4] = (color_list[color_id].y & 0xff);
-         }
-         j++;
-      }
-   }
-}
-
-void draw_white_line(uint8_t* buffer, uint32_t line, uint32_t frame_height, uint32_t frame_width,
-   bool interlaced)
-{
-   uint8_t* temp;
-   int j=0;
-   const Yuv10Bit white = {0x3AC,0x200,0x200};
-
-   if (buffer == nullptr)
-   {
-      std::cout << std::endl << "The  buffer pointer is invalid" << std::endl;
-      return;
-   }
+   //Colors change on 8 pixels boundaries, each bar being frame_width / 8 pixels wide.
+   const uint32_t frame_width = engine.frame_width();
+   const uint32_t pgroup_count = frame_width / ycbcr422_10bit_pgroup_pixels;
+   const uint32_t bar_width = std::max(frame_width / static_cast<uint32_t>(color_list.size()), 1u);
+   std::vector<uint16_t> y(frame_width), cb(pgroup_count), cr(pgroup_count);
 
-   if (interlaced)
+   for (uint32_t pgroup = 0; pgroup < pgroup_count; pgroup++)
    {
-      if (line % 2 == 0)
-         temp = (buffer + (line / 2) * frame_width * PIXELSIZE_10BIT);
-      else
-         temp = (buffer + (((frame_height + 1) / 2) + (line / 2)) * frame_width * PIXELSIZE_10BIT);
+      const uint32_t pixel_x = pgroup * ycbcr422_10bit_pgroup_pixels;
+      const uint32_t color_id = std::min<uint32_t>((pixel_x & ~7u) / bar_width, static_cast<uint32_t>(color_list.size()) - 1);
+      y[pixel_x] = color_list[color_id].y;
+      y[pixel_x + 1] = color_list[color_id].y;
+      cb[pgroup] = color_list[color_id].u;
+      cr[pgroup] = color_list[color_id].v;
    }
-   else
-      temp = (buffer + line * frame_width * PIXELSIZE_10BIT);
 
-   for (uint32_t pixel_x = 0; pixel_x < frame_width; pixel_x+=8)
-   {
-      for(int i=0; i<4; i++)
-      {
-         temp[(j*20)+(i*5)+0] = (white.u >> 2);
-         temp[(j*20)+(i*5)+1] = ((white.u & 0x3)<<6) + ((white.y & 0x3f0)>>4);
-         temp[(j*20)+(i*5)+2] = ((white.v & 0x3c0)>>6) + ((white.y & 0xf)<<4);
-         temp[(j*20)+(i*5)+3] = ((white.v & 0xcf)<<2) + ((white.y & 0x300)>>8);
-         temp[(j*20)+(i*5)+4] = (white.y & 0xff);
-      }
-      j++;
-   }
-}
\ No newline at end of file
+   return engine.add_row_template(y.data(), cb.data(), cr.data());
+}
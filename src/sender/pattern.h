@@ -25,8 +25,6 @@
 #include <stdint.h>
 #endif
 
-#define PIXELSIZE_10BIT 5/2
-
 /*!
    @brief Structure representing yuv color object.
 */
@@ -38,19 +36,14 @@ struct Yuv10Bit
    uint16_t v;
 };
 
+constexpr Yuv10Bit white_line_color = {0x3AC,0x200,0x200}; /*! Color of the moving line drawn over the colorbar */
+
+class PatternEngine;
+
 /*!
-   @brief Creates a colorbar pattern that supports only yuv 4:2:2 10bits specific ST2110 format.
-*/
-void create_color_bar_pattern(uint8_t* user_buffer /*!< [in] pointer to the user-instantiated buffer that will be filled.*/
-   , uint32_t frame_height /*!< [in] Frame height. */
-   , uint32_t frame_width /*!< [in] Frame width.*/
-);
-/*!
-   @brief Draw an horizontal white line in a buffer. Only available for a yuv 4:2:2 10bits specific ST2110 buffer.
+   @brief Adds the row template of the colorbar pattern to a pattern engine. Every line of the colorbar pattern uses this row.
+
+   @returns The id of the row template.
 */
-void draw_white_line(uint8_t* buffer /*!< [in] Buffer in which the white line will be drawn*/
-   , uint32_t line /*!< [in] line position (in pixel)*/
-   , uint32_t frame_height /*!< [in] Frame height */
-   , uint32_t frame_width /*!< [in] Frame width*/
-   , bool interlaced /*!< [in] Is the frame interlaced or not.*/
-);
\ No newline at end of file
+uint32_t add_color_bar_row_template(PatternEngine& engine /*!< [in] Engine in which the row template is packed.*/);
+
@@ -0,0 +1,178 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pattern_engine.h"
+#include "pgroup_packer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+PatternEngine::PatternEngine(uint32_t frame_width, uint32_t frame_height, bool interlaced, VMIP_VIDEO_SAMPLING sampling, VMIP_VIDEO_DEPTH depth)
+   : width(frame_width), height(frame_height), interlaced(interlaced), pack_line(get_pattern_line_packer(sampling, depth)),
+     pgroup_pixel_count(1), pgroup_bytes(0), pgroups_per_line(0), line_bytes(0)
+{
+   if (pack_line == nullptr || !get_pgroup_layout(sampling, depth, &pgroup_pixel_count, &pgroup_bytes))
+   {
+      pack_line = nullptr;
+      pgroup_pixel_count = 1;
+      pgroup_bytes = 0;
+      std::cout << std::endl << "The pattern engine does not support this sampling and depth" << std::endl;
+      return;
+   }
+
+   pgroups_per_line = frame_width / pgroup_pixel_count;
+   line_bytes = pgroups_per_line * pgroup_bytes;
+}
+
+uint32_t PatternEngine::add_row_template(const uint16_t* y, const uint16_t* cb, const uint16_t* cr)
+{
+   std::vector<uint8_t> row(line_bytes);
+   if (pack_line)
+      pack_line(y, cb, cr, pgroups_per_line, row.data());
+   row_templates.push_back(std::move(row));
+   return static_cast<uint32_t>(row_templates.size() - 1);
+}
+
+uint32_t PatternEngine::add_row_template(const Yuv10Bit& color)
+{
+   const std::vector<uint16_t> y(width, color.y);
+   const std::vector<uint16_t> cb(width / ycbcr422_10bit_pgroup_pixels, color.u);
+   const std::vector<uint16_t> cr(width / ycbcr422_10bit_pgroup_pixels, color.v);
+   return add_row_template(y.data(), cb.data(), cr.data());
+}
+
+const uint8_t* PatternEngine::row_template(uint32_t row_id) const
+{
+   return row_templates.at(row_id).data();
+}
+
+uint32_t PatternEngine::line_offset(uint32_t line) const
+{
+   if (interlaced)
+   {
+      if (line % 2 == 0)
+         return (line / 2) * line_bytes;
+      else
+         return (((height + 1) / 2) + (line / 2)) * line_bytes;
+   }
+   return line * line_bytes;
+}
+
+uint32_t PatternEngine::picture_line(uint32_t buffer_line) const
+{
+   if (interlaced)
+   {
+      const uint32_t first_field_lines = (height + 1) / 2;
+      if (buffer_line < first_field_lines)
+         return buffer_line * 2;
+      else
+         return (buffer_line - first_field_lines) * 2 + 1;
+   }
+   return buffer_line;
+}
+
+void PatternEngine::replicate_lines(uint8_t* buffer, uint32_t first_buffer_line, uint32_t line_count) const
+{
+   uint8_t* block = buffer + static_cast<size_t>(first_buffer_line) * line_bytes;
+   uint32_t copied_lines = 1;
+
+   while (copied_lines < line_count)
+   {
+      const uint32_t lines = std::min(copied_lines, line_count - copied_lines);
+      std::memcpy(block + static_cast<size_t>(copied_lines) * line_bytes, block, static_cast<size_t>(lines) * line_bytes);
+      copied_lines += lines;
+   }
+}
+
+void PatternEngine::render_frame(uint8_t* buffer, uint32_t row_id) const
+{
+   if (buffer == nullptr)
+   {
+      std::cout << std::endl << "The  buffer pointer is invalid" << std::endl;
+      return;
+   }
+
+   if (height == 0)
+      return;
+
+   //Every line is the same, the field-sequential layout does not matter here.
+   std::memcpy(buffer, row_template(row_id), line_bytes);
+   replicate_lines(buffer, 0, height);
+}
+
+void PatternEngine::render_frame(uint8_t* buffer, const std::vector<uint32_t>& row_ids) const
+{
+   if (buffer == nullptr)
+   {
+      std::cout << std::endl << "The  buffer pointer is invalid" << std::endl;
+      return;
+   }
+
+   if (row_ids.size() != height)
+   {
+      std::cout << std::endl << "The number of row ids (" << row_ids.size() << ") does not match the frame height (" << height << ")" << std::endl;
+      return;
+   }
+
+   //Lines are walked in buffer order, so that each run of identical rows is a contiguous block of the buffer.
+   uint32_t run_start = 0;
+   while (run_start < height)
+   {
+      const uint32_t row_id = row_ids[picture_line(run_start)];
+      uint32_t run_end = run_start + 1;
+      while (run_end < height && row_ids[picture_line(run_end)] == row_id)
+         run_end++;
+
+      std::memcpy(buffer + static_cast<size_t>(run_start) * line_bytes, row_template(row_id), line_bytes);
+      replicate_lines(buffer, run_start, run_end - run_start);
+      run_start = run_end;
+   }
+}
+
+void PatternEngine::render_line(uint8_t* buffer, uint32_t line, uint32_t row_id) const
+{
+   if (buffer == nullptr)
+   {
+      std::cout << std::endl << "The  buffer pointer is invalid" << std::endl;
+      return;
+   }
+
+   std::memcpy(buffer + line_offset(line), row_template(row_id), line_bytes);
+}
+
+void PatternEngine::render_line(uint8_t* buffer, uint32_t line, const uint16_t* y, const uint16_t* cb, const uint16_t* cr) const
+{
+   if (buffer == nullptr)
+   {
+      std::cout << std::endl << "The  buffer pointer is invalid" << std::endl;
+      return;
+   }
+
+   if (pack_line)
+      pack_line(y, cb, cr, pgroups_per_line, buffer + line_offset(line));
+}
+
+void PatternEngine::pack_samples(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t pixel_count, uint8_t* pgroups) const
+{
+   if (pgroups == nullptr)
+   {
+      std::cout << std::endl << "The  pgroups pointer is invalid" << std::endl;
+      return;
+   }
+
+   if (pack_line)
+      pack_line(y, cb, cr, pixel_count / pgroup_pixel_count, pgroups);
+}
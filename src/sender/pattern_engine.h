@@ -0,0 +1,150 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file pattern_engine.h
+   @brief This file contains the row-template engine used to render static test patterns.
+
+   A pattern is described by a small set of row templates, each one packed once in the ST2110 format of the stream.
+   Frames are then built by replicating those rows with large memcpys, following the field-sequential
+   layout of the buffers for interlaced standards.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <vector>
+
+#include "pattern.h"
+#include "pattern_packer.h"
+
+class PatternEngine
+{
+public:
+
+   PatternEngine(uint32_t frame_width /*!< [in] Frame width.*/
+      , uint32_t frame_height /*!< [in] Frame height.*/
+      , bool interlaced /*!< [in] Is the frame interlaced or not.*/
+      , VMIP_VIDEO_SAMPLING sampling = VMIP_VIDEO_SAMPLING_YCBCR_422 /*!< [in] Sampling of the stream.*/
+      , VMIP_VIDEO_DEPTH depth = VMIP_VIDEO_DEPTH_10BIT /*!< [in] Depth of the stream.*/
+   );
+
+   /*!
+      @brief Tells if the sampling and the depth given at construction are supported. Nothing is rendered otherwise.
+   */
+   bool is_format_supported() const { return pack_line != nullptr; }
+
+   /*!
+      @brief Packs a row template from yuv 4:2:2 10bits sample runs, converted to the format of the stream.
+
+      @returns The id of the row template.
+   */
+   uint32_t add_row_template(const uint16_t* y /*!< [in] frame_width luma samples.*/
+      , const uint16_t* cb /*!< [in] frame_width / 2 blue chroma samples.*/
+      , const uint16_t* cr /*!< [in] frame_width / 2 red chroma samples.*/
+   );
+
+   /*!
+      @brief Packs a row template of a single color.
+
+      @returns The id of the row template.
+   */
+   uint32_t add_row_template(const Yuv10Bit& color /*!< [in] Color of the whole row.*/);
+
+   /*!
+      @brief Gives access to a packed row template.
+   */
+   const uint8_t* row_template(uint32_t row_id /*!< [in] Id of the row template.*/) const;
+
+   /*!
+      @brief Gives the byte offset of a picture line in the buffer. For interlaced standards, the buffer holds the
+      first field (even lines) followed by the second field (odd lines).
+   */
+   uint32_t line_offset(uint32_t line /*!< [in] Line of the picture, from the top.*/) const;
+
+   /*!
+      @brief Gives the picture line stored at a given position of the buffer. This is the inverse of line_offset.
+   */
+   uint32_t picture_line(uint32_t buffer_line /*!< [in] Line index in buffer order.*/) const;
+
+   /*!
+      @brief Fills a whole frame with the same row template.
+   */
+   void render_frame(uint8_t* buffer /*!< [out] Frame buffer of frame_size() bytes.*/
+      , uint32_t row_id /*!< [in] Id of the row template used for every line.*/
+   ) const;
+
+   /*!
+      @brief Fills a whole frame, the row template of each picture line being given by row_ids.
+   */
+   void render_frame(uint8_t* buffer /*!< [out] Frame buffer of frame_size() bytes.*/
+      , const std::vector<uint32_t>& row_ids /*!< [in] Id of the row template of each picture line, frame_height entries.*/
+   ) const;
+
+   /*!
+      @brief Writes a row template on one picture line of a frame.
+   */
+   void render_line(uint8_t* buffer /*!< [out] Frame buffer of frame_size() bytes.*/
+      , uint32_t line /*!< [in] Line of the picture, from the top.*/
+      , uint32_t row_id /*!< [in] Id of the row template.*/
+   ) const;
+
+   /*!
+      @brief Packs yuv 4:2:2 10bits sample runs directly on one picture line of a frame, converted to the format of the stream.
+   */
+   void render_line(uint8_t* buffer /*!< [out] Frame buffer of frame_size() bytes.*/
+      , uint32_t line /*!< [in] Line of the picture, from the top.*/
+      , const uint16_t* y /*!< [in] frame_width luma samples.*/
+      , const uint16_t* cb /*!< [in] frame_width / 2 blue chroma samples.*/
+      , const uint16_t* cr /*!< [in] frame_width / 2 red chroma samples.*/
+   ) const;
+
+   /*!
+      @brief Packs yuv 4:2:2 10bits samples into the format of the stream, out of any frame. Used to pre-pack blocks smaller than a line.
+   */
+   void pack_samples(const uint16_t* y /*!< [in] pixel_count luma samples.*/
+      , const uint16_t* cb /*!< [in] pixel_count / 2 blue chroma samples.*/
+      , const uint16_t* cr /*!< [in] pixel_count / 2 red chroma samples.*/
+      , uint32_t pixel_count /*!< [in] Number of pixels to pack, a multiple of pgroup_pixels().*/
+      , uint8_t* pgroups /*!< [out] pixel_count / pgroup_pixels() pgroups.*/
+   ) const;
+
+   uint32_t frame_width() const { return width; }
+   uint32_t frame_height() const { return height; }
+   bool is_interlaced() const { return interlaced; }
+   uint32_t line_size() const { return line_bytes; }
+   uint32_t frame_size() const { return line_bytes * height; }
+   uint32_t pgroup_pixels() const { return pgroup_pixel_count; }
+   uint32_t pgroup_size() const { return pgroup_bytes; }
+
+private:
+
+   uint32_t width;
+   uint32_t height;
+   bool interlaced;
+   PatternLinePacker pack_line;
+   uint32_t pgroup_pixel_count;
+   uint32_t pgroup_bytes;
+   uint32_t pgroups_per_line;
+   uint32_t line_bytes;
+   std::vector<std::vector<uint8_t>> row_templates;
+
+   //Replicates the first line of [first_buffer_line, first_buffer_line + line_count) on the whole range, doubling the copied block at each step.
+   void replicate_lines(uint8_t* buffer, uint32_t first_buffer_line, uint32_t line_count) const;
+};
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pattern_packer.h"
+#include "pgroup_packer.h"
+
+#include <algorithm>
+
+//BT.709 narrow range yuv to narrow range RGB, as 14 bits fixed point coefficients on 10 bits samples.
+constexpr int32_t rgb_r_cr = 25226; /*! 1.5748 * 876 / 896 */
+constexpr int32_t rgb_g_cb = 3000; /*! 0.1873 * 876 / 896 */
+constexpr int32_t rgb_g_cr = 7498; /*! 0.4681 * 876 / 896 */
+constexpr int32_t rgb_b_cb = 29724; /*! 1.8556 * 876 / 896 */
+
+//Brings a 10 bits sample to the depth of the stream.
+template <uint32_t depth>
+static inline uint32_t scale_sample(uint32_t sample)
+{
+   return (depth >= 10) ? (sample << (depth - 10)) : (sample >> (10 - depth));
+}
+
+//Keeps a 10 bits sample out of the values reserved for timing references.
+static inline uint32_t clamp_sample(int32_t sample)
+{
+   return static_cast<uint32_t>(std::min(std::max(sample, 4), 1019));
+}
+
+//Fills the samples of one pgroup in network order, at the depth of the stream.
+template <VMIP_VIDEO_SAMPLING sampling, uint32_t depth>
+static inline void get_pgroup_samples(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t first_pixel,
+   uint32_t (&samples)[PgroupLayout<sampling, depth>::samples])
+{
+   typedef PgroupLayout<sampling, depth> Layout;
+
+   if constexpr (sampling == VMIP_VIDEO_SAMPLING_YCBCR_422)
+   {
+      //Cb, Y0, Cr, Y1 for each pair of pixels.
+      for (uint32_t pair = 0; pair < Layout::pixels / 2; pair++)
+      {
+         const uint32_t pixel = first_pixel + 2 * pair;
+         samples[4 * pair] = scale_sample<depth>(cb[pixel / 2]);
+         samples[4 * pair + 1] = scale_sample<depth>(y[pixel]);
+         samples[4 * pair + 2] = scale_sample<depth>(cr[pixel / 2]);
+         samples[4 * pair + 3] = scale_sample<depth>(y[pixel + 1]);
+      }
+   }
+   else if constexpr (sampling == VMIP_VIDEO_SAMPLING_YCBCR_444)
+   {
+      //Cb, Y, Cr for each pixel, the chroma being shared by the two pixels of a 4:2:2 pair.
+      for (uint32_t i = 0; i < Layout::pixels; i++)
+      {
+         const uint32_t pixel = first_pixel + i;
+         samples[3 * i] = scale_sample<depth>(cb[pixel / 2]);
+         samples[3 * i + 1] = scale_sample<depth>(y[pixel]);
+         samples[3 * i + 2] = scale_sample<depth>(cr[pixel / 2]);
+      }
+   }
+   else
+   {
+      //R, G, B for each pixel.
+      for (uint32_t i = 0; i < Layout::pixels; i++)
+      {
+         const uint32_t pixel = first_pixel + i;
+         const int32_t luma = static_cast<int32_t>(y[pixel]) << 14;
+         const int32_t blue_difference = static_cast<int32_t>(cb[pixel / 2]) - 512;
+         const int32_t red_difference = static_cast<int32_t>(cr[pixel / 2]) - 512;
+
+         samples[3 * i] = scale_sample<depth>(clamp_sample((luma + red_difference * rgb_r_cr + 8192) >> 14));
+         samples[3 * i + 1] = scale_sample<depth>(clamp_sample((luma - blue_difference * rgb_g_cb - red_difference * rgb_g_cr + 8192) >> 14));
+         samples[3 * i + 2] = scale_sample<depth>(clamp_sample((luma + blue_difference * rgb_b_cb + 8192) >> 14));
+      }
+   }
+}
+
+template <VMIP_VIDEO_SAMPLING sampling, uint32_t depth>
+static void pack_pattern_line(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   typedef PgroupLayout<sampling, depth> Layout;
+
+   for (uint32_t pgroup = 0; pgroup < pgroup_count; pgroup++)
+   {
+      uint32_t samples[Layout::samples];
+      get_pgroup_samples<sampling, depth>(y, cb, cr, pgroup * Layout::pixels, samples);
+
+      //Samples are written MSB first. The bit count is a constant, the loops are unrolled by the compiler.
+      uint64_t bits = 0;
+      uint32_t pending_bits = 0;
+      uint8_t* destination = pgroups + pgroup * Layout::size;
+      for (uint32_t sample : samples)
+      {
+         bits = (bits << depth) | (sample & ((1u << depth) - 1));
+         pending_bits += depth;
+         while (pending_bits >= 8)
+         {
+            pending_bits -= 8;
+            *destination++ = static_cast<uint8_t>(bits >> pending_bits);
+         }
+      }
+   }
+}
+
+//The yuv 4:2:2 10bits pgroups are the native format of the patterns, they are written by the vectorized packer.
+template <>
+void pack_pattern_line<VMIP_VIDEO_SAMPLING_YCBCR_422, 10>(const uint16_t* y, const uint16_t* cb, const uint16_t* cr, uint32_t pgroup_count, uint8_t* pgroups)
+{
+   pack_ycbcr422_10bit_pgroups(y, cb, cr, pgroup_count, pgroups);
+}
+
+template <VMIP_VIDEO_SAMPLING sampling>
+static PatternLinePacker get_pattern_line_packer(VMIP_VIDEO_DEPTH depth)
+{
+   switch (depth)
+   {
+   case VMIP_VIDEO_DEPTH_8BIT: return pack_pattern_line<sampling, 8>;
+   case VMIP_VIDEO_DEPTH_10BIT: return pack_pattern_line<sampling, 10>;
+   case VMIP_VIDEO_DEPTH_12BIT: return pack_pattern_line<sampling, 12>;
+   default: return nullptr;
+   }
+}
+
+PatternLinePacker get_pattern_line_packer(VMIP_VIDEO_SAMPLING sampling, VMIP_VIDEO_DEPTH depth)
+{
+   switch (sampling)
+   {
+   case VMIP_VIDEO_SAMPLING_YCBCR_422: return get_pattern_line_packer<VMIP_VIDEO_SAMPLING_YCBCR_422>(depth);
+   case VMIP_VIDEO_SAMPLING_YCBCR_444: return get_pattern_line_packer<VMIP_VIDEO_SAMPLING_YCBCR_444>(depth);
+   case VMIP_VIDEO_SAMPLING_RGB_444: return get_pattern_line_packer<VMIP_VIDEO_SAMPLING_RGB_444>(depth);
+   default: return nullptr;
+   }
+}
+
+template <VMIP_VIDEO_SAMPLING sampling>
+static bool get_pgroup_layout(uint32_t depth_bits, uint32_t* pgroup_pixels, uint32_t* pgroup_size)
+{
+   switch (depth_bits)
+   {
+   case 8: *pgroup_pixels = PgroupLayout<sampling, 8>::pixels; *pgroup_size = PgroupLayout<sampling, 8>::size; return true;
+   case 10: *pgroup_pixels = PgroupLayout<sampling, 10>::pixels; *pgroup_size = PgroupLayout<sampling, 10>::size; return true;
+   case 12: *pgroup_pixels = PgroupLayout<sampling, 12>::pixels; *pgroup_size = PgroupLayout<sampling, 12>::size; return true;
+   default: return false;
+   }
+}
+
+bool get_pgroup_layout(VMIP_VIDEO_SAMPLING sampling, VMIP_VIDEO_DEPTH depth, uint32_t* pgroup_pixels, uint32_t* pgroup_size)
+{
+   if (pgroup_pixels == nullptr || pgroup_size == nullptr)
+      return false;
+
+   switch (sampling)
+   {
+   case VMIP_VIDEO_SAMPLING_YCBCR_422: return get_pgroup_layout<VMIP_VIDEO_SAMPLING_YCBCR_422>(video_depth_bits(depth), pgroup_pixels, pgroup_size);
+   case VMIP_VIDEO_SAMPLING_YCBCR_444: return get_pgroup_layout<VMIP_VIDEO_SAMPLING_YCBCR_444>(video_depth_bits(depth), pgroup_pixels, pgroup_size);
+   case VMIP_VIDEO_SAMPLING_RGB_444: return get_pgroup_layout<VMIP_VIDEO_SAMPLING_RGB_444>(video_depth_bits(depth), pgroup_pixels, pgroup_size);
+   default: return false;
+   }
+}
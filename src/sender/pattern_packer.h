@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file pattern_packer.h
+   @brief This file contains the packers writing the test patterns in every ST2110-20 sampling and depth supported by the sender.
+
+   Patterns are generated as yuv 4:2:2 10bits samples. A line packer converts them to the sampling and the depth of the stream
+   while packing the pgroups. Each packer is a specialization for one sampling and one depth, so that the pgroup layout
+   is known at compile time in the inner loop.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <videomasterip/videomasterip_stream.h>
+
+/*!
+   @brief Gives the number of bits of a sample for a video depth.
+
+   @returns The number of bits, or 0 if the depth is not supported by the sender.
+*/
+constexpr uint32_t video_depth_bits(VMIP_VIDEO_DEPTH depth)
+{
+   return depth == VMIP_VIDEO_DEPTH_8BIT ? 8 : depth == VMIP_VIDEO_DEPTH_10BIT ? 10 : depth == VMIP_VIDEO_DEPTH_12BIT ? 12 : 0;
+}
+
+/*!
+   @brief Layout of a pgroup, as defined by ST2110-20 : the smallest number of pixels whose samples end on a byte boundary.
+*/
+template <VMIP_VIDEO_SAMPLING sampling, uint32_t depth>
+struct PgroupLayout
+{
+   static constexpr uint32_t samples_per_pixel = (sampling == VMIP_VIDEO_SAMPLING_YCBCR_422) ? 2 : 3; /*! Samples per pixel, on average */
+   //A 4:2:2 pgroup holds at least the pair of pixels sharing the same chroma samples.
+   static constexpr uint32_t pixels = (sampling == VMIP_VIDEO_SAMPLING_YCBCR_422) ? 2
+      : (samples_per_pixel * depth % 8 == 0) ? 1 : (2 * samples_per_pixel * depth % 8 == 0) ? 2 : 4; /*! Pixels in a pgroup */
+   static constexpr uint32_t samples = pixels * samples_per_pixel; /*! Samples in a pgroup */
+   static constexpr uint32_t size = samples * depth / 8; /*! Size of a pgroup in bytes */
+};
+
+/*!
+   @brief Packs a line of yuv 4:2:2 10bits samples into the pgroups of a stream format.
+*/
+typedef void (*PatternLinePacker)(const uint16_t* y /*!< [in] Luma samples, one per pixel.*/
+   , const uint16_t* cb /*!< [in] Blue chroma samples, one per pair of pixels.*/
+   , const uint16_t* cr /*!< [in] Red chroma samples, one per pair of pixels.*/
+   , uint32_t pgroup_count /*!< [in] Number of pgroups to write. The samples must cover pgroup_count full pgroups.*/
+   , uint8_t* pgroups /*!< [out] Destination of the pgroups.*/
+);
+
+/*!
+   @brief Gives the pgroup layout of a stream format.
+
+   @returns false if the sampling or the depth is not supported by the sender.
+*/
+bool get_pgroup_layout(VMIP_VIDEO_SAMPLING sampling /*!< [in] Sampling of the stream.*/
+   , VMIP_VIDEO_DEPTH depth /*!< [in] Depth of the stream.*/
+   , uint32_t* pgroup_pixels /*!< [out] Number of pixels in a pgroup.*/
+   , uint32_t* pgroup_size /*!< [out] Size of a pgroup in bytes.*/
+);
+
+/*!
+   @brief Gives the line packer specialized for a stream format.
+
+   @returns The packer, or nullptr if the sampling or the depth is not supported by the sender.
+*/
+PatternLinePacker get_pattern_line_packer(VMIP_VIDEO_SAMPLING sampling /*!< [in] Sampling of the stream.*/
+   , VMIP_VIDEO_DEPTH depth /*!< [in] Depth of the stream.*/
+);
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "quad_link_source.h"
+
+#include <algorithm>
+
+//A pair of samples spans 2 / pgroup_pixels pgroups, 0 if it does not end on a byte boundary.
+static uint32_t sample_pair_size(const PatternEngine& engine)
+{
+   return ((2 * engine.pgroup_size()) % engine.pgroup_pixels() == 0) ? 2 * engine.pgroup_size() / engine.pgroup_pixels() : 0;
+}
+
+QuadLinkSplitter::QuadLinkSplitter(std::unique_ptr<FrameSource> uhd_source, const PatternEngine& uhd_engine, StripeRenderer* renderer)
+   : uhd_source(std::move(uhd_source)), uhd_engine(uhd_engine), interleave(uhd_engine.frame_width(), uhd_engine.frame_height(), sample_pair_size(uhd_engine)),
+   renderer(renderer), following_frame_index(0), frames_rendered(0), splits(0)
+{
+   if (interleave.is_valid() && arena.allocate(static_cast<size_t>(uhd_engine.frame_size()) * cached_frame_count))
+   {
+      for (uint32_t frame = 0; frame < cached_frame_count; frame++)
+         cache[frame].data = arena.data() + static_cast<size_t>(frame) * uhd_engine.frame_size();
+   }
+}
+
+QuadLinkSplitter::QuadLinkSplitter(const StoredFrameSource::FrameFunction& stored_frame, const PatternEngine& uhd_engine, StripeRenderer* renderer)
+   : stored_frame(stored_frame), uhd_engine(uhd_engine), interleave(uhd_engine.frame_width(), uhd_engine.frame_height(), sample_pair_size(uhd_engine)),
+   renderer(renderer), following_frame_index(0), frames_rendered(0), splits(0)
+{
+}
+
+bool QuadLinkSplitter::is_valid() const
+{
+   return interleave.is_valid() && !uhd_engine.is_interlaced() && (stored_frame || arena.data() != nullptr);
+}
+
+const uint8_t* QuadLinkSplitter::lock_frame(uint64_t frame_index, std::shared_lock<std::shared_mutex>& lock)
+{
+   CachedFrame& cached = cache[frame_index % cached_frame_count];
+   while (true)
+   {
+      lock = std::shared_lock<std::shared_mutex>(cached.mutex);
+      if (cached.frame_index == frame_index)
+         return cached.data;
+      lock.unlock();
+
+      //The first link reaching the frame renders it, the others finding it in the cache once they get the lock.
+      //Another link may move the cached frame on to a later counter before the lock is shared again, the frame being rendered once more.
+      std::unique_lock<std::shared_mutex> exclusive_lock(cached.mutex);
+      if (cached.frame_index != frame_index)
+      {
+         std::lock_guard<std::mutex> render_lock(render_mutex);
+         uhd_source->render(frame_index, cached.data, uhd_engine.frame_size());
+         cached.frame_index = frame_index;
+         frames_rendered.fetch_add(1, std::memory_order_relaxed);
+      }
+   }
+}
+
+void QuadLinkSplitter::split(uint64_t frame_index, uint32_t link, uint8_t* link_frame, uint32_t size)
+{
+   if (!is_valid() || size < interleave.link_size())
+      return;
+
+   std::shared_lock<std::shared_mutex> lock;
+   const uint8_t* frame = stored_frame ? stored_frame(frame_index) : lock_frame(frame_index, lock);
+   if (frame == nullptr)
+      return;
+
+   if (renderer)
+      renderer->run(interleave.link_height(), [&](uint32_t first_line, uint32_t line_count) { interleave.split(frame, link, link_frame, first_line, line_count); });
+   else
+      interleave.split(frame, link, link_frame);
+   splits.fetch_add(1, std::memory_order_relaxed);
+
+   uint64_t following = following_frame_index.load(std::memory_order_relaxed);
+   while (frame_index >= following && !following_frame_index.compare_exchange_weak(following, frame_index + 1, std::memory_order_relaxed))
+      ;
+}
+
+QuadLinkStatistics QuadLinkSplitter::get_statistics() const
+{
+   QuadLinkStatistics statistics;
+   statistics.frames_rendered = frames_rendered.load(std::memory_order_relaxed);
+   statistics.splits = splits.load(std::memory_order_relaxed);
+   return statistics;
+}
+
+QuadLinkFrameSource::QuadLinkFrameSource(QuadLinkSplitter& splitter, uint32_t link)
+   : splitter(splitter), link(link)
+{
+}
+
+void QuadLinkFrameSource::render(uint64_t frame_index, uint8_t* frame, uint32_t size)
+{
+   splitter.split(frame_index, link, frame, size);
+}
@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file quad_link_source.h
+   @brief This file contains the quad-link sources, sending a UHD frame as four 1080p links with two-sample interleave (2SI).
+
+   Each link is a video stream of its own, transmitted by its own thread. The UHD frame of a frame counter is produced
+   once for the four links : pre-rendered animations and video files are split straight from the frames they hold,
+   the other sources being rendered into a small cache of UHD frames, shared by the links. Every link then writes its
+   own sub-image into its slot with the 2SI kernel, split in stripes over the renderer workers.
+
+   The links only carry the same picture if they send the same frame counter at the same time : a link restarting
+   after the others resumes from the frame counter they reached.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "frame_arena.h"
+#include "frame_source.h"
+#include "stripe_renderer.h"
+#include "two_sample_interleave.h"
+
+/*!
+   @brief Counters of the QuadLinkSplitter.
+*/
+struct QuadLinkStatistics
+{
+   uint64_t frames_rendered = 0; /*! UHD frames rendered into the cache, more than a quarter of the splits if the links drift apart */
+   uint64_t splits = 0; /*! Link frames written */
+};
+
+class QuadLinkSplitter
+{
+public:
+
+   /*!
+      @brief Splits the UHD frames of a source, rendered once for the four links into the cache.
+   */
+   QuadLinkSplitter(std::unique_ptr<FrameSource> uhd_source /*!< [in] Source of the UHD frames.*/
+      , const PatternEngine& uhd_engine /*!< [in] Layout of the UHD frames. Must outlive the splitter.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, each split is done in stripes by the renderer workers.*/
+   );
+
+   /*!
+      @brief Splits stored UHD frames straight from where they are held.
+   */
+   QuadLinkSplitter(const StoredFrameSource::FrameFunction& stored_frame /*!< [in] Function giving the stored UHD frame of a frame counter.*/
+      , const PatternEngine& uhd_engine /*!< [in] Layout of the UHD frames. Must outlive the splitter.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, each split is done in stripes by the renderer workers.*/
+   );
+
+   QuadLinkSplitter(const QuadLinkSplitter&) = delete;
+   QuadLinkSplitter& operator=(const QuadLinkSplitter&) = delete;
+
+   /*!
+      @brief Tells if the UHD frames can be divided (progressive, a pair of samples being a whole number of bytes) and the cache could be allocated.
+   */
+   bool is_valid() const;
+
+   /*!
+      @brief Writes the sub-image of a link for a frame counter. Called from the threads of the four links at once.
+   */
+   void split(uint64_t frame_index /*!< [in] Frame counter.*/
+      , uint32_t link /*!< [in] Link, from 0 to 3.*/
+      , uint8_t* link_frame /*!< [out] Slot buffer, or frame of the render-ahead ring.*/
+      , uint32_t size /*!< [in] Size of the frame buffer in bytes.*/
+   );
+
+   /*!
+      @brief Gives the frame counter following the last one split, from which a restarting link resumes.
+   */
+   uint64_t next_frame_index() const { return following_frame_index.load(std::memory_order_relaxed); }
+
+   const TwoSampleInterleave& division() const { return interleave; }
+
+   QuadLinkStatistics get_statistics() const;
+
+private:
+
+   static constexpr uint32_t cached_frame_count = 4; /*! UHD frames kept for the links, which may be a few frames apart */
+
+   //A cached frame is rendered under its exclusive lock and split under shared locks, by the four links at once.
+   struct CachedFrame
+   {
+      std::shared_mutex mutex;
+      uint64_t frame_index = UINT64_MAX;
+      uint8_t* data = nullptr;
+   };
+
+   const uint8_t* lock_frame(uint64_t frame_index, std::shared_lock<std::shared_mutex>& lock);
+
+   std::unique_ptr<FrameSource> uhd_source;
+   StoredFrameSource::FrameFunction stored_frame;
+   const PatternEngine& uhd_engine;
+   TwoSampleInterleave interleave;
+   StripeRenderer* renderer;
+   FrameArena arena;
+   CachedFrame cache[cached_frame_count];
+   std::mutex render_mutex; /*! The sources are rendered one frame at a time */
+   std::atomic<uint64_t> following_frame_index; /*! Frame counter following the last one split, 0 before the first split */
+   std::atomic<uint64_t> frames_rendered;
+   std::atomic<uint64_t> splits;
+};
+
+/*!
+   @brief Link of a quad-link stream, writing its sub-image of the shared UHD frames.
+*/
+class QuadLinkFrameSource : public FrameSource
+{
+public:
+
+   QuadLinkFrameSource(QuadLinkSplitter& splitter /*!< [in] Splitter shared by the four links. Must outlive the source.*/
+      , uint32_t link /*!< [in] Link, from 0 to 3.*/
+   );
+
+   void render(uint64_t frame_index, uint8_t* frame, uint32_t size) override;
+
+private:
+
+   QuadLinkSplitter& splitter;
+   uint32_t link;
+};
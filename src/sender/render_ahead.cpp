@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render_ahead.h"
+#include "stripe_renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+//Frames start on a page boundary, so that the copy of a frame to a slot never shares a page with another frame.
+constexpr size_t frame_alignment = 4096;
+//Pause of the producer while the ring is full. Far below a frame period, it does not keep a core busy for nothing.
+constexpr std::chrono::microseconds producer_wait_period(100);
+
+RenderAheadRing::RenderAheadRing(size_t frame_size, uint32_t capacity)
+   : size_of_frame(frame_size), frame_stride((frame_size + frame_alignment - 1) / frame_alignment * frame_alignment)
+   , capacity(std::max(capacity, 2u)), stopping(false), first_frame_index(0), rendered_frames(0), released_frames(0), taken_frames(0), statistics()
+{
+   arena.allocate(frame_stride * this->capacity);
+}
+
+RenderAheadRing::~RenderAheadRing()
+{
+   stop();
+}
+
+uint8_t* RenderAheadRing::frame(uint64_t frame_number) const
+{
+   return arena.data() + (frame_number % capacity) * frame_stride;
+}
+
+bool RenderAheadRing::start(uint64_t first_frame_index, const RenderFunction& render_function, int32_t cpu_core_os_id)
+{
+   if (!is_allocated() || producer.joinable())
+      return false;
+
+   this->first_frame_index = first_frame_index;
+   rendered_frames.store(0, std::memory_order_relaxed);
+   released_frames.store(0, std::memory_order_relaxed);
+   taken_frames = 0;
+   statistics = RenderAheadStatistics();
+   statistics.minimum_queued_frames = UINT32_MAX;
+   stopping.store(false, std::memory_order_relaxed);
+
+   producer = std::thread(&RenderAheadRing::producer_loop, this, render_function);
+   if (cpu_core_os_id >= 0 && !pin_thread(producer, static_cast<uint32_t>(cpu_core_os_id)))
+      std::cout << "Could not pin the render-ahead producer on CPU core " << cpu_core_os_id << std::endl;
+
+   while (rendered_frames.load(std::memory_order_acquire) < capacity)
+      std::this_thread::sleep_for(producer_wait_period);
+   return true;
+}
+
+void RenderAheadRing::stop()
+{
+   if (!producer.joinable())
+      return;
+
+   stopping.store(true, std::memory_order_relaxed);
+   producer.join();
+   statistics.frames_rendered = rendered_frames.load(std::memory_order_relaxed);
+}
+
+void RenderAheadRing::producer_loop(RenderFunction render_function)
+{
+   uint64_t frame_number = 0;
+   while (!stopping.load(std::memory_order_relaxed))
+   {
+      //The frame slot is free once the consumer has released the frame that used it capacity frames ago.
+      if (frame_number - released_frames.load(std::memory_order_acquire) >= capacity)
+      {
+         std::this_thread::sleep_for(producer_wait_period);
+         continue;
+      }
+
+      render_function(first_frame_index + frame_number, frame(frame_number));
+      frame_number++;
+      rendered_frames.store(frame_number, std::memory_order_release);
+   }
+}
+
+const uint8_t* RenderAheadRing::next_frame()
+{
+   const uint32_t queued = queued_frames();
+   statistics.minimum_queued_frames = std::min(statistics.minimum_queued_frames, queued);
+   statistics.maximum_queued_frames = std::max(statistics.maximum_queued_frames, queued);
+   statistics.total_queued_frames += queued;
+
+   if (queued == 0)
+   {
+      statistics.dry_ring++;
+      return (taken_frames != 0) ? frame(taken_frames - 1) : nullptr;
+   }
+
+   //Taking frame taken_frames releases the frame held until now, the one before it.
+   released_frames.store(taken_frames, std::memory_order_release);
+   statistics.frames_taken++;
+   return frame(taken_frames++);
+}
+
+uint32_t RenderAheadRing::queued_frames() const
+{
+   return static_cast<uint32_t>(rendered_frames.load(std::memory_order_acquire) - taken_frames);
+}
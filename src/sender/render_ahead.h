@@ -0,0 +1,132 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file render_ahead.h
+   @brief This file contains the rendering of the transmitted frames ahead of the slots, by a producer thread.
+
+   Rendering a frame between the lock and the unlock of a slot eats into the slack of the slot : a rendering hiccup
+   delays the slot. In render-ahead mode, a producer thread pinned on its own core renders the frames in a bounded ring,
+   and the transmission loop only copies the oldest ready frame into each slot.
+
+   The ring is a lock-free single producer, single consumer queue : the producer publishes the number of frames it has
+   rendered and the consumer the number of frames it has released, each counter being written by a single thread. The
+   consumer holds the frame it took last until it takes the next one, so that the same frame can be sent again when
+   the ring runs dry, the receiver seeing a repeated frame rather than a torn one.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+#include "frame_arena.h"
+
+/*!
+   @brief Statistics of the render-ahead ring, to size it for the worst-case rendering jitter.
+*/
+struct RenderAheadStatistics
+{
+   uint64_t frames_rendered; /*! Number of frames rendered by the producer */
+   uint64_t frames_taken; /*! Number of new frames taken by the transmission loop */
+   uint64_t dry_ring; /*! Number of times no new frame was ready, the previous frame being sent again */
+   uint32_t minimum_queued_frames; /*! Fewest frames ready ahead when a frame was requested, 0 if the ring ran dry */
+   uint32_t maximum_queued_frames; /*! Most frames ready ahead when a frame was requested */
+   uint64_t total_queued_frames; /*! Sum of the frames ready ahead at each request, for the average */
+};
+
+class RenderAheadRing
+{
+public:
+
+   /*!
+      @brief Function rendering frame frame_index of the stream into a frame buffer of the ring.
+   */
+   typedef std::function<void(uint64_t frame_index, uint8_t* frame)> RenderFunction;
+
+   RenderAheadRing(size_t frame_size /*!< [in] Size of a frame in bytes.*/
+      , uint32_t capacity /*!< [in] Number of frames of the ring, the frame being transmitted included. At least 2.*/
+   );
+   ~RenderAheadRing();
+
+   RenderAheadRing(const RenderAheadRing&) = delete;
+   RenderAheadRing& operator=(const RenderAheadRing&) = delete;
+
+   /*!
+      @brief Tells if the frames of the ring could be allocated.
+   */
+   bool is_allocated() const { return arena.data() != nullptr; }
+
+   /*!
+      @brief Starts the producer thread, and waits until it has filled the ring so that the first slots do not find it empty.
+      The statistics are reset.
+
+      @returns false if the ring is not allocated or already started.
+   */
+   bool start(uint64_t first_frame_index /*!< [in] Index of the first frame to render.*/
+      , const RenderFunction& render_function /*!< [in] Function rendering a frame, called from the producer thread only.*/
+      , int32_t cpu_core_os_id /*!< [in] CPU core on which the producer is pinned, -1 to leave it unpinned.*/
+   );
+
+   /*!
+      @brief Stops the producer thread. The frames still queued are dropped.
+   */
+   void stop();
+
+   /*!
+      @brief Gives the frame to copy into the next slot : the oldest frame rendered ahead, or the previous frame again if
+      the ring ran dry. The previous frame is handed back to the producer when a new one is taken.
+      Must be called from a single consumer thread.
+
+      @returns the frame to transmit, nullptr if no frame was ever rendered.
+   */
+   const uint8_t* next_frame();
+
+   /*!
+      @brief Gives the number of frames rendered ahead and not yet taken.
+   */
+   uint32_t queued_frames() const;
+
+   size_t frame_size() const { return size_of_frame; }
+   uint32_t frame_count() const { return capacity; }
+
+   const RenderAheadStatistics& get_statistics() const { return statistics; }
+
+private:
+
+   void producer_loop(RenderFunction render_function);
+   uint8_t* frame(uint64_t frame_number) const;
+
+   size_t size_of_frame;
+   size_t frame_stride;
+   uint32_t capacity;
+   FrameArena arena;
+   std::thread producer;
+   std::atomic<bool> stopping;
+   uint64_t first_frame_index;
+
+   //Each counter is written by one thread only, and sits on its own cache line so that the two threads do not share it.
+   alignas(64) std::atomic<uint64_t> rendered_frames; /*! Written by the producer : frames [0, rendered_frames) are ready */
+   alignas(64) std::atomic<uint64_t> released_frames; /*! Written by the consumer : frames [0, released_frames) may be overwritten */
+   alignas(64) uint64_t taken_frames; /*! Consumer only : frames [0, taken_frames) were taken, the last one being held */
+   RenderAheadStatistics statistics;
+};
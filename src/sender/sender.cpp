@@ -18,6 +18,15 @@
 #include <string>
 #include <cstring>
 #include <thread>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <map>
 
 #ifdef __GNUC__
 #include <stdint-gcc.h>
@@ -25,14 +34,6 @@
 #include <stdint.h>
 #endif
 
-#if defined (__linux__) || defined (__APPLE__)
-#include "../keyboard.h"
-#else
-#include <conio.h>
-#define init_keyboard()
-#define close_keyboard()
-#endif
-
 #include "nmos/model.h"
 #include "nmos/log_model.h"
 #include "nmos/log_gate.h"
@@ -40,25 +41,275 @@
 #include "nmos/node_server.h"
 
 #include "../tools.h"
+#include "../stop_request.h"
+#include "../startup_sequence.h"
 #include "../nmos_tools.h"
-#include "pattern.h"
+#include "stripe_renderer.h"
+#include "stream_transmitter.h"
 
 #include <videomasterip/videomasterip_core.h>
 #include <videomasterip/videomasterip_conductor.h>
 #include <videomasterip/videomasterip_stream.h>
 
+//Parses a comma separated list of CPU core indexes, such as 4,5,6
+static std::vector<uint32_t> parse_cpu_core_list(const std::string& list)
+{
+   std::vector<uint32_t> cpu_core_os_ids;
+   size_t begin = 0;
+   while (begin <= list.size())
+   {
+      const size_t end = std::min(list.find(',', begin), list.size());
+      cpu_core_os_ids.push_back(static_cast<uint32_t>(std::stoul(list.substr(begin, end - begin))));
+      begin = end + 1;
+   }
+   return cpu_core_os_ids;
+}
+
+void print_usage(const char* program_name)
+{
+   std::cout << "Usage: " << program_name << " [options]" << std::endl
+      << "   --pattern <name>             Test pattern : colorbar (default), luma_ramp, zone_plate, moving_box, prbs_noise" << std::endl
+      << "   --animation-frames <count>   Number of pre-rendered frames of the animated patterns (default 60)" << std::endl
+      << "   --pattern-memory-mb <size>   Memory budget of the pre-rendered frames in MiB (default 1024)" << std::endl
+      << "   --direct-render              Render the animated patterns straight into each slot instead of pre-rendering them" << std::endl
+      << "   --file <path>                Raw video file played out in loop in place of the test pattern" << std::endl
+      << "   --file-format <name>         Layout of the video file : pgroup (default, packed as the stream), yuv422p10le" << std::endl
+      << "   --video-standard <name>      Streaming video standard (default 1920x1080p30)" << std::endl
+      << "   --formats <list>             Comma separated video standards the video streams switch to with the keys 1 to 9, starting on the first one" << std::endl
+      << "   --sampling <name>            Streaming video sampling : ycbcr422 (default), ycbcr444, rgb444" << std::endl
+      << "   --depth <bits>               Streaming video depth : 8, 10 (default), 12" << std::endl
+      << "   --render-threads <count>     Threads rendering and copying frames, the transmission thread included (default 1)" << std::endl
+      << "   --render-cores <list>        Comma separated CPU cores of the rendering workers (default : cores not used by VMIP)" << std::endl
+      << "   --signature                  Stamp each frame with a sequence number and a CRC32C in its first line, checked by the receiver" << std::endl
+      << "   --overlay                    Burn the device name, the destination, the frame counter and the PTP time into the picture" << std::endl
+      << "   --render-ahead <frames>      Render frames ahead in a ring of that many frames on a producer thread, the slots only copying them (default 0, off)" << std::endl
+      << "   --render-ahead-core <core>   CPU core of the render-ahead producers (default : cores not used by VMIP nor by the rendering workers)" << std::endl
+      << "   --streams <count>            Number of streams sent by the device, each with its own NMOS sender (default 1)" << std::endl
+      << "   --quad-link                  Send the video standard, 3840x2160p for instance, as four 1920x1080p streams with two-sample interleave (2SI)" << std::endl
+      << "   --processing-cores <list>    Comma separated VMIP processing CPU cores, one per stream (default : core 2, then cores not used by VMIP)" << std::endl
+      << "   --audio-channels <count>     Channels of an ST2110-30 audio stream sent along the video, 24 bits 48 kHz (default 0, no audio, up to 64)" << std::endl
+      << "   --audio-packet-time <time>   Duration of the audio packets : 1ms (default, up to 10 channels), 125us" << std::endl
+      << "   --audio-signal <name>        Signal sent on the audio channels : tone (default, 1 kHz at -18 dBFS), silence" << std::endl
+      << "   --redundant-nic <name>       Second streaming NIC, each stream being sent on both NICs as the two paths of ST2022-7" << std::endl
+      << "   --make-before-break          Build the stream of new transport parameters while the current one keeps transmitting, and swap them between two slots" << std::endl
+      << "   --deadline-dump <path>       Write the slot deadline statistics of every stream, with their slack histogram, as JSON to that file on exit" << std::endl
+      << "   --help                       Print this help" << std::endl;
+
+   std::cout << "Video standards :";
+   for (uint32_t i = 0; i < NB_VMIP_VIDEO_STANDARD; i++)
+      std::cout << " " << to_string(static_cast<VMIP_VIDEO_STANDARD>(i));
+   std::cout << std::endl;
+}
+
+bool parse_arguments(int argc, char* argv[], SenderOptions& options)
+{
+   for (int i = 1; i < argc; i++)
+   {
+      const std::string argument = argv[i];
+      const bool has_value = (i + 1 < argc);
+
+      try
+      {
+         if (argument == "--pattern" && has_value)
+         {
+            if (!parse_pattern_type(argv[++i], options.pattern))
+            {
+               std::cout << "Unknown pattern " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--animation-frames" && has_value)
+            options.animation_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+         else if (argument == "--pattern-memory-mb" && has_value)
+            options.pattern_memory_mb = static_cast<uint32_t>(std::stoul(argv[++i]));
+         else if (argument == "--direct-render")
+            options.direct_render = true;
+         else if (argument == "--file" && has_value)
+            options.video_file_path = argv[++i];
+         else if (argument == "--file-format" && has_value)
+         {
+            if (!parse_video_file_format(argv[++i], options.video_file_format))
+            {
+               std::cout << "Unknown video file format " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--formats" && has_value)
+         {
+            const std::string list = argv[++i];
+            size_t begin = 0;
+            while (begin <= list.size())
+            {
+               const size_t end = std::min(list.find(',', begin), list.size());
+               VMIP_VIDEO_STANDARD video_standard;
+               if (!parse_video_standard(list.substr(begin, end - begin), &video_standard))
+               {
+                  std::cout << "Unknown video standard " << list.substr(begin, end - begin) << std::endl;
+                  return false;
+               }
+               options.video_standards.push_back(video_standard);
+               begin = end + 1;
+            }
+         }
+         else if (argument == "--video-standard" && has_value)
+         {
+            if (!parse_video_standard(argv[++i], &options.video_standard))
+            {
+               std::cout << "Unknown video standard " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--sampling" && has_value)
+         {
+            if (!parse_video_sampling(argv[++i], &options.video_sampling))
+            {
+               std::cout << "Unknown video sampling " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--depth" && has_value)
+         {
+            if (!parse_video_depth(argv[++i], &options.video_depth))
+            {
+               std::cout << "Unknown video depth " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--render-threads" && has_value)
+            options.render_threads = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+         else if (argument == "--render-cores" && has_value)
+            options.render_cpu_core_os_ids = parse_cpu_core_list(argv[++i]);
+         else if (argument == "--signature")
+            options.frame_signature = true;
+         else if (argument == "--overlay")
+            options.text_overlay = true;
+         else if (argument == "--render-ahead" && has_value)
+            options.render_ahead_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+         else if (argument == "--render-ahead-core" && has_value)
+            options.render_ahead_cpu_core_os_id = static_cast<int32_t>(std::stoul(argv[++i]));
+         else if (argument == "--streams" && has_value)
+            options.stream_count = std::max(static_cast<uint32_t>(std::stoul(argv[++i])), 1u);
+         else if (argument == "--quad-link")
+            options.quad_link = true;
+         else if (argument == "--processing-cores" && has_value)
+            options.processing_cpu_core_os_ids = parse_cpu_core_list(argv[++i]);
+         else if (argument == "--audio-channels" && has_value)
+            options.audio_channel_count = std::min(static_cast<uint32_t>(std::stoul(argv[++i])), max_audio_channel_count);
+         else if (argument == "--audio-packet-time" && has_value)
+         {
+            if (!parse_audio_packet_time(argv[++i], &options.audio_packet_time))
+            {
+               std::cout << "Unknown audio packet time " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--audio-signal" && has_value)
+         {
+            if (!parse_audio_signal(argv[++i], options.audio_signal))
+            {
+               std::cout << "Unknown audio signal " << argv[i] << std::endl;
+               return false;
+            }
+         }
+         else if (argument == "--redundant-nic" && has_value)
+            options.redundant_media_nic_name = argv[++i];
+         else if (argument == "--make-before-break")
+            options.make_before_break = true;
+         else if (argument == "--deadline-dump" && has_value)
+            options.deadline_dump_path = argv[++i];
+         else
+         {
+            std::cout << "Unknown or incomplete argument " << argument << std::endl;
+            return false;
+         }
+      }
+      catch (const std::exception&)
+      {
+         std::cout << "Invalid value for argument " << argument << std::endl;
+         return false;
+      }
+   }
+
+   //The formats are selected with the keys 1 to 9. A video file only has the geometry of a single one.
+   if (options.video_standards.empty())
+      options.video_standards.push_back(options.video_standard);
+   if (options.video_standards.size() > 9)
+   {
+      std::cout << "At most 9 video formats can be switched to" << std::endl;
+      return false;
+   }
+   if (options.video_standards.size() > 1 && !options.video_file_path.empty())
+   {
+      std::cout << "A video file cannot be switched to other video formats" << std::endl;
+      return false;
+   }
+
+   //The four links of a quad-link are the video streams of the device, each carrying a quarter of the frames.
+   if (options.quad_link)
+   {
+      VMIP_VIDEO_STANDARD link_video_standard;
+      if (options.video_standards.size() > 1 || options.text_overlay)
+      {
+         std::cout << "A quad-link cannot be switched to other video formats nor carry the overlay" << std::endl;
+         return false;
+      }
+      if (options.stream_count != 1 && options.stream_count != quad_link_count)
+      {
+         std::cout << "A quad-link is sent as " << quad_link_count << " streams" << std::endl;
+         return false;
+      }
+      if (!get_quad_link_video_standard(options.video_standards[0], &link_video_standard))
+      {
+         std::cout << "No video standard of a quarter of " << to_string(options.video_standards[0]) << " to send the links with" << std::endl;
+         return false;
+      }
+      options.stream_count = quad_link_count;
+   }
+
+   if (options.audio_channel_count != 0 && !IPVC_ST2110_30)
+   {
+      std::cout << "The sender is built without the ST2110-30 audio stream (SENDER_ST2110_30 CMake option)" << std::endl;
+      return false;
+   }
+
+   //The samples of a packet must fit in its payload : beyond 10 channels, the packets must be 125 us long.
+   const uint32_t packet_sample_periods = audio_sample_rate / get_audio_packet_rate(options.audio_packet_time);
+   if (options.audio_channel_count * packet_sample_periods * pcm24_sample_size > max_audio_packet_payload)
+   {
+      std::cout << options.audio_channel_count << " audio channels do not fit in " << to_string(options.audio_packet_time) << " packets" << std::endl;
+      return false;
+   }
+   return true;
+}
+
 int main(int argc, char* argv[])
 {
+   SenderOptions options;
+   if (!parse_arguments(argc, argv, options))
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+
    //Stream parameters
-   const std::string media_nic_name = "eno1";  //Streaming network interface controller name
-   const uint32_t destination_address = 0xe0010107; //IP destination address
+   const std::string media_nic_name = "eno1";  //Streaming network interface controller name, also used by PTP
+   const uint32_t destination_address = 0xe0010107; //IP destination address of the first stream, the next streams using the following addresses
+   const uint32_t redundant_destination_address = 0xe0020107; //IP destination address of the second path of the first stream, when sent on a second NIC
    const uint16_t destination_udp_port = 1025; //UDP destination port
-   const uint32_t destination_ssrc = 0x12345600; //SSRC destination
-   const VMIP_VIDEO_STANDARD video_standard = VMIP_VIDEO_STANDARD_1920X1080P30; //Streaming video standard
+   const uint32_t destination_ssrc = 0x12345600; //SSRC destination of the first stream, the next streams using the following SSRC
+   const VMIP_VIDEO_SAMPLING video_sampling = options.video_sampling; //Streaming video sampling
+   const VMIP_VIDEO_DEPTH video_depth = options.video_depth; //Streaming video depth
+   const bool delta_slot_update = true; //Only rewrite the lines that changed since a slot buffer was last used, instead of writing the whole colorbar
+   const uint32_t stream_count = options.stream_count; //Number of video streams sent by the device
+   const uint32_t audio_destination_address = 0xe0010207; //IP destination address of the audio stream
+   const uint32_t redundant_audio_destination_address = 0xe0020207; //IP destination address of the second path of the audio stream
+   const uint32_t audio_destination_ssrc = 0x12345700; //SSRC destination of the audio stream
+   const uint32_t audio_stream_count = (options.audio_channel_count != 0) ? 1 : 0; //The audio stream, if any, follows the video streams
+   const uint32_t audio_stream_index = stream_count;
 
    //VMIP parameters
-   const uint32_t conductor_cpu_core_os_id = 1; //IPVC Conductor CPU core index
-   const std::vector<uint32_t> processing_cpu_core_os_id = { 2 }; //IPVC Processing CPU core indexes list
+   const uint32_t conductor_cpu_core_os_id = 1; //IPVC Conductor CPU core index, shared by all the streams
+   const std::vector<uint32_t> processing_cpu_core_os_id = { 2 }; //IPVC Processing CPU core indexes list of the first stream
    const uint32_t management_thread_cpu_core_os_id = 3; //IPVC Management Thread CPU core index
 
    //NMOS parameters
@@ -75,143 +326,351 @@ int main(int argc, char* argv[])
    const int connection_api_port = 3215; //port used by the node to expose its connection API
 
 
-   VMIP_STREAM_NETWORK_CONFIG stream_network_config;
-   VMIP_STREAM_ESSENCE_CONFIG essence_config;
+   //The state shared with the transmission threads.
+   SenderContext context;
+   context.options = &options;
+   context.management_thread_cpu_core_os_id = management_thread_cpu_core_os_id;
+   context.device_name = device_name;
+   context.sender_streams = std::vector<SenderStream>(stream_count + audio_stream_count);
+   context.nmos_senders = std::vector<nmos_tools::NodeServerSender::Sender>(stream_count + audio_stream_count);
+   context.video_formats = std::vector<VideoFormat>(options.video_standards.size());
 
-   HANDLE vcs_context = nullptr, stream = nullptr, slot = nullptr;
+   HANDLE& vcs_context = context.vcs_context;
    VMIP_VCS_STATUS vcs_status;
-   uint64_t media_nic_id = (uint64_t)-1;
-   VMIP_STREAMTYPE stream_type = VMIP_ST_TX;
-   uint64_t conductor_id = (uint64_t)-1;
+   std::vector<std::string> media_nic_names = { media_nic_name }; //One NIC per path, the first one being also used by PTP
+   std::vector<uint64_t>& media_nic_ids = context.media_nic_ids;
+   uint64_t& conductor_id = context.conductor_id;
    VMIP_ERRORCODE result = VMIPERR_NOERROR;
-   uint32_t frame_height = 0, frame_width = 0, frame_rate = 0;
-   bool interlaced = false, is_us = false;
 
-   uint8_t* buffer = nullptr;
-   uint32_t buffer_size = 0, index = 0, line = 0;
-   std::unique_ptr<uint8_t> video_pattern_buffer;
-   std::string sdp;
+   std::vector<SenderStream>& sender_streams = context.sender_streams;
+   std::vector<nmos_tools::NodeServerSender::Sender>& nmos_senders = context.nmos_senders;
+   std::vector<VideoFormat>& video_formats = context.video_formats;
+   std::unique_ptr<StripeRenderer> stripe_renderer;
+   std::unique_ptr<VideoFile> video_file;
 
-   bool exit = false;
+   std::atomic<bool>& exit = context.exit;
+   std::atomic<uint32_t>& transmitting_streams = context.transmitting_streams;
+   std::atomic<uint32_t>& requested_format_index = context.requested_format_index; //Video format the video streams are switched to
 
-   init_keyboard();
+   start_stop_request_listener();
 
    std::cout << "IP VIRTUAL CARD NMOS ST2110-20 TRANSMISSION SAMPLE APPLICATION\n(c) DELTACAST\n--------------------------------------------------------" << std::endl << std::endl;
 
+   //The phases that do not depend on each other run concurrently, the breakdown of the startup being printed once the sample is ready.
+   StartupSequence startup;
+
    //Creates the context in which the stream will be created. This handle will be needed for all following calls.
-   result = VMIP_CreateVCSContext("http://localhost:8080/", &vcs_context);
-   if(result == VMIPERR_NOERROR)
+   result = startup.run("VCS context", [&]()
    {
-      result = VMIP_GetVCSStatus(vcs_context, &vcs_status);
-      if (result != VMIPERR_NOERROR)
+      VMIP_ERRORCODE context_result = VMIP_CreateVCSContext("http://localhost:8080/", &vcs_context);
+      if(context_result == VMIPERR_NOERROR)
       {
-         std::cout << "Error when getting the VCS status" << " [" << to_string(result) << "]" << std::endl;
+         context_result = VMIP_GetVCSStatus(vcs_context, &vcs_status);
+         if (context_result != VMIPERR_NOERROR)
+         {
+            std::cout << "Error when getting the VCS status" << " [" << to_string(context_result) << "]" << std::endl;
+         }
+         else
+            std::cout << "Connection established to VCS " << version_to_string(vcs_status.VcsVersion) << std::endl;
       }
       else
-         std::cout << "Connection established to VCS " << version_to_string(vcs_status.VcsVersion) << std::endl;
-   }
-   else
-      std::cout << "Error when Creating the context." << " [" << to_string(result) << "]" << std::endl;
+         std::cout << "Error when Creating the context." << " [" << to_string(context_result) << "]" << std::endl;
 
-   if(result == VMIPERR_NOERROR)
+      if(context_result == VMIPERR_NOERROR)
+      {
+         print_cpu_cores_info(vcs_context);
+
+         print_nics_info(vcs_context);
+      }
+      return context_result;
+   });
+
+   //Each stream has processing cores of its own. The first stream keeps the default ones, the next streams take cores not used by VMIP,
+   //and share them in turn once every core is taken.
+   std::vector<uint32_t> vmip_cpu_core_os_ids = { conductor_cpu_core_os_id, management_thread_cpu_core_os_id };
+   std::vector<uint32_t> stream_processing_cpu_core_os_ids = options.processing_cpu_core_os_ids;
+   if (stream_processing_cpu_core_os_ids.empty())
    {
-      print_cpu_cores_info(vcs_context);
+      stream_processing_cpu_core_os_ids = processing_cpu_core_os_id;
+      std::vector<uint32_t> busy_cpu_core_os_ids = vmip_cpu_core_os_ids;
+      busy_cpu_core_os_ids.insert(busy_cpu_core_os_ids.end(), processing_cpu_core_os_id.begin(), processing_cpu_core_os_id.end());
+      const std::vector<uint32_t> free_cpu_core_os_ids = StripeRenderer::select_cpu_cores(busy_cpu_core_os_ids, stream_count + audio_stream_count - 1);
+      stream_processing_cpu_core_os_ids.insert(stream_processing_cpu_core_os_ids.end(), free_cpu_core_os_ids.begin(), free_cpu_core_os_ids.end());
+   }
+   for (uint32_t stream_index = 0; stream_index < sender_streams.size(); stream_index++)
+   {
+      sender_streams[stream_index].processing_cpu_core_os_id = { stream_processing_cpu_core_os_ids[stream_index % stream_processing_cpu_core_os_ids.size()] };
+      sender_streams[stream_index].destination_ssrc = destination_ssrc + stream_index;
+   }
+   //The samples are generated in the slots of the audio stream, by its transmission thread.
+   if (audio_stream_count != 0)
+   {
+      sender_streams[audio_stream_index].destination_ssrc = audio_destination_ssrc;
+      sender_streams[audio_stream_index].audio_source.reset(new AudioSource(options.audio_channel_count, options.audio_signal));
+      nmos_senders[audio_stream_index].audio_channel_count = options.audio_channel_count;
+      nmos_senders[audio_stream_index].audio_packet_time = options.audio_packet_time;
+   }
+   vmip_cpu_core_os_ids.insert(vmip_cpu_core_os_ids.end(), stream_processing_cpu_core_os_ids.begin(), stream_processing_cpu_core_os_ids.end());
 
-      print_nics_info(vcs_context);
+   //The patterns only depend on the video standard : they are rendered while the conductor, the streams and the NMOS node are brought up.
+   //Those of every format are rendered now, so that a switch of format only reconfigures the streams.
+   //The geometry of the formats and the standard of their streams are known before, the streams being configured with them while the patterns are rendered.
+   for (uint32_t format_index = 0; format_index < video_formats.size() && result == VMIPERR_NOERROR; format_index++)
+   {
+      VideoFormat& format = video_formats[format_index];
+      format.video_standard = options.video_standards[format_index];
 
-      //Conductor creation and configuration.
-      //The conductor will be responsible of receiving the packets at the fastest possible rate.
-      result = configure_conductor(conductor_cpu_core_os_id, vcs_context, &conductor_id);
-      if(result == VMIPERR_NOERROR)
+      //Extract details from video standard
+      result = VMIP_GetVideoStandardInfo(format.video_standard, &format.frame_width, &format.frame_height, &format.frame_rate,
+         reinterpret_cast<bool8_t*>(&format.interlaced), reinterpret_cast<bool8_t*>(&format.is_us));
+      if (result != VMIPERR_NOERROR)
       {
-         //Conductor start. At this point, the associated CPU core will be used 100%
-         result = VMIP_StartConductor(vcs_context, conductor_id);
-         if (result != VMIPERR_NOERROR)
-            std::cout << "Error when starting conductor" << " [" << to_string(result) << "]" << std::endl;
+         std::cout << "Could not get the video standard information" << " [" << to_string(result) << "]" << std::endl;
+         break;
       }
+      //The links of a quad-link are sent in the video standard of a quarter of the frame, checked with the arguments.
+      format.stream_standard = format.video_standard;
+      if (options.quad_link)
+         get_quad_link_video_standard(format.video_standard, &format.stream_standard);
+
+      //The names come from VMIP_GetVideoStandardInfo, not to be called while the conductor and the streams are being set up.
+      format.name = to_string(format.video_standard);
+      format.stream_name = to_string(format.stream_standard);
    }
 
+   //The pre-render runs alongside the VMIP calls of the other phases and does not call the SDK : the names of its error codes are taken here.
+   const std::map<VMIP_ERRORCODE, std::string> pattern_error_names = { { VMIPERR_BAD_CONFIGURATION, to_string(VMIPERR_BAD_CONFIGURATION) }, { VMIPERR_OPERATIONFAILED, to_string(VMIPERR_OPERATIONFAILED) } };
    if(result == VMIPERR_NOERROR)
    {
-      result = get_nic_id_from_name(vcs_context, media_nic_name, &media_nic_id);
-
-      if (result == VMIPERR_NOERROR)
+      startup.launch("pattern pre-render", [&]()
       {
-         result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &stream);
-         if (result != VMIPERR_NOERROR)
-            std::cout << "Error when creating stream" << " [" << to_string(result) << "]" << std::endl;
-      }
+         VMIP_ERRORCODE pattern_result = VMIPERR_NOERROR;
+
+         //The rendering workers must not disturb the cores used by VMIP, the conductor core above all.
+         //They are shared by the transmission threads of all the streams.
+         std::vector<uint32_t> render_cpu_core_os_ids = options.render_cpu_core_os_ids;
+         if (render_cpu_core_os_ids.empty())
+            render_cpu_core_os_ids = StripeRenderer::select_cpu_cores(vmip_cpu_core_os_ids, options.render_threads - 1);
+         else if (render_cpu_core_os_ids.size() > options.render_threads - 1)
+            render_cpu_core_os_ids.resize(options.render_threads - 1);
+         stripe_renderer.reset(new StripeRenderer(render_cpu_core_os_ids));
+
+         //The render-ahead producers drive the rendering workers, they need cores of their own as well. They are left unpinned once every core is taken.
+         if (options.render_ahead_frames != 0)
+         {
+            std::vector<uint32_t> busy_cpu_core_os_ids = render_cpu_core_os_ids;
+            busy_cpu_core_os_ids.insert(busy_cpu_core_os_ids.end(), vmip_cpu_core_os_ids.begin(), vmip_cpu_core_os_ids.end());
+            const std::vector<uint32_t> free_cpu_core_os_ids = StripeRenderer::select_cpu_cores(busy_cpu_core_os_ids, stream_count);
+            for (uint32_t stream_index = 0; stream_index < stream_count; stream_index++)
+            {
+               if (options.render_ahead_cpu_core_os_id >= 0)
+                  sender_streams[stream_index].render_ahead_cpu_core_os_id = options.render_ahead_cpu_core_os_id;
+               else if (stream_index < free_cpu_core_os_ids.size())
+                  sender_streams[stream_index].render_ahead_cpu_core_os_id = static_cast<int32_t>(free_cpu_core_os_ids[stream_index]);
+            }
+         }
 
-      if(result == VMIPERR_NOERROR)
-      {
-         //Stream creation and configuration
-         result = configure_stream(vcs_context, stream_type, processing_cpu_core_os_id,
-                                  {destination_address}, {destination_udp_port}, destination_ssrc, video_standard, {media_nic_id}, conductor_id, management_thread_cpu_core_os_id, stream);
-      }
-   }
+         for (VideoFormat& format : video_formats)
+         {
+            if (options.quad_link)
+            {
+               std::cout << "Rendering " << format.name << " " << to_string(video_sampling) << " " << to_string(video_depth) << " bits on " << stripe_renderer->thread_count()
+                  << " thread(s), sent as " << quad_link_count << " x " << format.stream_name << " links" << std::endl;
+            }
+            else
+               std::cout << "Rendering " << stream_count << " x " << format.name << " " << to_string(video_sampling) << " " << to_string(video_depth) << " bits on " << stripe_renderer->thread_count() << " thread(s)" << std::endl;
 
-   //Get the configuration of the stream
-   if (result == VMIPERR_NOERROR)
-   {
-      result = VMIP_GetStreamNetworkConfig(stream, &stream_network_config);
-      if (result != VMIPERR_NOERROR)
-         std::cout << "Error when getting the stream network config" << " [" << to_string(result) << "]" << std::endl;
-   }
+            //The patterns are packed in the sampling and the depth of the stream.
+            format.pattern_engine.reset(new PatternEngine(format.frame_width, format.frame_height, format.interlaced, video_sampling, video_depth));
+            if (!format.pattern_engine->is_format_supported())
+            {
+               pattern_result = VMIPERR_BAD_CONFIGURATION;
+               break;
+            }
 
-   if (result == VMIPERR_NOERROR)
-   {
-      result = VMIP_GetStreamEssenceConfig(stream, &essence_config);
-      if (result != VMIPERR_NOERROR)
-         std::cout << "Error when getting the essence config" << " [" << to_string(result) << "]" << std::endl;
+            if (options.text_overlay)
+               format.text_overlay.reset(new TextOverlay(*format.pattern_engine));
+
+            //A video file replaces the pattern. Its geometry must match the video standard, the only format.
+            if (!options.video_file_path.empty())
+            {
+               video_file.reset(new VideoFile(*format.pattern_engine));
+               if (!video_file->open(options.video_file_path, options.video_file_format, static_cast<size_t>(options.pattern_memory_mb) * 1024 * 1024, stripe_renderer.get()))
+               {
+                  pattern_result = VMIPERR_BAD_CONFIGURATION;
+                  std::cout << "Error when opening the video file " << options.video_file_path << " [" << pattern_error_names.at(pattern_result) << "]" << std::endl;
+               }
+               else
+                  std::cout << "Video file " << options.video_file_path << " : " << video_file->frame_count() << " frames"
+                     << (video_file->is_memory_mapped() ? ", memory mapped" : ", converted") << std::endl;
+            }
+            //Animated patterns rendered straight into each frame trade rendering time for the memory and the copy of pre-rendered frames.
+            else if (options.pattern != PatternType::color_bar && options.direct_render)
+               std::cout << "Pattern " << to_string(options.pattern) << " : rendered in each frame" << std::endl;
+            //Otherwise, they are entirely rendered before the transmission starts, each format within the memory budget.
+            else if (options.pattern != PatternType::color_bar)
+            {
+               format.frame_ring.reset(new FrameRing(*format.pattern_engine));
+               if (!format.frame_ring->render(options.pattern, options.animation_frames, static_cast<size_t>(options.pattern_memory_mb) * 1024 * 1024, stripe_renderer.get()))
+               {
+                  pattern_result = VMIPERR_OPERATIONFAILED;
+                  std::cout << "Error when rendering the " << to_string(options.pattern) << " pattern" << " [" << pattern_error_names.at(pattern_result) << "]" << std::endl;
+               }
+               else
+                  std::cout << "Pattern " << to_string(options.pattern) << " : " << format.frame_ring->frame_count() << " frames pre-rendered"
+                     << (format.frame_ring->uses_huge_pages() ? " in huge pages" : "") << std::endl;
+            }
+            if (pattern_result != VMIPERR_NOERROR)
+               break;
+
+            //The video file and the pre-rendered frames are shared by all the streams, each stream reading them at its own pace.
+            StoredFrameSource::FrameFunction stored_frame;
+            size_t stored_frame_size = 0;
+            if (video_file)
+            {
+               VideoFile* const file = video_file.get();
+               stored_frame = [file](uint64_t frame_index) { return file->frame(frame_index); };
+               stored_frame_size = file->frame_size();
+            }
+            else if (format.frame_ring)
+            {
+               FrameRing* const ring = format.frame_ring.get();
+               stored_frame = [ring](uint64_t frame_index) { return ring->frame(frame_index); };
+               stored_frame_size = ring->frame_size();
+            }
+
+            auto make_frame_source = [&]() -> std::unique_ptr<FrameSource>
+            {
+               if (stored_frame)
+                  return std::unique_ptr<FrameSource>(new StoredFrameSource(stored_frame, stored_frame_size, stripe_renderer.get()));
+               else if (options.pattern != PatternType::color_bar)
+                  return std::unique_ptr<FrameSource>(new AnimatedPatternSource(*format.pattern_engine, options.pattern, options.animation_frames, stripe_renderer.get()));
+               //The colorbar is written from its packed rows, only the lines drawn over it being restored when a slot comes back.
+               else
+                  return std::unique_ptr<FrameSource>(new ColorBarSource(*format.pattern_engine, delta_slot_update, stripe_renderer.get()));
+            };
+
+            //Quad-link : each frame is produced once, then split by each link into its own slots. The stored frames are split from where they are held.
+            if (options.quad_link)
+            {
+               format.quad_link.reset(stored_frame ? new QuadLinkSplitter(stored_frame, *format.pattern_engine, stripe_renderer.get())
+                  : new QuadLinkSplitter(make_frame_source(), *format.pattern_engine, stripe_renderer.get()));
+               if (!format.quad_link->is_valid())
+               {
+                  pattern_result = VMIPERR_BAD_CONFIGURATION;
+                  std::cout << "Error when dividing " << format.name << " " << to_string(video_sampling) << " " << to_string(video_depth)
+                     << " bits in quad-link" << " [" << pattern_error_names.at(pattern_result) << "]" << std::endl;
+                  break;
+               }
+               format.link_engine.reset(new PatternEngine(format.frame_width / 2, format.frame_height / 2, false, video_sampling, video_depth));
+            }
+
+            for (uint32_t stream_index = 0; stream_index < stream_count; stream_index++)
+            {
+               std::vector<std::unique_ptr<FrameSource>>& frame_sources = sender_streams[stream_index].frame_sources;
+               if (format.quad_link)
+                  frame_sources.emplace_back(new QuadLinkFrameSource(*format.quad_link, stream_index));
+               else
+                  frame_sources.emplace_back(make_frame_source());
+            }
+         }
+
+         //The video streams start on the first format.
+         for (uint32_t stream_index = 0; stream_index < stream_count && pattern_result == VMIPERR_NOERROR; stream_index++)
+         {
+            SenderStream& sender_stream = sender_streams[stream_index];
+            sender_stream.frame_source = sender_stream.frame_sources[0].get();
+
+            if (options.render_ahead_frames != 0)
+            {
+               sender_stream.render_ahead.reset(new RenderAheadRing(video_formats[0].stream_engine().frame_size(), options.render_ahead_frames));
+               if (!sender_stream.render_ahead->is_allocated())
+               {
+                  pattern_result = VMIPERR_OPERATIONFAILED;
+                  std::cout << "Error when allocating the render-ahead ring" << " [" << pattern_error_names.at(pattern_result) << "]" << std::endl;
+               }
+               else
+                  std::cout << "Rendering " << sender_stream.render_ahead->frame_count() << " frames ahead"
+                     << (sender_stream.render_ahead_cpu_core_os_id >= 0 ? " on CPU core " + std::to_string(sender_stream.render_ahead_cpu_core_os_id) : std::string()) << std::endl;
+            }
+         }
+         return pattern_result;
+      });
    }
-   
-   //Generate the SDP
-   if (result == VMIPERR_NOERROR)
-      result = generate_sdp(vcs_context,stream_network_config, essence_config, &sdp);
 
+   //Conductor creation and configuration.
+   //The conductor will be responsible of receiving the packets at the fastest possible rate. It is brought up while the patterns are rendered.
+   //The VMIP calls are made one after the other, only the work that does not depend on the SDK runs alongside.
    if(result == VMIPERR_NOERROR)
    {
-      //Extract details from video standard
-      result = VMIP_GetVideoStandardInfo(video_standard, &frame_width, &frame_height, &frame_rate,
-         reinterpret_cast<bool8_t*>(&interlaced), reinterpret_cast<bool8_t*>(&is_us));
-      if (result != VMIPERR_NOERROR)
+      result = startup.run("conductor", [&]()
       {
-         std::cout << "Could not get the video standard information" << " [" << to_string(result) << "]" << std::endl;
-      }
+         VMIP_ERRORCODE conductor_result = configure_conductor(conductor_cpu_core_os_id, vcs_context, &conductor_id);
+         if(conductor_result == VMIPERR_NOERROR)
+         {
+            //Conductor start. At this point, the associated CPU core will be used 100%
+            conductor_result = VMIP_StartConductor(vcs_context, conductor_id);
+            if (conductor_result != VMIPERR_NOERROR)
+               std::cout << "Error when starting conductor" << " [" << to_string(conductor_result) << "]" << std::endl;
+         }
+         return conductor_result;
+      });
+   }
 
+   if (!options.redundant_media_nic_name.empty())
+      media_nic_names.push_back(options.redundant_media_nic_name);
+
+   for (const std::string& nic_name : media_nic_names)
+   {
+      uint64_t media_nic_id = (uint64_t)-1;
       if(result == VMIPERR_NOERROR)
-      {
-         //Video pattern generation
-         video_pattern_buffer.reset(new uint8_t[frame_width * frame_height * PIXELSIZE_10BIT]);
-         create_color_bar_pattern(video_pattern_buffer.get(), frame_height, frame_width);
-      }
+         result = get_nic_id_from_name(vcs_context, nic_name, &media_nic_id);
+      media_nic_ids.push_back(media_nic_id);
    }
 
-   nmos_tools::NodeServerSender::TransportParams resolve_auto_transport_params;
-
-   if(result == VMIPERR_NOERROR)
+   //Each leg is sent from its own NIC toward a multicast group of its own, on the same port.
+   for (size_t leg = 0; leg < media_nic_ids.size() && result == VMIPERR_NOERROR; leg++)
    {
-      result = get_nic_id_from_name(vcs_context, media_nic_name, &media_nic_id);
+      VMIP_NETWORK_ITF_CONFIG network_interface_config;
+      result = VMIP_GetNetworkInterfaceConfig(vcs_context, media_nic_ids[leg], &network_interface_config);
       if(result != VMIPERR_NOERROR)
       {
-         std::cout << "Error when getting the NIC ID from name" << " [" << to_string(result) << "]" << std::endl;
+         std::cout << "Error when getting the network interface configuration" << " [" << to_string(result) << "]" << std::endl;
+         break;
       }
-      else
+
+      for (uint32_t stream_index = 0; stream_index < nmos_senders.size(); stream_index++)
       {
-         VMIP_NETWORK_ITF_CONFIG network_interface_config;
-         result = VMIP_GetNetworkInterfaceConfig(vcs_context, media_nic_id, &network_interface_config);
-         if(result != VMIPERR_NOERROR)
-         {
-            std::cout << "Error when getting the network interface configuration" << " [" << to_string(result) << "]" << std::endl;
-         }
+         nmos_tools::NodeServerSender::TransportParams& resolve_auto_transport_params = nmos_senders[stream_index].resolve_auto_transport_params[leg];
+         const bool is_audio = (stream_index == audio_stream_index);
+
+         resolve_auto_transport_params.ip_src = network_interface_config.InterfaceIpAddress;
+         resolve_auto_transport_params.port_src = 2000;
+         if (is_audio)
+            resolve_auto_transport_params.ip_dst = (leg == 0) ? audio_destination_address : redundant_audio_destination_address;
          else
-         {
-            resolve_auto_transport_params.ip_src = network_interface_config.InterfaceIpAddress;
-            resolve_auto_transport_params.port_src = 2000;
-         }
+            resolve_auto_transport_params.ip_dst = ((leg == 0) ? destination_address : redundant_destination_address) + stream_index;
+         resolve_auto_transport_params.port_dst = destination_udp_port;
+         resolve_auto_transport_params.rtp_enabled = true;
       }
-      resolve_auto_transport_params.ip_dst = destination_address;
-      resolve_auto_transport_params.port_dst = destination_udp_port;
+   }
+
+   //All the streams share the conductor, configured above. They are created and configured one after the other.
+   if (result == VMIPERR_NOERROR)
+   {
+      result = startup.run("streams and SDP", [&]()
+      {
+         VMIP_ERRORCODE stream_result = VMIPERR_NOERROR;
+         for (uint32_t stream_index = 0; stream_index < sender_streams.size() && stream_result == VMIPERR_NOERROR; stream_index++)
+            stream_result = create_sender_stream(context, stream_index);
+         return stream_result;
+      });
+   }
+
+   for (nmos_tools::NodeServerSender::Sender& nmos_sender : nmos_senders)
+   {
+      nmos_sender.activation_state.active_transport_params = nmos_sender.resolve_auto_transport_params;
+      nmos_sender.activation_state.is_enabled = false;
    }
 
    nmos::node_model node_model;
@@ -241,22 +700,55 @@ int main(int argc, char* argv[])
    log_model.settings = node_model.settings;
    log_model.level = nmos::fields::logging_level(log_model.settings);
 
-   nmos_tools::NodeServerSender::TransportParams active_transport_params = resolve_auto_transport_params;
-   nmos_tools::NodeServerSender node_server(node_model, log_model, gate, device_name, device_description, {vcs_context, stream_network_config, essence_config}, resolve_auto_transport_params, active_transport_params, media_nic_name, sdp);
+   //A single device holds the senders of all the streams, video and audio.
+   nmos_tools::NodeServerSender node_server(node_model, log_model, gate, device_name, device_description, nmos_senders, media_nic_names);
+   context.node_server = &node_server;
 
-   if(!node_server.node_implementation_init())
+   //The node is started while the patterns may still be rendered, the transmission threads waiting for them.
+   if (result == VMIPERR_NOERROR)
    {
-      result = VMIPERR_OPERATIONFAILED;
-      std::cout << "Error when initializing the node server" << " [" << to_string(result) << "]" << std::endl;
+      result = startup.run("NMOS node", [&]()
+      {
+         if(!node_server.node_implementation_init())
+         {
+            std::cout << "Error when initializing the node server" << " [" << to_string(VMIPERR_OPERATIONFAILED) << "]" << std::endl;
+            return VMIPERR_OPERATIONFAILED;
+         }
+
+         node_server.start();
+         std::cout << "NMOS: node ready for connections" << std::endl;
+         return VMIPERR_NOERROR;
+      });
    }
 
+   //The transmission threads need the rendered patterns.
+   const VMIP_ERRORCODE startup_result = startup.wait_all();
+   if (result == VMIPERR_NOERROR)
+      result = startup_result;
+   if (result == VMIPERR_NOERROR)
+      startup.print_report();
+
    if (result == VMIPERR_NOERROR)
    {
-      node_server.start();
-      std::cout << "NMOS: node ready for connections" << std::endl;
-   }
+      //A video slot holds a frame. The period of the audio slots is only known once their buffer is.
+      const uint64_t frame_period = get_frame_period(video_formats[0]);
+      for (SenderStream& sender_stream : sender_streams)
+         sender_stream.deadline_monitor.reset(new DeadlineMonitor(sender_stream.audio_source ? 0 : frame_period));
 
-   nmos_tools::NodeServerSender::TransportParams previous_transport_params = resolve_auto_transport_params;
+      //The keys 1 to 9 switch the video streams to the formats, in the order they were given. The other keys stop the sample.
+      if (video_formats.size() > 1)
+      {
+         std::cout << "Video formats :";
+         for (uint32_t format_index = 0; format_index < video_formats.size(); format_index++)
+            std::cout << " " << format_index + 1 << "=" << video_formats[format_index].name;
+         std::cout << std::endl;
+
+         set_command_keys('1', '0' + static_cast<int>(std::min<size_t>(video_formats.size(), 9)));
+      }
+
+      for (uint32_t stream_index = 0; stream_index < sender_streams.size(); stream_index++)
+         sender_streams[stream_index].thread = std::thread(transmit_stream, std::ref(context), stream_index);
+   }
 
    //Get the system parameters and apply new PTP parameters
    nmos_tools::NmosPtpSystemParameters ptp_system_parameters = {};
@@ -264,155 +756,137 @@ int main(int argc, char* argv[])
 
    while(result == VMIPERR_NOERROR && !exit)
    {
-      
-      //Wait for the stream to be enabled
-      while(node_server.is_enabled == false)
+      if (is_stop_requested())
       {
-         if (_kbhit())
-            { 
-               _getch();
-               exit = true;
-               break;
-            }
-
-         //While the stream is disabled, we have to react to PTP changes
-         if(node_server.get_ptp_system_parameters(ptp_system_parameters)) //if get_ptp_system_parameters returns false, it means that the PTP system parameters are not available
-         {
-            if(memcmp(&ptp_system_parameters, &previous_ptp_system_parameters, sizeof(nmos_tools::NmosPtpSystemParameters)) != 0)
-            {
-               //ptp_system_parameters were changed, we need to update the ptp configuration
-               result = apply_ptp_parameters(vcs_context,static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout), media_nic_id);
-               if(result != VMIPERR_NOERROR)
-               {   
-                  exit = true;
-                  break;
-               }
-
-               previous_ptp_system_parameters = ptp_system_parameters;
-            }
-            print_ptp_status(vcs_context, static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout));
-         }
-
-         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+         exit = true;
+         break;
       }
 
-      //to not start and stop the transmission
-      if(exit)
-         break;
+      //The format keys are only posted by the keyboard thread : the switch is requested from here.
+      const int command_key = take_command_key();
+      if (command_key != 0)
+         requested_format_index = static_cast<uint32_t>(command_key - '1');
 
-      if(memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerSender::TransportParams)) != 0)
+      //While no stream is transmitting, we have to react to PTP changes
+      if(transmitting_streams == 0 && node_server.get_ptp_system_parameters(ptp_system_parameters)) //if get_ptp_system_parameters returns false, it means that the PTP system parameters are not available
       {
-         //active parameters were changed, we need to update the stream
-         result = VMIP_DestroyStream(stream);
-         if (result != VMIPERR_NOERROR)
-            std::cout << "Error when destroying the stream"<< " [" << to_string(result) << "]" << std::endl;
-
-         if (result == VMIPERR_NOERROR)
-         {
-            result = VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_20, &stream);
-            if (result != VMIPERR_NOERROR)
-               std::cout << "Error when creating stream" << " [" << to_string(result) << "]" << std::endl;
-         }
-
-         if(result == VMIPERR_NOERROR)
+         if(memcmp(&ptp_system_parameters, &previous_ptp_system_parameters, sizeof(nmos_tools::NmosPtpSystemParameters)) != 0)
          {
-            result = configure_stream(vcs_context, stream_type, processing_cpu_core_os_id,
-                                    {node_server.active_transport_params.ip_dst}, {node_server.active_transport_params.port_dst}, destination_ssrc, video_standard, {media_nic_id}, conductor_id, management_thread_cpu_core_os_id, stream);
+            //ptp_system_parameters were changed, we need to update the ptp configuration
+            result = apply_ptp_parameters(vcs_context,static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout), media_nic_ids[0]);
+            if(result != VMIPERR_NOERROR)
+            {   
+               exit = true;
+               break;
+            }
 
-            previous_transport_params = active_transport_params;
+            previous_ptp_system_parameters = ptp_system_parameters;
          }
+         print_ptp_status(vcs_context, static_cast<uint8_t>(ptp_system_parameters.domain_number), static_cast<uint8_t>(ptp_system_parameters.announce_receipt_timeout));
+      }
 
-         //Regenerate the SDP
-         if (result == VMIPERR_NOERROR)
-            result = generate_sdp(vcs_context, stream, &sdp);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+   }
+   exit = true;
 
-      }
-      
-      if(result == VMIPERR_NOERROR)
+   uint64_t total_cpu_time = 0, total_transmission_time = 0;
+   for (SenderStream& sender_stream : sender_streams)
+   {
+      if (sender_stream.thread.joinable())
+         sender_stream.thread.join();
+      if (result == VMIPERR_NOERROR)
+         result = sender_stream.result;
+      total_cpu_time += sender_stream.cpu_time;
+      total_transmission_time += sender_stream.transmission_time;
+   }
+
+   //Frames missed on air when the transport parameters of a stream were changed while it was enabled.
+   auto print_reconfigurations = [](const SenderStream& sender_stream)
+   {
+      if (sender_stream.reconfigurations != 0)
+         std::cout << ", " << sender_stream.reconfigurations << " reconfigurations, " << sender_stream.reconfiguration_missed_frames << " frames missed ("
+            << sender_stream.max_reconfiguration_missed_frames << " at worst)";
+      if (sender_stream.scheduled_activations != 0)
+         std::cout << ", " << sender_stream.scheduled_activations << " scheduled, switched within " << sender_stream.max_switch_error / 1000 << " us of the frame boundary";
+   };
+
+   //Slots whose lock, rendering and unlock took longer than the slot period.
+   auto print_deadlines = [](const SenderStream& sender_stream)
+   {
+      const DeadlineStatistics deadline_statistics = sender_stream.deadline_monitor->get_statistics();
+      if (deadline_statistics.slots != 0)
+         std::cout << ", " << deadline_statistics.misses << " deadline misses (" << deadline_statistics.max_busy_time / 1000 << " us per slot at worst, "
+            << sender_stream.deadline_monitor->slot_period() / 1000 << " us period)";
+   };
+
+   //Cost of the transmission threads, per stream, to size a host for a number of streams. The VMIP cores are not included.
+   if (total_transmission_time != 0)
+   {
+      std::cout << "Transmission threads : " << sender_streams.size() << " stream(s), " << total_cpu_time * 100 / total_transmission_time << " % of a core per transmitting stream";
+      for (uint32_t stream_index = 0; stream_index < stream_count; stream_index++)
       {
-         result = VMIP_StartStream(stream);
-         if (result != VMIPERR_NOERROR)
+         const SenderStream& sender_stream = sender_streams[stream_index];
+         if (sender_stream.transmission_time != 0 && sender_stream.index != 0)
          {
-            std::cout << "Error when starting stream" << " [" << to_string(result) << "]" << std::endl;
+            std::cout << std::endl << "   Stream " << stream_index + 1 << " : " << sender_stream.index << " frames, " << sender_stream.cpu_time * 100 / sender_stream.transmission_time
+               << " % of a core, " << sender_stream.cpu_time / 1000 / sender_stream.index << " us per frame";
+            print_deadlines(sender_stream);
+            print_reconfigurations(sender_stream);
          }
       }
-      
-      if(result == VMIPERR_NOERROR)
+      //The audio cost is given per channel and per ms of audio, to compare channel counts and packet times.
+      if (audio_stream_count != 0)
       {
-         std::cout << std::endl << "Generated Sdp : " << std::endl << sdp << std::endl;
-         std::cout << std::endl << "Transmission started, press any key to stop..." << std::endl;
-               
-         bool stop_monitoring = false;
-         std::thread monitoring_thread (monitor_tx_stream_status, stream, &stop_monitoring);
-         //Transmission loop
-         while (1)
+         const SenderStream& sender_stream = sender_streams[audio_stream_index];
+         const uint64_t audio_milliseconds = sender_stream.audio_source->get_sample_periods() * 1000 / audio_sample_rate;
+         if (sender_stream.transmission_time != 0 && audio_milliseconds != 0)
          {
-            if (_kbhit())
-            { 
-               _getch();
-               exit = true;
-               break;
-            }
-
-            if(!node_server.is_enabled || memcmp(&previous_transport_params, &active_transport_params, sizeof(nmos_tools::NodeServerSender::TransportParams)) != 0)
-               break;
-
-            //Try to lock the next slot.
-            result = VMIP_LockSlot(stream, &slot);
-
-            if (result != VMIPERR_NOERROR)
-            {
-               std::cout << std::endl << "Error when locking slot at slot " << index << " [" << to_string(result) << "]" << std::endl;
-               break;
-            }
-
-            //Get the video buffer associated to the slot.
-            result = VMIP_GetSlotBuffer(stream, slot, VMIP_ST2110_20_BT_VIDEO, &buffer, &buffer_size);
-            if (result != VMIPERR_NOERROR)
-            {
-               std::cout << std::endl << "Error when getting slot buffer at slot " << index << " [" << to_string(result) << "]" << std::endl;
-            }
-
-            if(video_pattern_buffer.get() != nullptr)
-               std::memcpy(buffer, video_pattern_buffer.get(), buffer_size);
-
-            draw_white_line(buffer, line, frame_height, frame_width, interlaced);
-
-            line++;
-            if (line > frame_height - 1) line = 0;
-            
-            //Unlock the slot. pBuffer wont be available anymore
-            result = VMIP_UnlockSlot(stream, slot);
-
-            if (result != VMIPERR_NOERROR)
-            {
-               std::cout << std::endl << "Error when unlocking slot at slot " << index << " [" << to_string(result) << "]" << std::endl;
-               break;
-            }         
-
-            index++;
+            std::cout << std::endl << "   Audio : " << sender_stream.index << " slots, " << sender_stream.cpu_time * 100 / sender_stream.transmission_time << " % of a core, "
+               << sender_stream.cpu_time / (audio_milliseconds * sender_stream.audio_source->get_channel_count()) << " ns per channel per ms";
+            print_deadlines(sender_stream);
+            print_reconfigurations(sender_stream);
          }
+      }
+      std::cout << std::endl;
+   }
 
-         stop_monitoring = true;
-         monitoring_thread.join();
-         
-         VMIP_ERRORCODE result_stop_stream; //temporary variable to not overwrite result if an error occured in the transmission loop
+   //Frames rendered again because the links drifted apart.
+   for (const VideoFormat& format : video_formats)
+   {
+      if (!format.quad_link)
+         continue;
+      const QuadLinkStatistics quad_link_statistics = format.quad_link->get_statistics();
+      std::cout << "Quad-link split : " << quad_link_statistics.frames_rendered << " frames rendered, " << quad_link_statistics.splits << " link frames split" << std::endl;
+   }
 
-         result_stop_stream = VMIP_StopStream(stream);
-         if (result_stop_stream != VMIPERR_NOERROR)
-         {
-            std::cout << "Error when stopping the stream"<< " [" << to_string(result_stop_stream) << "]" << std::endl;
-            result = result_stop_stream;
-         }
+   //Full statistics of the deadlines, with the slack histograms, for the tools tracking the headroom of a host.
+   if (!options.deadline_dump_path.empty())
+   {
+      std::vector<std::string> stream_names;
+      std::vector<const DeadlineMonitor*> deadline_monitors;
+      for (uint32_t stream_index = 0; stream_index < sender_streams.size(); stream_index++)
+      {
+         stream_names.push_back((stream_index == audio_stream_index) ? std::string("audio") : "stream " + std::to_string(stream_index + 1));
+         deadline_monitors.push_back(sender_streams[stream_index].deadline_monitor.get());
       }
-
+      std::ofstream deadline_dump(options.deadline_dump_path);
+      if (deadline_dump)
+      {
+         write_deadline_dump(deadline_dump, stream_names, deadline_monitors);
+         std::cout << "Deadline statistics written to " << options.deadline_dump_path << std::endl;
+      }
+      else
+         std::cout << "Error when writing the deadline statistics to " << options.deadline_dump_path << std::endl;
    }
    
-   if(stream)
+   for (SenderStream& sender_stream : sender_streams)
    {
-      result = VMIP_DestroyStream(stream);
-      if (result != VMIPERR_NOERROR)
-         std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+      if(sender_stream.stream)
+      {
+         result = VMIP_DestroyStream(sender_stream.stream);
+         if (result != VMIPERR_NOERROR)
+            std::cout << "Error when destroying the stream" << " [" << to_string(result) << "]" << std::endl;
+      }
    }
 
    if(conductor_id != (uint64_t)-1)
@@ -433,9 +907,10 @@ int main(int argc, char* argv[])
          std::cout << "Error when destroying the context" << " [" << to_string(result) << "]" << std::endl;
    }
 
-   close_keyboard();
+   set_command_keys(1, 0);
+   stop_stop_request_listener();
 
    node_server.stop();
 
    return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "slot_tracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+SlotTracker::SlotTracker(const PatternEngine& engine, const std::vector<uint32_t>& background_rows, bool delta_enabled, StripeRenderer* renderer)
+   : engine(engine), background_rows(background_rows), delta_enabled(delta_enabled), renderer(renderer), statistics({0, 0, 0})
+{
+}
+
+void SlotTracker::render_background(uint8_t* slot_buffer, uint32_t size)
+{
+   //Each line is written from its row template, which stays in the cache : only the slot buffer goes through memory.
+   auto render_lines = [&](uint32_t first_line, uint32_t line_count) {
+      for (uint32_t buffer_line = first_line; buffer_line < first_line + line_count; buffer_line++)
+      {
+         const uint32_t row_id = background_rows[engine.picture_line(buffer_line)];
+         std::memcpy(slot_buffer + static_cast<size_t>(buffer_line) * engine.line_size(), engine.row_template(row_id), engine.line_size());
+      }
+   };
+
+   const uint32_t line_count = std::min(size / engine.line_size(), engine.frame_height());
+   if (renderer)
+      renderer->run(line_count, render_lines);
+   else
+      render_lines(0, line_count);
+}
+
+void SlotTracker::restore(uint8_t* slot_buffer, uint32_t buffer_size)
+{
+   if (slot_buffer == nullptr || background_rows.size() != engine.frame_height())
+      return;
+
+   if (buffer_size != engine.frame_size())
+   {
+      //The slot layout is not the one of the background, nothing can be assumed on its content.
+      render_background(slot_buffer, std::min(buffer_size, engine.frame_size()));
+      statistics.full_copies++;
+      statistics.bytes_written += std::min(buffer_size, engine.frame_size());
+      dirty_lines.erase(slot_buffer);
+      return;
+   }
+
+   auto slot = dirty_lines.find(slot_buffer);
+   if (!delta_enabled || slot == dirty_lines.end())
+   {
+      render_background(slot_buffer, buffer_size);
+      statistics.full_copies++;
+      statistics.bytes_written += buffer_size;
+
+      if (delta_enabled)
+      {
+         if (dirty_lines.size() >= max_tracked_slots)
+            dirty_lines.clear();
+         dirty_lines[slot_buffer].clear();
+      }
+      return;
+   }
+
+   for (uint32_t line : slot->second)
+   {
+      std::memcpy(slot_buffer + engine.line_offset(line), engine.row_template(background_rows[line]), engine.line_size());
+      statistics.bytes_written += engine.line_size();
+   }
+   slot->second.clear();
+   statistics.delta_updates++;
+}
+
+void SlotTracker::mark_dirty(uint8_t* slot_buffer, uint32_t line)
+{
+   if (!delta_enabled)
+      return;
+
+   auto slot = dirty_lines.find(slot_buffer);
+   if (slot != dirty_lines.end() && std::find(slot->second.begin(), slot->second.end(), line) == slot->second.end())
+      slot->second.push_back(line);
+}
+
+void SlotTracker::reset()
+{
+   dirty_lines.clear();
+}
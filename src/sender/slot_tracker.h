@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file slot_tracker.h
+   @brief This file contains the tracking of the content of the TX slot buffers.
+
+   Slot buffers are reused in a ring by the stream. Once a slot buffer has been filled with the background pattern,
+   only the lines that were drawn over it need to be restored the next time the same buffer is handed back,
+   instead of rendering the whole frame again. The background is made of row templates, written straight into the
+   slot buffers : no intermediate frame is read.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <unordered_map>
+#include <vector>
+
+#include "pattern_engine.h"
+#include "stripe_renderer.h"
+
+class SlotTracker
+{
+public:
+
+   /*!
+      @brief Statistics on the slot updates.
+   */
+   struct Statistics
+   {
+      uint64_t full_copies; /*! Number of slots filled with the whole background */
+      uint64_t delta_updates; /*! Number of slots updated by restoring their dirty lines only */
+      uint64_t bytes_written; /*! Number of bytes written in slot buffers to restore the background */
+   };
+
+   SlotTracker(const PatternEngine& engine /*!< [in] Engine giving the layout of the frame.*/
+      , const std::vector<uint32_t>& background_rows /*!< [in] Id of the row template of each picture line of the background, frame_height entries.*/
+      , bool delta_enabled /*!< [in] If false, the whole background is written in every slot.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, the whole background is written in stripes by the renderer workers.*/
+   );
+
+   /*!
+      @brief Brings a slot buffer back to the background pattern. Only the dirty lines are rewritten if the buffer is known,
+      otherwise the whole background is written.
+   */
+   void restore(uint8_t* slot_buffer /*!< [in,out] Buffer of the locked slot.*/
+      , uint32_t buffer_size /*!< [in] Size of the slot buffer.*/
+   );
+
+   /*!
+      @brief Records that a picture line of a slot buffer was drawn over, and differs from the background.
+   */
+   void mark_dirty(uint8_t* slot_buffer /*!< [in] Buffer of the locked slot.*/
+      , uint32_t line /*!< [in] Line of the picture, from the top.*/
+   );
+
+   /*!
+      @brief Forgets every slot buffer. Must be called when the stream, and so its slot buffers, changes.
+   */
+   void reset();
+
+   const Statistics& get_statistics() const { return statistics; }
+
+private:
+
+   //Above this number of distinct buffers, the slot ring is not behaving as expected and tracking is restarted.
+   static constexpr uint32_t max_tracked_slots = 256;
+
+   const PatternEngine& engine;
+   std::vector<uint32_t> background_rows;
+   bool delta_enabled;
+   StripeRenderer* renderer;
+   std::unordered_map<const uint8_t*, std::vector<uint32_t>> dirty_lines;
+   Statistics statistics;
+
+   void render_background(uint8_t* slot_buffer, uint32_t size);
+};
@@ -0,0 +1,620 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stream_transmitter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+
+#include "../frame_signature.h"
+#include "../frame_copy.h"
+
+/*!
+   @brief Stream built with new transport parameters, to take over from the stream being transmitted (make-before-break).
+*/
+struct ReplacementStream
+{
+   HANDLE stream = nullptr; /*! VMIP stream, configured but not started */
+   std::string sdp; /*! SDP of the stream */
+   nmos_tools::NodeServerSender::TransportLegs transport_params = {}; /*! Transport parameters the stream was built with */
+   VMIP_ERRORCODE result = VMIPERR_NOERROR; /*! Error that prevented the stream from being built */
+};
+
+//Counts the frames missed between the last slot unlocked on a stream and the first slot unlocked on the stream replacing it, from the mean slot period.
+//Two slots in a row are unlocked a period apart : no frame is missed under one and a half period.
+//The slots are timed when they are queued to VMIP, not when they leave the NIC : this is the gap in the queue, the gap on air following it.
+static uint64_t count_missed_frames(std::chrono::steady_clock::time_point last_slot_unlocked, std::chrono::steady_clock::time_point first_slot, uint64_t slot_period)
+{
+   const int64_t gap = std::chrono::duration_cast<std::chrono::nanoseconds>(first_slot - last_slot_unlocked).count();
+   if (gap <= 0 || slot_period == 0)
+      return 0;
+   const uint64_t periods = (static_cast<uint64_t>(gap) + slot_period / 2) / slot_period;
+   return (periods > 1) ? periods - 1 : 0;
+}
+
+//Writes the frame counter and the time of day of the PTP clock as a non drop frame timecode, counted from the start of each second.
+//The system clock is expected to be disciplined by PTP (phc2sys for instance). It is in UTC, as the ST2059-1 time of day.
+static void format_frame_information(char* text, size_t size, uint64_t frame_counter, uint32_t frame_rate, bool is_us)
+{
+   const uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+   const uint64_t seconds = nanoseconds / 1000000000;
+   const uint64_t frames = (nanoseconds % 1000000000) * frame_rate * (is_us ? 1000 : 1001) / (1001ull * 1000000000);
+
+   snprintf(text, size, "FRAME %010llu PTP %02u:%02u:%02u:%02u", static_cast<unsigned long long>(frame_counter),
+      static_cast<unsigned>(seconds / 3600 % 24), static_cast<unsigned>(seconds / 60 % 60), static_cast<unsigned>(seconds % 60), static_cast<unsigned>(frames));
+}
+
+//Configures a created stream of the device toward the destinations of its legs, as a video or an audio stream.
+//The stream is sent on the enabled legs only, on the first one if they are all disabled.
+static VMIP_ERRORCODE configure_sender_stream(const SenderContext& context, const SenderStream& sender_stream, const nmos_tools::NodeServerSender::TransportLegs& legs, HANDLE stream)
+{
+   const SenderOptions& options = *context.options;
+   std::vector<uint32_t> addresses;
+   std::vector<uint16_t> udp_ports;
+   std::vector<uint64_t> nic_ids;
+   for (size_t leg = 0; leg < context.media_nic_ids.size(); leg++)
+   {
+      if (!legs[leg].rtp_enabled)
+         continue;
+      addresses.push_back(legs[leg].ip_dst);
+      udp_ports.push_back(legs[leg].port_dst);
+      nic_ids.push_back(context.media_nic_ids[leg]);
+   }
+   if (nic_ids.empty())
+   {
+      addresses.push_back(legs[0].ip_dst);
+      udp_ports.push_back(legs[0].port_dst);
+      nic_ids.push_back(context.media_nic_ids[0]);
+   }
+
+   if (sender_stream.audio_source)
+      return configure_audio_stream(context.vcs_context, context.stream_type, sender_stream.processing_cpu_core_os_id,
+                                    addresses, udp_ports, sender_stream.destination_ssrc, options.audio_channel_count, options.audio_packet_time, nic_ids, context.conductor_id, context.management_thread_cpu_core_os_id, stream);
+   else
+      return configure_stream(context.vcs_context, context.stream_type, sender_stream.processing_cpu_core_os_id,
+                              addresses, udp_ports, sender_stream.destination_ssrc, context.video_formats[sender_stream.format_index].stream_standard, options.video_sampling, options.video_depth,
+                              nic_ids, context.conductor_id, context.management_thread_cpu_core_os_id, stream);
+}
+
+//Creates and configures a new stream of the device with the given transport parameters, and generates its SDP. The stream is destroyed if it cannot be configured.
+static VMIP_ERRORCODE build_sender_stream(const SenderContext& context, const SenderStream& sender_stream, const nmos_tools::NodeServerSender::TransportLegs& legs, const std::string& stream_name, HANDLE& stream, std::string& sdp)
+{
+   VMIP_ERRORCODE build_result = sender_stream.audio_source ? create_audio_stream(context.vcs_context, context.stream_type, &stream)
+      : VMIP_CreateStream(context.vcs_context, context.stream_type, VMIP_ET_ST2110_20, &stream);
+   if (build_result != VMIPERR_NOERROR)
+      std::cout << stream_name << "Error when creating stream" << " [" << to_string(build_result) << "]" << std::endl;
+
+   if (build_result == VMIPERR_NOERROR)
+      build_result = configure_sender_stream(context, sender_stream, legs, stream);
+
+   if (build_result == VMIPERR_NOERROR)
+      build_result = generate_sdp(context.vcs_context, stream, &sdp);
+
+   if (build_result != VMIPERR_NOERROR && stream != nullptr)
+   {
+      VMIP_DestroyStream(stream);
+      stream = nullptr;
+   }
+   return build_result;
+}
+
+//Moves a video stream to one of the formats rendered at startup, between two runs of the stream. The render-ahead ring follows the size of the frames.
+static VMIP_ERRORCODE select_video_format(const SenderContext& context, SenderStream& sender_stream, uint32_t format_index)
+{
+   const VideoFormat& format = context.video_formats[format_index];
+   sender_stream.format_index = format_index;
+   sender_stream.frame_source = sender_stream.frame_sources[format_index].get();
+   sender_stream.deadline_monitor->set_slot_period(get_frame_period(format));
+
+   if (sender_stream.render_ahead && sender_stream.render_ahead->frame_size() != format.stream_engine().frame_size())
+   {
+      sender_stream.render_ahead.reset(new RenderAheadRing(format.stream_engine().frame_size(), context.options->render_ahead_frames));
+      if (!sender_stream.render_ahead->is_allocated())
+      {
+         std::cout << "Error when allocating the render-ahead ring" << " [" << to_string(VMIPERR_OPERATIONFAILED) << "]" << std::endl;
+         return VMIPERR_OPERATIONFAILED;
+      }
+   }
+   return VMIPERR_NOERROR;
+}
+
+//Period of the frames of a video format, in nanoseconds.
+uint64_t get_frame_period(const VideoFormat& format)
+{
+   return 1000000000ull * 1001 / (static_cast<uint64_t>(format.frame_rate) * (format.is_us ? 1000 : 1001));
+}
+
+VMIP_ERRORCODE create_sender_stream(SenderContext& context, uint32_t stream_index)
+{
+   SenderStream& sender_stream = context.sender_streams[stream_index];
+   nmos_tools::NodeServerSender::Sender& nmos_sender = context.nmos_senders[stream_index];
+
+   VMIP_ERRORCODE result = sender_stream.audio_source ? create_audio_stream(context.vcs_context, context.stream_type, &sender_stream.stream)
+      : VMIP_CreateStream(context.vcs_context, context.stream_type, VMIP_ET_ST2110_20, &sender_stream.stream);
+   if (result != VMIPERR_NOERROR)
+      std::cout << "Error when creating stream " << stream_index << " [" << to_string(result) << "]" << std::endl;
+
+   if(result == VMIPERR_NOERROR)
+   {
+      //Stream creation and configuration
+      result = configure_sender_stream(context, sender_stream, nmos_sender.resolve_auto_transport_params, sender_stream.stream);
+   }
+
+   //Get the configuration of the stream
+   if (result == VMIPERR_NOERROR)
+   {
+      result = VMIP_GetStreamNetworkConfig(sender_stream.stream, &nmos_sender.vmip_info.stream_network_config);
+      if (result != VMIPERR_NOERROR)
+         std::cout << "Error when getting the stream network config" << " [" << to_string(result) << "]" << std::endl;
+   }
+
+   if (result == VMIPERR_NOERROR)
+   {
+      result = VMIP_GetStreamEssenceConfig(sender_stream.stream, &nmos_sender.vmip_info.essence_config);
+      if (result != VMIPERR_NOERROR)
+         std::cout << "Error when getting the essence config" << " [" << to_string(result) << "]" << std::endl;
+   }
+
+   //Generate the SDP
+   if (result == VMIPERR_NOERROR)
+   {
+      nmos_sender.vmip_info.vcs_context = context.vcs_context;
+      result = generate_sdp(context.vcs_context, nmos_sender.vmip_info.stream_network_config, nmos_sender.vmip_info.essence_config, &nmos_sender.sdp);
+   }
+   return result;
+}
+
+void transmit_stream(SenderContext& context, uint32_t stream_index)
+{
+   const SenderOptions& options = *context.options;
+   const std::vector<VideoFormat>& video_formats = context.video_formats;
+   const std::vector<SenderStream>& sender_streams = context.sender_streams;
+   std::atomic<bool>& exit = context.exit;
+   SenderStream& sender_stream = context.sender_streams[stream_index];
+   nmos_tools::NodeServerSender::Sender& nmos_sender = context.nmos_senders[stream_index];
+
+   //With several streams, the messages tell which stream they come from.
+   const std::string stream_name = sender_stream.audio_source ? "[audio] " : (sender_streams.size() > 1) ? "[stream " + std::to_string(stream_index + 1) + "] " : std::string();
+
+   VMIP_ERRORCODE stream_result = VMIPERR_NOERROR;
+   HANDLE slot = nullptr;
+   uint8_t* buffer = nullptr;
+   uint32_t buffer_size = 0;
+   std::string sdp = nmos_sender.sdp;
+   DeadlineMonitor* const deadline_monitor = sender_stream.deadline_monitor.get();
+   //The identity is swapped by the transmission thread while the render-ahead producer may be drawing it.
+   std::shared_ptr<const std::string> overlay_identity;
+   char overlay_frame_information[64] = {};
+   nmos_tools::NodeServerSender::TransportLegs previous_transport_params = nmos_sender.resolve_auto_transport_params;
+
+   //Output gap of a reconfiguration : the last slot of the previous stream was unlocked at last_slot_unlocked, the slots being sent every slot_period nanoseconds.
+   bool reconfiguring = false;
+   std::chrono::steady_clock::time_point last_slot_unlocked;
+   uint64_t slot_period = 0;
+   //Frame boundary on which the reconfiguration was scheduled by the activation, 0 if it was immediate.
+   uint64_t scheduled_switch_time = 0;
+
+   //Accounts for the frames missed on air by a reconfiguration, once the first slot of the new stream is unlocked.
+   auto end_reconfiguration = [&](const char* mode, std::chrono::steady_clock::time_point first_slot)
+   {
+      const uint64_t missed_frames = count_missed_frames(last_slot_unlocked, first_slot, slot_period);
+      sender_stream.reconfigurations++;
+      sender_stream.reconfiguration_missed_frames += missed_frames;
+      sender_stream.max_reconfiguration_missed_frames = std::max(sender_stream.max_reconfiguration_missed_frames, missed_frames);
+      std::cout << std::endl << stream_name << "Reconfigured (" << mode << ") : " << missed_frames << " frames missed" << std::endl;
+      reconfiguring = false;
+
+      if (scheduled_switch_time != 0)
+      {
+         const int64_t switch_error = print_switch_error(context.vcs_context, stream_name, scheduled_switch_time, nmos_tools::get_tai_time());
+         sender_stream.scheduled_activations++;
+         sender_stream.max_switch_error = std::max(sender_stream.max_switch_error, std::abs(switch_error));
+         scheduled_switch_time = 0;
+      }
+   };
+
+   //Frame boundaries of the stream : the frames of the video, in the current format, the packets of the audio.
+   uint32_t boundary_rate_numerator = 0, boundary_rate_denominator = 0;
+   auto update_boundary_rate = [&]()
+   {
+      const VideoFormat& format = video_formats[sender_stream.format_index];
+      boundary_rate_numerator = sender_stream.audio_source ? get_audio_packet_rate(options.audio_packet_time) : format.frame_rate * (format.is_us ? 1000 : 1001);
+      boundary_rate_denominator = sender_stream.audio_source ? 1 : 1001;
+   };
+   update_boundary_rate();
+
+   //The audio stream keeps its format.
+   auto is_format_switch_requested = [&]()
+   {
+      return !sender_stream.audio_source && context.requested_format_index.load(std::memory_order_relaxed) != sender_stream.format_index;
+   };
+
+   //Activation state of the sender, copied once per loop iteration : the legs, the enable and the times come from the same activation.
+   nmos_tools::NodeServerSender::ActivationState activation_state = {};
+
+   while(stream_result == VMIPERR_NOERROR && !exit)
+   {
+      //Wait for the stream to be enabled, or for a new format to be applied to the disabled stream.
+      activation_state = nmos_sender.get_activation_state();
+      while(!activation_state.is_enabled && !exit && !is_format_switch_requested())
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+         activation_state = nmos_sender.get_activation_state();
+      }
+
+      //to not start and stop the transmission
+      if(exit)
+         break;
+
+      const bool format_changed = is_format_switch_requested();
+      if(format_changed || memcmp(&previous_transport_params, &activation_state.active_transport_params, sizeof(nmos_tools::NodeServerSender::TransportLegs)) != 0)
+      {
+         //active parameters or the video format were changed, we need to update the stream
+         stream_result = VMIP_DestroyStream(sender_stream.stream);
+         sender_stream.stream = nullptr;
+         if (stream_result != VMIPERR_NOERROR)
+            std::cout << stream_name << "Error when destroying the stream"<< " [" << to_string(stream_result) << "]" << std::endl;
+
+         //The frames of the new format are already rendered, only the stream is rebuilt.
+         if(stream_result == VMIPERR_NOERROR && format_changed)
+            stream_result = select_video_format(context, sender_stream, context.requested_format_index.load(std::memory_order_relaxed));
+
+         if(stream_result == VMIPERR_NOERROR)
+         {
+            previous_transport_params = activation_state.active_transport_params;
+            stream_result = build_sender_stream(context, sender_stream, previous_transport_params, stream_name, sender_stream.stream, sdp);
+         }
+
+         //The flow and the transport file of the sender follow the new format.
+         if(stream_result == VMIPERR_NOERROR && format_changed)
+         {
+            VMIP_STREAM_ESSENCE_CONFIG essence_config;
+            stream_result = VMIP_GetStreamEssenceConfig(sender_stream.stream, &essence_config);
+            if (stream_result != VMIPERR_NOERROR)
+               std::cout << stream_name << "Error when getting the essence config" << " [" << to_string(stream_result) << "]" << std::endl;
+            else if (!context.node_server->update_video_format(stream_index, essence_config, sdp))
+               std::cout << stream_name << "Error when updating the NMOS flow of the sender" << std::endl;
+            else
+               std::cout << std::endl << stream_name << "Switched to " << video_formats[sender_stream.format_index].name << std::endl;
+            update_boundary_rate();
+         }
+      }
+      else
+         reconfiguring = false;
+
+      //A disabled stream only follows the new format, it is started once enabled.
+      if(stream_result == VMIPERR_NOERROR && !activation_state.is_enabled)
+         continue;
+      
+      if(stream_result == VMIPERR_NOERROR)
+      {
+         stream_result = VMIP_StartStream(sender_stream.stream);
+         if (stream_result != VMIPERR_NOERROR)
+         {
+            std::cout << stream_name << "Error when starting stream" << " [" << to_string(stream_result) << "]" << std::endl;
+         }
+      }
+      
+      if(stream_result == VMIPERR_NOERROR)
+      {
+         context.transmitting_streams++;
+         std::cout << std::endl << stream_name << "Generated Sdp : " << std::endl << sdp << std::endl;
+         std::cout << std::endl << stream_name << "Transmission started, press any key to stop..." << std::endl;
+               
+         //Slot buffers are only known for the current run of the stream.
+         //Only the colorbar goes through a slot tracker, the other sources overwrite the whole frame every time.
+         //In render-ahead mode, the tracker follows the frames of the render-ahead ring instead of the slots.
+         SlotTracker* const slot_tracker = sender_stream.frame_source ? sender_stream.frame_source->slot_tracker() : nullptr;
+         if (slot_tracker)
+            slot_tracker->reset();
+
+         //The destination only changes when the stream is reconfigured.
+         auto make_overlay_identity = [&]()
+         {
+            return std::make_shared<const std::string>(context.device_name + " " + utility::conversions::to_utf8string(nmos_tools::ipv4_to_string(previous_transport_params[0].ip_dst))
+               + ":" + std::to_string(previous_transport_params[0].port_dst));
+         };
+         std::atomic_store(&overlay_identity, make_overlay_identity());
+
+         //Renders frame frame_index of the stream in its current format, either into the locked slot or into a frame of the render-ahead ring.
+         const VideoFormat& format = video_formats[sender_stream.format_index];
+
+         //A link restarting after the others resumes from the frame they reached, for the four links to carry the same picture.
+         //In render-ahead mode, the frames split last are ahead of the slots by the frames of the ring.
+         if (format.quad_link)
+         {
+            const uint64_t frames_ahead = sender_stream.render_ahead ? sender_stream.render_ahead->frame_count() - 1 : 0;
+            const uint64_t next_frame_index = format.quad_link->next_frame_index();
+            if (next_frame_index > frames_ahead)
+               sender_stream.index = std::max(sender_stream.index, next_frame_index - frames_ahead);
+         }
+
+         auto render_frame = [&](uint64_t frame_index, uint8_t* frame, uint32_t size)
+         {
+            sender_stream.frame_source->render(frame_index, frame, size);
+
+            if (format.text_overlay)
+            {
+               //The text is copied from the pre-packed glyphs, below the first line reserved for the signature.
+               const std::shared_ptr<const std::string> identity = std::atomic_load(&overlay_identity);
+               format_frame_information(overlay_frame_information, sizeof(overlay_frame_information), frame_index, format.frame_rate, format.is_us);
+               const uint32_t text_line = format.text_overlay->cell_height() / 2;
+               format.text_overlay->draw(frame, format.text_overlay->cell_width(), text_line, identity->c_str(), slot_tracker);
+               format.text_overlay->draw(frame, format.text_overlay->cell_width(), text_line + format.text_overlay->cell_height(), overlay_frame_information, slot_tracker);
+            }
+
+            if (options.frame_signature)
+            {
+               //The first line is reserved for the signature, and must be restored from the background next time the frame buffer comes back.
+               write_frame_signature(frame, size, format.stream_engine().line_size(), frame_index);
+               if (slot_tracker)
+                  slot_tracker->mark_dirty(frame, format.stream_engine().picture_line(0));
+            }
+         };
+
+         //The producer renders the frames following the last transmitted one, so that the animations and the sequence numbers carry on.
+         RenderAheadRing* const render_ahead = sender_stream.render_ahead.get();
+         if (render_ahead)
+         {
+            const uint32_t render_ahead_frame_size = static_cast<uint32_t>(render_ahead->frame_size());
+            render_ahead->start(sender_stream.index, [&render_frame, render_ahead_frame_size](uint64_t frame_index, uint8_t* frame) { render_frame(frame_index, frame, render_ahead_frame_size); },
+               sender_stream.render_ahead_cpu_core_os_id);
+         }
+
+         //The status line of a single stream is refreshed in place, it cannot be shared by several streams.
+         bool stop_monitoring = false;
+         std::thread monitoring_thread;
+         auto start_monitoring = [&]()
+         {
+            stop_monitoring = false;
+            if (sender_streams.size() == 1)
+               monitoring_thread = std::thread(monitor_tx_stream_status, sender_stream.stream, &stop_monitoring, &sender_stream.deadline_monitor->get_misses());
+         };
+         auto end_monitoring = [&]()
+         {
+            stop_monitoring = true;
+            if (monitoring_thread.joinable())
+               monitoring_thread.join();
+         };
+         start_monitoring();
+
+         const uint64_t start_cpu_time = get_thread_cpu_time();
+         const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+         const uint64_t start_index = sender_stream.index;
+         auto measure_slot_period = [&]() -> uint64_t
+         {
+            if (sender_stream.index == start_index)
+               return 0;
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count()) / (sender_stream.index - start_index);
+         };
+
+         //Make-before-break : the replacement is built by another thread while this stream keeps transmitting, as soon as an activation is staged
+         //for a scheduled time or is activated. Once it is started, the previous stream is stopped after the first slot of the replacement has been unlocked.
+         std::future<ReplacementStream> replacement_build;
+         ReplacementStream replacement;
+         HANDLE retiring_stream = nullptr;
+
+         //Destroys the replacement built for parameters that will not be activated.
+         auto drop_replacement = [&]()
+         {
+            if (replacement.stream)
+               VMIP_DestroyStream(replacement.stream);
+            replacement = ReplacementStream();
+         };
+
+         //Transmission loop
+         while (!exit)
+         {
+            activation_state = nmos_sender.get_activation_state();
+            if(!activation_state.is_enabled)
+               break;
+
+            //A new video format is applied between two runs of the stream.
+            if (is_format_switch_requested())
+               break;
+
+            const bool transport_changed = memcmp(&previous_transport_params, &activation_state.active_transport_params, sizeof(nmos_tools::NodeServerSender::TransportLegs)) != 0;
+
+            //A scheduled activation lands on the first frame boundary at or after its time, the current stream being sent until then.
+            if (transport_changed && retiring_stream == nullptr)
+               scheduled_switch_time = (activation_state.activation_time != 0) ? next_frame_boundary(activation_state.activation_time, boundary_rate_numerator, boundary_rate_denominator) : 0;
+            const bool switch_due = transport_changed && (scheduled_switch_time == 0 || nmos_tools::get_tai_time() >= scheduled_switch_time);
+
+            if (transport_changed && !options.make_before_break && switch_due)
+               break;
+
+            if (options.make_before_break && retiring_stream == nullptr)
+            {
+               //The stream is built for the activated parameters, or ahead of time for those of a staged scheduled activation.
+               const nmos_tools::NodeServerSender::TransportLegs* target_transport_params = transport_changed ? &activation_state.active_transport_params
+                  : (activation_state.staged_activation_time != 0 && memcmp(&previous_transport_params, &activation_state.staged_transport_params, sizeof(nmos_tools::NodeServerSender::TransportLegs)) != 0) ? &activation_state.staged_transport_params
+                  : nullptr;
+
+               if (replacement_build.valid() && replacement_build.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+               {
+                  replacement = replacement_build.get();
+                  if (replacement.result != VMIPERR_NOERROR)
+                  {
+                     stream_result = replacement.result;
+                     break;
+                  }
+               }
+
+               if (replacement.stream && (target_transport_params == nullptr || memcmp(&replacement.transport_params, target_transport_params, sizeof(nmos_tools::NodeServerSender::TransportLegs)) != 0))
+                  drop_replacement();
+
+               if (!replacement.stream && !replacement_build.valid() && target_transport_params != nullptr)
+               {
+                  const nmos_tools::NodeServerSender::TransportLegs transport_params = *target_transport_params;
+                  replacement_build = std::async(std::launch::async, [&context, &sender_stream, &stream_name, transport_params]()
+                  {
+                     ReplacementStream replacement_stream;
+                     replacement_stream.transport_params = transport_params;
+                     replacement_stream.result = build_sender_stream(context, sender_stream, transport_params, stream_name, replacement_stream.stream, replacement_stream.sdp);
+                     return replacement_stream;
+                  });
+               }
+
+               if (replacement.stream && switch_due)
+               {
+                  stream_result = VMIP_StartStream(replacement.stream);
+                  if (stream_result != VMIPERR_NOERROR)
+                  {
+                     std::cout << std::endl << stream_name << "Error when starting stream" << " [" << to_string(stream_result) << "]" << std::endl;
+                     drop_replacement();
+                     break;
+                  }
+
+                  //The slot period is measured on the previous stream, before the swap.
+                  slot_period = measure_slot_period();
+
+                  //The next slot is locked on the replacement, between two slots of the previous stream.
+                  end_monitoring();
+                  retiring_stream = sender_stream.stream;
+                  sender_stream.stream = replacement.stream;
+                  sdp = replacement.sdp;
+                  previous_transport_params = replacement.transport_params;
+                  replacement = ReplacementStream();
+                  std::atomic_store(&overlay_identity, make_overlay_identity());
+                  //The tracker of the render-ahead ring follows its frames, which are not changed by the swap.
+                  if (slot_tracker && !render_ahead)
+                     slot_tracker->reset();
+                  std::cout << std::endl << stream_name << "Generated Sdp : " << std::endl << sdp << std::endl;
+                  start_monitoring();
+               }
+            }
+
+            //Try to lock the next slot.
+            stream_result = VMIP_LockSlot(sender_stream.stream, &slot);
+            deadline_monitor->slot_locked();
+
+            if (stream_result != VMIPERR_NOERROR)
+            {
+               std::cout << std::endl << stream_name << "Error when locking slot at slot " << sender_stream.index << " [" << to_string(stream_result) << "]" << std::endl;
+               break;
+            }
+
+            //Get the video or audio buffer associated to the slot.
+            stream_result = VMIP_GetSlotBuffer(sender_stream.stream, slot, sender_stream.audio_source ? VMIP_ST2110_30_BT_AUDIO : VMIP_ST2110_20_BT_VIDEO, &buffer, &buffer_size);
+            if (stream_result != VMIPERR_NOERROR)
+            {
+               std::cout << std::endl << stream_name << "Error when getting slot buffer at slot " << sender_stream.index << " [" << to_string(stream_result) << "]" << std::endl;
+            }
+
+            //Audio : the samples of the slot are generated and packed in batches straight into it.
+            //The period of the audio slots follows from the samples they hold.
+            if (sender_stream.audio_source)
+            {
+               if (deadline_monitor->slot_period() == 0 && buffer_size != 0)
+                  deadline_monitor->set_slot_period(static_cast<uint64_t>(buffer_size) / (sender_stream.audio_source->get_channel_count() * pcm24_sample_size) * 1000000000ull / audio_sample_rate);
+               sender_stream.audio_source->render(buffer, buffer_size);
+            }
+            else if (render_ahead)
+            {
+               //Render-ahead : the slot only receives a copy of the oldest frame rendered ahead, or of the previous one if the ring ran dry.
+               const uint8_t* frame = render_ahead->next_frame();
+               if (frame)
+                  copy_frame(buffer, frame, std::min<size_t>(buffer_size, render_ahead->frame_size()));
+            }
+            else
+               render_frame(sender_stream.index, buffer, buffer_size);
+            deadline_monitor->slot_rendered();
+            
+            //Unlock the slot. pBuffer wont be available anymore
+            stream_result = VMIP_UnlockSlot(sender_stream.stream, slot);
+            deadline_monitor->slot_unlocked();
+
+            if (stream_result != VMIPERR_NOERROR)
+            {
+               std::cout << std::endl << stream_name << "Error when unlocking slot at slot " << sender_stream.index << " [" << to_string(stream_result) << "]" << std::endl;
+               break;
+            }         
+
+            sender_stream.index++;
+            const std::chrono::steady_clock::time_point slot_unlocked = std::chrono::steady_clock::now();
+
+            //The first slot of the new stream is queued : the previous stream can be stopped.
+            if (retiring_stream)
+            {
+               VMIP_StopStream(retiring_stream);
+               VMIP_DestroyStream(retiring_stream);
+               retiring_stream = nullptr;
+               end_reconfiguration("make-before-break", slot_unlocked);
+            }
+            else if (reconfiguring)
+               end_reconfiguration("break-before-make", slot_unlocked);
+            last_slot_unlocked = slot_unlocked;
+         }
+
+         //A replacement still being built or waiting for its time when the transmission stops is dropped.
+         if (replacement_build.valid())
+            replacement = replacement_build.get();
+         drop_replacement();
+         if (retiring_stream)
+         {
+            VMIP_StopStream(retiring_stream);
+            VMIP_DestroyStream(retiring_stream);
+         }
+
+         //The thread sleeps in VMIP_LockSlot until the next slot is due : its CPU time is the cost of the stream on the transmission side.
+         sender_stream.cpu_time += get_thread_cpu_time() - start_cpu_time;
+         sender_stream.transmission_time += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+
+         end_monitoring();
+
+         if (render_ahead)
+         {
+            render_ahead->stop();
+            const RenderAheadStatistics& render_ahead_statistics = render_ahead->get_statistics();
+            const uint64_t requests = render_ahead_statistics.frames_taken + render_ahead_statistics.dry_ring;
+            if (requests != 0)
+               std::cout << stream_name << "Render ahead : " << render_ahead_statistics.frames_rendered << " frames rendered, " << render_ahead_statistics.minimum_queued_frames << " min / "
+                  << render_ahead_statistics.total_queued_frames / requests << " avg / " << render_ahead_statistics.maximum_queued_frames << " max frames queued ahead, ring ran dry "
+                  << render_ahead_statistics.dry_ring << " times" << std::endl;
+         }
+
+         if (slot_tracker)
+            std::cout << stream_name << "Slot updates : " << slot_tracker->get_statistics().delta_updates << " delta, " << slot_tracker->get_statistics().full_copies
+               << " full copies, " << slot_tracker->get_statistics().bytes_written / (1024 * 1024) << " MiB written" << std::endl;
+
+         //Break-before-make : the output gap runs from the last slot of this stream to the first slot of the reconfigured stream.
+         reconfiguring = activation_state.is_enabled && !exit && stream_result == VMIPERR_NOERROR;
+         if (reconfiguring)
+            slot_period = measure_slot_period();
+         else
+            scheduled_switch_time = 0;
+         
+         VMIP_ERRORCODE result_stop_stream; //temporary variable to not overwrite result if an error occured in the transmission loop
+
+         result_stop_stream = VMIP_StopStream(sender_stream.stream);
+         if (result_stop_stream != VMIPERR_NOERROR)
+         {
+            std::cout << stream_name << "Error when stopping the stream"<< " [" << to_string(result_stop_stream) << "]" << std::endl;
+            stream_result = result_stop_stream;
+         }
+         context.transmitting_streams--;
+      }
+   }
+
+   //As with a single stream, an error stops the sample.
+   sender_stream.result = stream_result;
+   if (stream_result != VMIPERR_NOERROR)
+      exit = true;
+}
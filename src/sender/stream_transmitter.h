@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file stream_transmitter.h
+   @brief This file contains the transmission of the streams of the sender, each by a thread of its own.
+
+   The main thread parses the options, renders the patterns and brings up VMIP and the NMOS node. The state it then
+   shares with the transmission threads is gathered in a SenderContext : each thread builds, starts and transmits its
+   stream, rebuilding it when the NMOS sender is given new transport parameters or the video format is switched.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../tools.h"
+#include "../nmos_tools.h"
+#include "pattern_engine.h"
+#include "frame_ring.h"
+#include "frame_source.h"
+#include "audio_source.h"
+#include "text_overlay.h"
+#include "video_file.h"
+#include "render_ahead.h"
+#include "quad_link_source.h"
+#include "deadline_monitor.h"
+
+#include <videomasterip/videomasterip_core.h>
+#include <videomasterip/videomasterip_stream.h>
+
+/*!
+   @brief Parameters of the sender that can be changed on the command line.
+*/
+struct SenderOptions
+{
+   PatternType pattern = PatternType::color_bar; /*! Transmitted test pattern */
+   uint32_t animation_frames = 60; /*! Length of the pre-rendered animation of the animated patterns, in frames */
+   uint32_t pattern_memory_mb = 1024; /*! Maximum memory used by the pre-rendered animation, in MiB */
+   VMIP_VIDEO_STANDARD video_standard = VMIP_VIDEO_STANDARD_1920X1080P30; /*! Streaming video standard */
+   std::vector<VMIP_VIDEO_STANDARD> video_standards; /*! Video standards the video streams can be switched to at runtime, starting on the first one. Only video_standard if not given */
+   VMIP_VIDEO_SAMPLING video_sampling = VMIP_VIDEO_SAMPLING_YCBCR_422; /*! Streaming video sampling */
+   VMIP_VIDEO_DEPTH video_depth = VMIP_VIDEO_DEPTH_10BIT; /*! Streaming video depth */
+   uint32_t render_threads = 1; /*! Number of threads rendering and copying frames, the transmission thread included */
+   std::vector<uint32_t> render_cpu_core_os_ids; /*! CPU cores of the rendering workers. If empty, they are chosen among the cores not used by VMIP */
+   bool frame_signature = false; /*! Stamp each frame with a sequence number and the CRC32C of its content, in the first line */
+   std::string video_file_path; /*! Raw video file played out in place of the test pattern. If empty, the pattern is transmitted */
+   VideoFileFormat video_file_format = VideoFileFormat::pgroup; /*! Layout of the frames in the video file */
+   bool text_overlay = false; /*! Burn the device name, the destination, the frame counter and the PTP time into the picture */
+   bool direct_render = false; /*! Render the animated patterns straight into each frame instead of pre-rendering them */
+   uint32_t render_ahead_frames = 0; /*! Frames of the render-ahead ring filled by a producer thread, 0 to render in the slots */
+   int32_t render_ahead_cpu_core_os_id = -1; /*! CPU core of the render-ahead producers. If negative, cores not used by VMIP nor by the rendering workers */
+   uint32_t stream_count = 1; /*! Number of streams sent by the device, each with its own VMIP stream and NMOS sender */
+   bool quad_link = false; /*! Send the frames of the video standard as four links of a quarter of its size, with two-sample interleave (2SI) */
+   std::vector<uint32_t> processing_cpu_core_os_ids; /*! VMIP processing CPU cores, one per stream, reused in turn if there are fewer cores than streams. If empty, they are chosen among the cores not used by VMIP */
+   uint32_t audio_channel_count = 0; /*! Channels of the ST2110-30 audio stream sent along the video streams, 0 to send no audio */
+   AudioPacketTime audio_packet_time = AudioPacketTime::packet_1ms; /*! Duration of the samples of an audio packet */
+   AudioSignal audio_signal = AudioSignal::tone; /*! Signal sent on the audio channels */
+   std::string redundant_media_nic_name; /*! Second streaming NIC, sending the same packets as the first one on a path of its own (ST2022-7). If empty, a single path is sent */
+   bool make_before_break = false; /*! On new transport parameters, build the new stream while the current one keeps transmitting, instead of stopping it first */
+   std::string deadline_dump_path; /*! JSON file receiving the slot deadline statistics of every stream on exit. If empty, they are only summarized */
+};
+
+/*!
+   @brief Video format the video streams can be switched to, with its patterns rendered at startup.
+*/
+struct VideoFormat
+{
+   VMIP_VIDEO_STANDARD video_standard = VMIP_VIDEO_STANDARD_1920X1080P30; /*! Video standard of the format */
+   uint32_t frame_width = 0; /*! Width of the frames, in pixels */
+   uint32_t frame_height = 0; /*! Height of the frames, in lines */
+   uint32_t frame_rate = 0; /*! Frame rate, divided by 1.001 if is_us is set */
+   bool interlaced = false; /*! The frames hold two fields */
+   bool is_us = false; /*! The frame rate is a US rate, divided by 1.001 */
+   std::unique_ptr<PatternEngine> pattern_engine; /*! Patterns packed in the format */
+   std::unique_ptr<FrameRing> frame_ring; /*! Pre-rendered frames of the animated pattern, if any */
+   std::unique_ptr<TextOverlay> text_overlay; /*! Glyphs packed in the format, if the overlay is enabled */
+   VMIP_VIDEO_STANDARD stream_standard = VMIP_VIDEO_STANDARD_1920X1080P30; /*! Video standard of the video streams : the format itself, or a quarter of it for the links of a quad-link */
+   std::unique_ptr<PatternEngine> link_engine; /*! Layout of the frames of the links, for a quad-link */
+   std::unique_ptr<QuadLinkSplitter> quad_link; /*! Frames of the format split for the four links, for a quad-link */
+   std::string name; /*! Name of the video standard of the format, for the messages */
+   std::string stream_name; /*! Name of the video standard of the video streams, for the messages */
+
+   /*!
+      @brief Gives the layout of the frames sent by each video stream.
+   */
+   const PatternEngine& stream_engine() const { return link_engine ? *link_engine : *pattern_engine; }
+};
+
+/*!
+   @brief State of one of the streams sent by the device, transmitted by a thread of its own.
+*/
+struct SenderStream
+{
+   HANDLE stream = nullptr; /*! VMIP stream */
+   std::vector<uint32_t> processing_cpu_core_os_id; /*! IPVC Processing CPU core indexes list of the stream */
+   uint32_t destination_ssrc = 0; /*! SSRC of the stream */
+   std::vector<std::unique_ptr<FrameSource>> frame_sources; /*! Source of the frames in each video format, with a slot tracker of its own. Empty for the audio stream */
+   FrameSource* frame_source = nullptr; /*! Source of the frames in the current video format. Not set for the audio stream */
+   uint32_t format_index = 0; /*! Current video format of the stream */
+   std::unique_ptr<AudioSource> audio_source; /*! Source of the samples, set for the audio stream only */
+   std::unique_ptr<DeadlineMonitor> deadline_monitor; /*! Time spent on each slot against the slot period */
+   std::unique_ptr<RenderAheadRing> render_ahead; /*! Frames rendered ahead of the slots, if enabled */
+   int32_t render_ahead_cpu_core_os_id = -1; /*! CPU core of the render-ahead producer, -1 to leave it unpinned */
+   uint64_t index = 0; /*! Frame counter, carried on from one run of the stream to the next */
+   uint64_t cpu_time = 0; /*! CPU time of the transmission thread while transmitting, in nanoseconds */
+   uint64_t transmission_time = 0; /*! Time spent transmitting, in nanoseconds */
+   uint32_t reconfigurations = 0; /*! Changes of transport parameters applied while the stream was enabled */
+   uint64_t reconfiguration_missed_frames = 0; /*! Frames missed on air over all the reconfigurations */
+   uint64_t max_reconfiguration_missed_frames = 0; /*! Frames missed on air by the worst reconfiguration */
+   uint32_t scheduled_activations = 0; /*! Reconfigurations scheduled by the activation on a frame boundary */
+   int64_t max_switch_error = 0; /*! Largest error between the frame boundary of a scheduled activation and the switch of the stream, in nanoseconds */
+   VMIP_ERRORCODE result = VMIPERR_NOERROR; /*! Error that stopped the transmission thread */
+   std::thread thread; /*! Transmission thread */
+};
+
+/*!
+   @brief State of the sender shared by the main thread and the transmission threads.
+*/
+struct SenderContext
+{
+   const SenderOptions* options = nullptr; /*! Options of the sender */
+   HANDLE vcs_context = nullptr; /*! Context of the VCS session */
+   VMIP_STREAMTYPE stream_type = VMIP_ST_TX; /*! Type of the streams */
+   std::vector<uint64_t> media_nic_ids; /*! Ids of the streaming NICs, one per path */
+   uint64_t conductor_id = (uint64_t)-1; /*! Conductor shared by all the streams */
+   uint32_t management_thread_cpu_core_os_id = 0; /*! CPU core of the VMIP management thread */
+   std::string device_name; /*! Name of the NMOS device, shown by the overlay */
+   std::vector<VideoFormat> video_formats; /*! Video formats the video streams can be switched to */
+   std::vector<SenderStream> sender_streams; /*! Streams of the device, the audio stream following the video streams */
+   std::vector<nmos_tools::NodeServerSender::Sender> nmos_senders; /*! NMOS senders, one per stream */
+   nmos_tools::NodeServerSender* node_server = nullptr; /*! NMOS node, set before the transmission threads are started */
+   std::atomic<bool> exit{false}; /*! Stops the transmission threads */
+   std::atomic<uint32_t> transmitting_streams{0}; /*! Streams currently started */
+   std::atomic<uint32_t> requested_format_index{0}; /*! Video format the video streams are switched to */
+};
+
+/*!
+   @brief Period of the frames of a video format
+
+   @returns The period in nanoseconds
+*/
+uint64_t get_frame_period(const VideoFormat& format /*!< [in] Video format */);
+
+/*!
+   @brief Creates and configures a stream of the device toward the transport parameters its NMOS sender resolved, at startup.
+   The network and essence configs of the stream and its SDP are stored in the NMOS sender.
+
+   @returns The function returns the status of its execution as VMIP_ERRORCODE
+*/
+VMIP_ERRORCODE create_sender_stream(SenderContext& context /*!< [in,out] State of the sender */
+                                    , uint32_t stream_index /*!< [in] Index of the stream and of its NMOS sender */
+);
+
+/*!
+   @brief Transmits a stream each time its NMOS sender is enabled, until exit is requested. Runs on a thread of its own per stream.
+   An error stops the sample, and is left in the result of the stream.
+*/
+void transmit_stream(SenderContext& context /*!< [in,out] State of the sender */
+                     , uint32_t stream_index /*!< [in] Index of the stream and of its NMOS sender */
+);
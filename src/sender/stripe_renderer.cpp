@@ -0,0 +1,190 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stripe_renderer.h"
+#include "../frame_copy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+//Below this size, splitting a copy costs more than it saves.
+constexpr size_t minimum_copy_chunk_size = 256 * 1024;
+
+bool pin_thread(std::thread& thread, uint32_t cpu_core_os_id)
+{
+#if defined(_WIN32)
+   return SetThreadAffinityMask(thread.native_handle(), static_cast<DWORD_PTR>(1) << cpu_core_os_id) != 0;
+#elif defined(__linux__)
+   cpu_set_t cpu_set;
+   CPU_ZERO(&cpu_set);
+   CPU_SET(cpu_core_os_id, &cpu_set);
+   return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+   (void)thread;
+   (void)cpu_core_os_id;
+   return false;
+#endif
+}
+
+uint64_t get_thread_cpu_time()
+{
+#if defined(_WIN32)
+   FILETIME creation_time, exit_time, kernel_time, user_time;
+   if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+      return 0;
+   //FILETIME counts 100 ns intervals.
+   const uint64_t kernel = (static_cast<uint64_t>(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+   const uint64_t user = (static_cast<uint64_t>(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+   return (kernel + user) * 100;
+#else
+   timespec time;
+   if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+      return 0;
+   return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+#endif
+}
+
+StripeRenderer::StripeRenderer(const std::vector<uint32_t>& worker_cpu_core_os_ids)
+   : job({nullptr, 0, 0, 0}), stopping(false)
+{
+   for (uint32_t i = 0; i < worker_cpu_core_os_ids.size(); i++)
+   {
+      //Stripe 0 belongs to the calling thread.
+      workers.emplace_back(&StripeRenderer::worker_loop, this, i + 1);
+      if (!pin_thread(workers.back(), worker_cpu_core_os_ids[i]))
+         std::cout << "Could not pin the rendering worker " << i << " on CPU core " << worker_cpu_core_os_ids[i] << std::endl;
+   }
+}
+
+StripeRenderer::~StripeRenderer()
+{
+   {
+      std::lock_guard<std::mutex> lock(job_mutex);
+      stopping = true;
+   }
+   job_available.notify_all();
+
+   for (std::thread& worker : workers)
+      worker.join();
+}
+
+void StripeRenderer::stripe_bounds(uint32_t stripe_index, uint32_t line_count, uint32_t& first_line, uint32_t& stripe_line_count) const
+{
+   //The remaining lines are spread on the first stripes, so that stripe sizes differ by one line at most.
+   const uint32_t stripes = thread_count();
+   const uint32_t base_lines = line_count / stripes;
+   const uint32_t extra_lines = line_count % stripes;
+
+   first_line = stripe_index * base_lines + std::min(stripe_index, extra_lines);
+   stripe_line_count = base_lines + (stripe_index < extra_lines ? 1 : 0);
+}
+
+void StripeRenderer::run(uint32_t line_count, const StripeFunction& stripe_function)
+{
+   if (workers.empty() || line_count < thread_count())
+   {
+      if (line_count != 0)
+         stripe_function(0, line_count);
+      return;
+   }
+
+   //The workers process one job at a time : the jobs of the threads sharing the pool are processed one after the other.
+   std::lock_guard<std::mutex> run_lock(run_mutex);
+
+   {
+      std::lock_guard<std::mutex> lock(job_mutex);
+      job.stripe_function = &stripe_function;
+      job.line_count = line_count;
+      job.generation++;
+      job.pending_stripes = static_cast<uint32_t>(workers.size());
+   }
+   job_available.notify_all();
+
+   uint32_t first_line = 0, stripe_line_count = 0;
+   stripe_bounds(0, line_count, first_line, stripe_line_count);
+   stripe_function(first_line, stripe_line_count);
+
+   std::unique_lock<std::mutex> lock(job_mutex);
+   job_done.wait(lock, [this]() { return job.pending_stripes == 0; });
+   job.stripe_function = nullptr;
+}
+
+void StripeRenderer::copy(uint8_t* destination, const uint8_t* source, size_t size)
+{
+   const uint32_t chunks = (size >= thread_count() * minimum_copy_chunk_size) ? thread_count() : 1;
+   //Chunks start on cache line boundaries, so that the non-temporal stores of a chunk never share a line with another chunk.
+   const size_t chunk_size = ((size + chunks - 1) / chunks + 63) / 64 * 64;
+
+   run(chunks, [=](uint32_t first_chunk, uint32_t chunk_count) {
+      const size_t begin = std::min(first_chunk * chunk_size, size);
+      const size_t end = std::min((first_chunk + chunk_count) * chunk_size, size);
+      copy_frame(destination + begin, source + begin, end - begin);
+   });
+}
+
+void StripeRenderer::worker_loop(uint32_t stripe_index)
+{
+   uint64_t done_generation = 0;
+
+   while (true)
+   {
+      const StripeFunction* stripe_function = nullptr;
+      uint32_t line_count = 0;
+      {
+         std::unique_lock<std::mutex> lock(job_mutex);
+         job_available.wait(lock, [this, done_generation]() { return stopping || job.generation != done_generation; });
+         if (stopping)
+            return;
+
+         stripe_function = job.stripe_function;
+         line_count = job.line_count;
+         done_generation = job.generation;
+      }
+
+      uint32_t first_line = 0, stripe_line_count = 0;
+      stripe_bounds(stripe_index, line_count, first_line, stripe_line_count);
+      if (stripe_line_count != 0)
+         (*stripe_function)(first_line, stripe_line_count);
+
+      {
+         std::lock_guard<std::mutex> lock(job_mutex);
+         job.pending_stripes--;
+      }
+      job_done.notify_one();
+   }
+}
+
+std::vector<uint32_t> StripeRenderer::select_cpu_cores(const std::vector<uint32_t>& excluded_cpu_core_os_ids, uint32_t max_count)
+{
+   std::vector<uint32_t> cpu_core_os_ids;
+   const uint32_t core_count = std::thread::hardware_concurrency();
+
+   for (uint32_t core = 0; core < core_count && cpu_core_os_ids.size() < max_count; core++)
+   {
+      if (std::find(excluded_cpu_core_os_ids.begin(), excluded_cpu_core_os_ids.end(), core) == excluded_cpu_core_os_ids.end())
+         cpu_core_os_ids.push_back(core);
+   }
+
+   return cpu_core_os_ids;
+}
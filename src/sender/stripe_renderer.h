@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file stripe_renderer.h
+   @brief This file contains a pool of worker threads splitting the rendering and the copy of frames in bands of lines.
+
+   At UHD and higher resolutions a single core cannot generate and copy frames within the frame period. The frame is
+   split in stripes of consecutive lines, each stripe being processed by a worker pinned to its own CPU core. The calling
+   thread processes the first stripe itself and returns once every stripe is done.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+   @brief Pins a thread on a CPU core.
+
+   @returns false if the thread could not be pinned, or if pinning is not supported on this system.
+*/
+bool pin_thread(std::thread& thread /*!< [in] Thread to pin.*/
+   , uint32_t cpu_core_os_id /*!< [in] OS index of the CPU core.*/
+);
+
+/*!
+   @brief Gives the CPU time used by the calling thread so far, to measure the cost of a loop.
+
+   @returns the CPU time in nanoseconds, 0 if it is not available.
+*/
+uint64_t get_thread_cpu_time();
+
+class StripeRenderer
+{
+public:
+
+   /*!
+      @brief Function processing a stripe of lines [first_line, first_line + line_count).
+   */
+   typedef std::function<void(uint32_t first_line, uint32_t line_count)> StripeFunction;
+
+   StripeRenderer(const std::vector<uint32_t>& worker_cpu_core_os_ids /*!< [in] CPU cores on which the workers are pinned, one worker per core.
+                                                                                An empty list renders everything on the calling thread.*/
+   );
+   ~StripeRenderer();
+
+   StripeRenderer(const StripeRenderer&) = delete;
+   StripeRenderer& operator=(const StripeRenderer&) = delete;
+
+   /*!
+      @brief Splits line_count lines in stripes, one per worker plus one for the calling thread, and waits until all of them are processed.
+      Several threads may share the renderer, their calls being processed one after the other.
+   */
+   void run(uint32_t line_count /*!< [in] Number of lines to split.*/
+      , const StripeFunction& stripe_function /*!< [in] Function called once per non-empty stripe, possibly from several threads at once.*/
+   );
+
+   /*!
+      @brief Copies a buffer, split in as many chunks as there are stripes.
+   */
+   void copy(uint8_t* destination /*!< [out] Destination buffer.*/
+      , const uint8_t* source /*!< [in] Source buffer.*/
+      , size_t size /*!< [in] Number of bytes to copy.*/
+   );
+
+   /*!
+      @brief Gives the number of threads processing stripes, the calling thread included.
+   */
+   uint32_t thread_count() const { return static_cast<uint32_t>(workers.size()) + 1; }
+
+   /*!
+      @brief Selects the cores on which the workers may be pinned : every core of the system except the excluded ones
+      (the conductor, processing and management cores), limited to max_count cores.
+   */
+   static std::vector<uint32_t> select_cpu_cores(const std::vector<uint32_t>& excluded_cpu_core_os_ids /*!< [in] Cores that are already busy.*/
+      , uint32_t max_count /*!< [in] Maximum number of cores to select.*/
+   );
+
+private:
+
+   //Work handed to the workers. A new generation is started by each call to run.
+   struct Job
+   {
+      const StripeFunction* stripe_function;
+      uint32_t line_count;
+      uint64_t generation;
+      uint32_t pending_stripes;
+   };
+
+   void worker_loop(uint32_t stripe_index);
+   void stripe_bounds(uint32_t stripe_index, uint32_t line_count, uint32_t& first_line, uint32_t& stripe_line_count) const;
+
+   std::vector<std::thread> workers;
+   std::mutex run_mutex; /*! Held by the thread whose job is processed */
+   std::mutex job_mutex;
+   std::condition_variable job_available;
+   std::condition_variable job_done;
+   Job job;
+   bool stopping;
+};
@@ -0,0 +1,162 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "text_overlay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+constexpr uint16_t text_luma = 0x3AC; /*! 10 bits luma of the characters */
+constexpr uint16_t background_luma = 0x40; /*! 10 bits luma of the box behind the characters */
+constexpr uint16_t neutral_chroma = 0x200; /*! 10 bits chroma of both, white and black having no chroma */
+constexpr uint32_t font_width = 5; /*! Width of a glyph of the font */
+constexpr uint32_t font_height = 7; /*! Height of a glyph of the font */
+constexpr uint32_t cell_font_width = font_width + 1; /*! Glyph and spacing on the right, in font pixels */
+constexpr uint32_t cell_font_height = font_height + 2; /*! Glyph and spacing above and below, in font pixels */
+
+/*!
+   @brief Glyph of the 5x7 font. Each row is 5 bits wide, the most significant bit being the leftmost pixel.
+*/
+struct FontGlyph
+{
+   char character;
+   uint8_t rows[font_height];
+};
+
+//The first glyph is the one drawn for the characters missing from the font.
+static const FontGlyph font[] = {
+   { '?', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 } },
+   { ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+   { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+   { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+   { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+   { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+   { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+   { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+   { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+   { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+   { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+   { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+   { 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+   { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+   { 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+   { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+   { 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+   { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+   { 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+   { 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+   { 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+   { 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+   { 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+   { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+   { 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+   { 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+   { 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+   { 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+   { 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+   { 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+   { 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+   { 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+   { 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+   { 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+   { 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+   { 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+   { 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+   { 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+   { ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+   { '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+   { '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+   { '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+   { '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+};
+
+constexpr uint32_t font_glyph_count = sizeof(font) / sizeof(font[0]);
+
+TextOverlay::TextOverlay(const PatternEngine& engine) : engine(engine), glyph_width(0), glyph_height(0), glyph_row_size(0)
+{
+   //Characters are about 1/40 of the frame height, and each cell holds a whole number of pgroups.
+   const uint32_t scale = std::max(engine.frame_height() / 270, 1u);
+   const uint32_t pgroup_pixels = engine.pgroup_pixels();
+   glyph_width = (cell_font_width * scale + pgroup_pixels - 1) / pgroup_pixels * pgroup_pixels;
+   glyph_height = cell_font_height * scale;
+   glyph_row_size = glyph_width / pgroup_pixels * engine.pgroup_size();
+
+   glyph_ids.fill(0);
+   for (uint32_t glyph = 0; glyph < font_glyph_count; glyph++)
+   {
+      const char character = font[glyph].character;
+      glyph_ids[static_cast<uint8_t>(character)] = static_cast<uint8_t>(glyph);
+      if (character >= 'A' && character <= 'Z')
+         glyph_ids[static_cast<uint8_t>(character - 'A' + 'a')] = static_cast<uint8_t>(glyph);
+   }
+
+   //Each glyph is packed row by row, the glyph being horizontally centered in its cell.
+   const uint32_t left_margin = (glyph_width - font_width * scale) / 2;
+   std::vector<uint16_t> y(glyph_width), cb(glyph_width / 2 + 1, neutral_chroma), cr(glyph_width / 2 + 1, neutral_chroma);
+   atlas.resize(static_cast<size_t>(font_glyph_count) * glyph_height * glyph_row_size);
+
+   for (uint32_t glyph = 0; glyph < font_glyph_count; glyph++)
+   {
+      for (uint32_t row = 0; row < glyph_height; row++)
+      {
+         const uint32_t font_row = row / scale;
+         const uint8_t bits = (font_row >= 1 && font_row <= font_height) ? font[glyph].rows[font_row - 1] : 0;
+
+         for (uint32_t x = 0; x < glyph_width; x++)
+         {
+            const uint32_t font_x = (x >= left_margin) ? (x - left_margin) / scale : font_width;
+            y[x] = (font_x < font_width && (bits & (0x10 >> font_x))) ? text_luma : background_luma;
+         }
+
+         engine.pack_samples(y.data(), cb.data(), cr.data(), glyph_width, atlas.data() + (static_cast<size_t>(glyph) * glyph_height + row) * glyph_row_size);
+      }
+   }
+}
+
+void TextOverlay::draw(uint8_t* buffer, uint32_t x, uint32_t line, const char* text, SlotTracker* tracker) const
+{
+   if (buffer == nullptr || text == nullptr)
+   {
+      std::cout << std::endl << "The  buffer or text pointer is invalid" << std::endl;
+      return;
+   }
+
+   const uint32_t first_pgroup = x / engine.pgroup_pixels();
+   const uint32_t line_pgroups = engine.frame_width() / engine.pgroup_pixels();
+   const uint32_t glyph_pgroups = glyph_width / engine.pgroup_pixels();
+   if (first_pgroup >= line_pgroups || line >= engine.frame_height())
+      return;
+
+   const size_t visible_glyphs = std::min<size_t>(std::strlen(text), (line_pgroups - first_pgroup) / glyph_pgroups);
+   const uint32_t last_line = std::min(line + glyph_height, engine.frame_height());
+   const size_t x_offset = static_cast<size_t>(first_pgroup) * engine.pgroup_size();
+
+   //Rows are written line after line, so that the destination is walked in order whatever the field layout.
+   for (uint32_t picture_line = line; picture_line < last_line; picture_line++)
+   {
+      uint8_t* destination = buffer + engine.line_offset(picture_line) + x_offset;
+      const uint8_t* glyph_rows = atlas.data() + static_cast<size_t>(picture_line - line) * glyph_row_size;
+      for (size_t i = 0; i < visible_glyphs; i++)
+      {
+         const uint8_t character = static_cast<uint8_t>(text[i]);
+         const uint32_t glyph = (character < glyph_ids.size()) ? glyph_ids[character] : 0;
+         std::memcpy(destination + i * glyph_row_size, glyph_rows + static_cast<size_t>(glyph) * glyph_height * glyph_row_size, glyph_row_size);
+      }
+
+      if (tracker)
+         tracker->mark_dirty(buffer, picture_line);
+   }
+}
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file text_overlay.h
+   @brief This file contains the burnt-in text overlay of the sender.
+
+   Every glyph of a 5x7 font is rasterized once, scaled to the frame height and packed in the format of the stream
+   in a glyph atlas. Drawing a text then only copies the packed rows of its glyphs into the frame buffer,
+   white characters on a black background, so that the overlay can be redrawn on every frame.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <array>
+#include <vector>
+
+#include "pattern_engine.h"
+#include "slot_tracker.h"
+
+class TextOverlay
+{
+public:
+
+   TextOverlay(const PatternEngine& engine /*!< [in] Engine giving the format and the layout of the frames. Must outlive the overlay.*/);
+
+   /*!
+      @brief Draws a line of text. Lowercase letters are drawn in uppercase, characters missing from the font as '?'.
+      The text is clipped to the frame.
+   */
+   void draw(uint8_t* buffer /*!< [in,out] Frame buffer of engine.frame_size() bytes.*/
+      , uint32_t x /*!< [in] Left position of the text in pixels, rounded down to a pgroup boundary.*/
+      , uint32_t line /*!< [in] Top line of the text in the picture.*/
+      , const char* text /*!< [in] Null terminated text.*/
+      , SlotTracker* tracker = nullptr /*!< [in] If set, the picture lines drawn over are marked dirty for the buffer.*/
+   ) const;
+
+   uint32_t cell_width() const { return glyph_width; } /*! Width of a character in pixels */
+   uint32_t cell_height() const { return glyph_height; } /*! Height of a line of text in picture lines */
+
+private:
+
+   const PatternEngine& engine;
+   uint32_t glyph_width;
+   uint32_t glyph_height;
+   uint32_t glyph_row_size;
+   std::vector<uint8_t> atlas; /*! Packed rows of every glyph, glyph after glyph */
+   std::array<uint8_t, 128> glyph_ids; /*! Glyph of each ASCII character */
+};
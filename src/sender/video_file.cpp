@@ -0,0 +1,287 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "video_file.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+constexpr uint32_t readahead_frames = 4; /*! Number of frames of a memory mapped file read ahead of the transmitted one */
+constexpr size_t frame_alignment = 4096; /*! Converted frames start on page boundaries in the arena */
+
+bool parse_video_file_format(const std::string& name, VideoFileFormat& format)
+{
+   for (VideoFileFormat candidate : { VideoFileFormat::pgroup, VideoFileFormat::yuv422p10le })
+   {
+      if (name == to_string(candidate))
+      {
+         format = candidate;
+         return true;
+      }
+   }
+   return false;
+}
+
+std::string to_string(VideoFileFormat format)
+{
+   std::string result = "Undefined";
+
+   switch (format)
+   {
+   case VideoFileFormat::pgroup: result = "pgroup"; break;
+   case VideoFileFormat::yuv422p10le: result = "yuv422p10le"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+VideoFile::VideoFile(const PatternEngine& engine) : engine(engine), mapping(nullptr), mapping_size(0), page_size(4096),
+#if defined(_WIN32)
+   file_handle(INVALID_HANDLE_VALUE), mapping_handle(nullptr),
+#else
+   file_descriptor(-1),
+#endif
+   frame_stride(0), frames(0)
+{
+#if !defined(_WIN32)
+   page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+VideoFile::~VideoFile()
+{
+   close();
+}
+
+bool VideoFile::open(const std::string& path, VideoFileFormat format, size_t memory_budget, StripeRenderer* renderer)
+{
+   close();
+
+   //The geometry comes from VMIP_GetVideoStandardInfo, through the engine.
+   const size_t file_frame_size = (format == VideoFileFormat::pgroup) ? engine.frame_size()
+      : static_cast<size_t>(engine.frame_width()) * engine.frame_height() * 2 * sizeof(uint16_t);
+   if (file_frame_size == 0)
+      return false;
+
+   if (!map(path))
+      return false;
+
+   if (mapping_size % file_frame_size != 0 || mapping_size / file_frame_size == 0)
+   {
+      std::cout << "The size of " << path << " (" << mapping_size << " bytes) is not a whole number of " << engine.frame_width() << "x"
+         << engine.frame_height() << " " << to_string(format) << " frames (" << file_frame_size << " bytes)" << std::endl;
+      close();
+      return false;
+   }
+
+   const uint32_t file_frames = static_cast<uint32_t>(std::min<size_t>(mapping_size / file_frame_size, UINT32_MAX));
+
+   if (format == VideoFileFormat::pgroup)
+   {
+      frame_stride = file_frame_size;
+      frames = file_frames;
+      return true;
+   }
+
+   //Planar frames are converted once, the file is not needed anymore afterwards.
+   const bool converted = convert_planar_frames(file_frame_size, memory_budget, renderer);
+   unmap();
+   if (!converted)
+      close();
+   return converted;
+}
+
+void VideoFile::close()
+{
+   unmap();
+   arena.release();
+   frame_stride = 0;
+   frames = 0;
+}
+
+const uint8_t* VideoFile::frame(uint64_t frame_index) const
+{
+   if (frames == 0)
+      return nullptr;
+
+   if (arena.data() != nullptr)
+      return arena.data() + (frame_index % frames) * frame_stride;
+
+   const uint8_t* current_frame = mapping + (frame_index % frames) * frame_stride;
+
+#if !defined(_WIN32)
+   //Sequential access only reads ahead within the file : the first frames are requested explicitly before the playout loops.
+   const uintptr_t ahead_frame = reinterpret_cast<uintptr_t>(mapping + ((frame_index + readahead_frames) % frames) * frame_stride);
+   const uintptr_t ahead_page = ahead_frame / page_size * page_size;
+   madvise(reinterpret_cast<void*>(ahead_page), frame_stride + (ahead_frame - ahead_page), MADV_WILLNEED);
+#endif
+
+   return current_frame;
+}
+
+bool VideoFile::map(const std::string& path)
+{
+#if defined(_WIN32)
+   HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+   {
+      std::cout << "Could not open " << path << std::endl;
+      return false;
+   }
+   file_handle = file;
+
+   LARGE_INTEGER file_size;
+   if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+   {
+      std::cout << "Could not get the size of " << path << ", or the file is empty" << std::endl;
+      unmap();
+      return false;
+   }
+   mapping_size = static_cast<size_t>(file_size.QuadPart);
+
+   mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (mapping_handle != nullptr)
+      mapping = static_cast<const uint8_t*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+#else
+   file_descriptor = ::open(path.c_str(), O_RDONLY);
+   if (file_descriptor < 0)
+   {
+      std::cout << "Could not open " << path << std::endl;
+      return false;
+   }
+
+   struct stat file_status;
+   if (fstat(file_descriptor, &file_status) != 0 || file_status.st_size == 0)
+   {
+      std::cout << "Could not get the size of " << path << ", or the file is empty" << std::endl;
+      unmap();
+      return false;
+   }
+   mapping_size = static_cast<size_t>(file_status.st_size);
+
+   void* address = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+   if (address != MAP_FAILED)
+   {
+      mapping = static_cast<const uint8_t*>(address);
+      //Doubles the readahead window of the file, and lets the kernel drop the pages behind the playout.
+      posix_fadvise(file_descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+      madvise(address, mapping_size, MADV_SEQUENTIAL);
+      madvise(address, std::min(mapping_size, static_cast<size_t>(engine.frame_size()) * readahead_frames), MADV_WILLNEED);
+   }
+#endif
+
+   if (mapping == nullptr)
+   {
+      std::cout << "Could not map " << path << " in memory" << std::endl;
+      unmap();
+      return false;
+   }
+
+   return true;
+}
+
+void VideoFile::unmap()
+{
+#if defined(_WIN32)
+   if (mapping != nullptr)
+      UnmapViewOfFile(mapping);
+   if (mapping_handle != nullptr)
+      CloseHandle(mapping_handle);
+   if (file_handle != INVALID_HANDLE_VALUE)
+      CloseHandle(file_handle);
+   mapping_handle = nullptr;
+   file_handle = INVALID_HANDLE_VALUE;
+#else
+   if (mapping != nullptr)
+      munmap(const_cast<uint8_t*>(mapping), mapping_size);
+   if (file_descriptor >= 0)
+      ::close(file_descriptor);
+   file_descriptor = -1;
+#endif
+
+   mapping = nullptr;
+   mapping_size = 0;
+}
+
+bool VideoFile::convert_planar_frames(size_t file_frame_size, size_t memory_budget, StripeRenderer* renderer)
+{
+   const uint32_t width = engine.frame_width();
+   const uint32_t height = engine.frame_height();
+
+   frame_stride = (engine.frame_size() + frame_alignment - 1) / frame_alignment * frame_alignment;
+   const uint32_t file_frames = static_cast<uint32_t>(std::min<size_t>(mapping_size / file_frame_size, UINT32_MAX));
+   const uint32_t frames_in_budget = static_cast<uint32_t>(std::min<size_t>(memory_budget / frame_stride, UINT32_MAX));
+   if (frames_in_budget < file_frames)
+      std::cout << "The playout is reduced to " << frames_in_budget << " frames to fit in the memory budget of " << memory_budget / (1024 * 1024) << " MiB" << std::endl;
+
+   const uint32_t frame_count = std::min(file_frames, frames_in_budget);
+   if (frame_count == 0)
+   {
+      std::cout << "No frame of the file fits in the memory budget" << std::endl;
+      return false;
+   }
+
+   if (!arena.allocate(frame_stride * frame_count))
+   {
+      std::cout << "Could not allocate the frame arena (" << frame_stride * frame_count / (1024 * 1024) << " MiB)" << std::endl;
+      return false;
+   }
+
+   //The Y plane is followed by the Cb and the Cr planes, each sample being 16 bits little endian.
+   auto convert_lines = [&](uint32_t frame_index, uint32_t first_line, uint32_t line_count) {
+      const uint8_t* planes = mapping + static_cast<size_t>(frame_index) * file_frame_size;
+      const size_t chroma_plane_size = static_cast<size_t>(width / 2) * height * sizeof(uint16_t);
+      const uint8_t* y_plane = planes;
+      const uint8_t* cb_plane = planes + static_cast<size_t>(width) * height * sizeof(uint16_t);
+      const uint8_t* cr_plane = cb_plane + chroma_plane_size;
+      std::vector<uint16_t> y(width), cb(width / 2 + 1), cr(width / 2 + 1);
+
+      //Samples are limited to 10 bits, so that a damaged file cannot overflow the pgroup fields.
+      auto read_samples = [](const uint8_t* source, uint32_t count, uint16_t* samples) {
+         for (uint32_t i = 0; i < count; i++)
+            samples[i] = static_cast<uint16_t>(std::min((source[2 * i] | (source[2 * i + 1] << 8)), 0x3FF));
+      };
+
+      for (uint32_t line = first_line; line < first_line + line_count; line++)
+      {
+         read_samples(y_plane + static_cast<size_t>(line) * width * sizeof(uint16_t), width, y.data());
+         read_samples(cb_plane + static_cast<size_t>(line) * (width / 2) * sizeof(uint16_t), width / 2, cb.data());
+         read_samples(cr_plane + static_cast<size_t>(line) * (width / 2) * sizeof(uint16_t), width / 2, cr.data());
+         engine.render_line(arena.data() + static_cast<size_t>(frame_index) * frame_stride, line, y.data(), cb.data(), cr.data());
+      }
+   };
+
+   for (uint32_t frame_index = 0; frame_index < frame_count; frame_index++)
+   {
+      if (renderer)
+         renderer->run(height, [&](uint32_t first_line, uint32_t line_count) { convert_lines(frame_index, first_line, line_count); });
+      else
+         convert_lines(frame_index, 0, height);
+   }
+
+   frames = frame_count;
+   return true;
+}
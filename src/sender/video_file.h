@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file video_file.h
+   @brief This file contains the raw video file played out by the sender in place of the test patterns.
+
+   A pgroup file holds frames already packed in the format and the buffer layout of the stream. It is memory mapped,
+   read ahead sequentially, and each frame is copied from the page cache to the slot buffer in a single copy.
+   A planar file holds yuv 4:2:2 10bits frames in picture order (yuv422p10le, as written by ffmpeg). It is converted
+   to the format of the stream when it is opened, into an arena holding every frame.
+   The playout loops at the end of the file.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <cstddef>
+#include <string>
+
+#include "frame_arena.h"
+#include "pattern_engine.h"
+#include "stripe_renderer.h"
+
+/*!
+   @brief Layouts of the raw video files played out by the sender.
+*/
+enum class VideoFileFormat
+{
+   pgroup, /*! Frames packed in the format and the buffer layout of the stream, played as is */
+   yuv422p10le /*! Planar yuv 4:2:2 10bits frames, 16 bits little endian samples, converted when the file is opened */
+};
+
+/*!
+   @brief Finds a video file format from its name, as given on the command line.
+
+   @returns true if the name is a known format.
+*/
+bool parse_video_file_format(const std::string& name /*!< [in] Name of the format.*/
+   , VideoFileFormat& format /*!< [out] Format corresponding to the name.*/
+);
+
+/*!
+   @brief This function provides a string representation of the VideoFileFormat enumeration value.
+
+   @returns the name of the format, as accepted by parse_video_file_format.
+*/
+std::string to_string(VideoFileFormat format /*!< [in] Format that we want to stringify.*/);
+
+class VideoFile
+{
+public:
+
+   VideoFile(const PatternEngine& engine /*!< [in] Engine giving the format and the geometry of the stream. Must outlive the file.*/);
+   ~VideoFile();
+
+   VideoFile(const VideoFile&) = delete;
+   VideoFile& operator=(const VideoFile&) = delete;
+
+   /*!
+      @brief Opens a video file. The size of the file must be a whole number of frames of the stream geometry.
+
+      @returns true if the file could be opened and holds at least one frame.
+   */
+   bool open(const std::string& path /*!< [in] Path of the file.*/
+      , VideoFileFormat format /*!< [in] Layout of the frames in the file.*/
+      , size_t memory_budget /*!< [in] Maximum size of the converted frames of a planar file, in bytes. The playout is shortened if they do not fit.*/
+      , StripeRenderer* renderer = nullptr /*!< [in] If set, planar frames are converted in stripes by the renderer workers.*/
+   );
+
+   /*!
+      @brief Releases the file and the converted frames.
+   */
+   void close();
+
+   /*!
+      @brief Gives the frame to transmit for a given frame counter, the playout looping at the end of the file.
+      For a memory mapped file, the frames following it are read ahead.
+   */
+   const uint8_t* frame(uint64_t frame_index /*!< [in] Frame counter.*/) const;
+
+   uint32_t frame_count() const { return frames; }
+   size_t frame_size() const { return engine.frame_size(); }
+
+   /*!
+      @brief Tells if the frames are played straight from the memory mapped file, which is the case of pgroup files.
+   */
+   bool is_memory_mapped() const { return mapping != nullptr; }
+
+private:
+
+   bool map(const std::string& path);
+   void unmap();
+   bool convert_planar_frames(size_t file_frame_size, size_t memory_budget, StripeRenderer* renderer);
+
+   const PatternEngine& engine;
+   const uint8_t* mapping;
+   size_t mapping_size;
+   size_t page_size;
+#if defined(_WIN32)
+   void* file_handle;
+   void* mapping_handle;
+#else
+   int file_descriptor;
+#endif
+   FrameArena arena;
+   size_t frame_stride;
+   uint32_t frames;
+};
@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_sequence.h"
+
+#include <iomanip>
+#include <iostream>
+
+StartupSequence::StartupSequence()
+   : origin(std::chrono::steady_clock::now())
+{
+}
+
+StartupSequence::~StartupSequence()
+{
+   wait_all();
+}
+
+uint64_t StartupSequence::elapsed() const
+{
+   return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+}
+
+VMIP_ERRORCODE StartupSequence::run(const std::string& name, const std::function<VMIP_ERRORCODE()>& phase)
+{
+   phases.push_back(Phase{ name, elapsed(), 0, false, std::future<VMIP_ERRORCODE>(), VMIPERR_NOERROR });
+   Phase& current = phases.back();
+   current.result = phase();
+   current.end = elapsed();
+   return current.result;
+}
+
+void StartupSequence::launch(const std::string& name, std::function<VMIP_ERRORCODE()> phase)
+{
+   phases.push_back(Phase{ name, elapsed(), 0, true, std::future<VMIP_ERRORCODE>(), VMIPERR_NOERROR });
+   Phase& current = phases.back();
+   //The end time is read once the future is ready, which orders it after the write.
+   current.future = std::async(std::launch::async, [this, &current, phase]()
+   {
+      const VMIP_ERRORCODE result = phase();
+      current.end = elapsed();
+      return result;
+   });
+}
+
+VMIP_ERRORCODE StartupSequence::wait(const std::string& name)
+{
+   for (Phase& phase : phases)
+   {
+      if (phase.name != name)
+         continue;
+      if (phase.future.valid())
+         phase.result = phase.future.get();
+      return phase.result;
+   }
+   return VMIPERR_NOERROR;
+}
+
+VMIP_ERRORCODE StartupSequence::wait_all()
+{
+   VMIP_ERRORCODE result = VMIPERR_NOERROR;
+   for (Phase& phase : phases)
+   {
+      if (phase.future.valid())
+         phase.result = phase.future.get();
+      if (result == VMIPERR_NOERROR)
+         result = phase.result;
+   }
+   return result;
+}
+
+void StartupSequence::print_report() const
+{
+   std::cout << "Ready in " << elapsed() / 1000000 << " ms" << std::endl;
+   for (const Phase& phase : phases)
+   {
+      std::cout << "   " << std::left << std::setw(24) << phase.name << std::right << std::setw(7) << phase.start / 1000000 << " ms -> "
+         << std::setw(7) << phase.end / 1000000 << " ms : " << std::setw(7) << (phase.end - phase.start) / 1000000 << " ms"
+         << (phase.concurrent ? " (concurrent)" : "") << (phase.result != VMIPERR_NOERROR ? " (failed)" : "") << std::endl;
+   }
+}
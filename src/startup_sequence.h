@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file startup_sequence.h
+   @brief This file contains the sequencing of the startup phases of the samples, with their timing.
+
+   The time to ready after a reboot or a failover is spent in phases that mostly wait on something else : the VCS for
+   the conductor and the streams, the network for the NMOS node, the CPU for the pre-rendered patterns. The phases
+   that do not depend on each other are launched on threads of their own and waited for by the phases needing them.
+   Each phase is timed from the start of the sequence, and the breakdown is printed once the sample is ready, to
+   track startup regressions.
+*/
+
+#ifdef __GNUC__
+#include <stdint-gcc.h>
+#else
+#include <stdint.h>
+#endif
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <string>
+
+#include <videomasterip/videomasterip_core.h>
+
+class StartupSequence
+{
+public:
+
+   StartupSequence();
+
+   StartupSequence(const StartupSequence&) = delete;
+   StartupSequence& operator=(const StartupSequence&) = delete;
+
+   /*!
+      @brief Waits for the phases still running, so that none outlives the state it works on.
+   */
+   ~StartupSequence();
+
+   /*!
+      @brief Runs a phase in the calling thread.
+      @return The result of the phase
+   */
+   VMIP_ERRORCODE run(const std::string& name /*!< [in] Name of the phase in the report.*/
+      , const std::function<VMIP_ERRORCODE()>& phase /*!< [in] Body of the phase.*/
+   );
+
+   /*!
+      @brief Launches a phase on a thread of its own. Its result is given by wait.
+   */
+   void launch(const std::string& name /*!< [in] Name of the phase in the report, and to wait for it.*/
+      , std::function<VMIP_ERRORCODE()> phase /*!< [in] Body of the phase.*/
+   );
+
+   /*!
+      @brief Waits for the end of a launched phase.
+      @return The result of the phase, VMIPERR_NOERROR for an unknown phase
+   */
+   VMIP_ERRORCODE wait(const std::string& name /*!< [in] Name of the phase.*/
+   );
+
+   /*!
+      @brief Waits for the end of all the launched phases.
+      @return The result of the first phase that failed, in launch order
+   */
+   VMIP_ERRORCODE wait_all();
+
+   /*!
+      @brief Prints the time to ready, from the start of the sequence to now, and the span of each phase. The launched phases must have been waited for.
+   */
+   void print_report() const;
+
+private:
+
+   struct Phase
+   {
+      std::string name;
+      uint64_t start; //Nanoseconds from the start of the sequence
+      uint64_t end;
+      bool concurrent;
+      std::future<VMIP_ERRORCODE> future;
+      VMIP_ERRORCODE result;
+   };
+
+   uint64_t elapsed() const;
+
+   std::chrono::steady_clock::time_point origin;
+   std::list<Phase> phases; //A list, the launched phases writing their end time to their own element
+};
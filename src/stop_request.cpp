@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stop_request.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+#if defined (__linux__) || defined (__APPLE__)
+#include "keyboard.h"
+#include <poll.h>
+#include <unistd.h>
+#else
+#include <conio.h>
+#include <io.h>
+#include <cstdio>
+#endif
+
+//Lock free, so that it can be set from the signal handlers.
+static std::atomic<bool> stop_requested(false);
+static std::atomic<bool> stop_listening(false);
+static std::thread keyboard_thread;
+static bool keyboard_initialized = false;
+//The command keys are posted by the keyboard thread, and taken by the thread that handles them.
+static std::atomic<int> first_command_key(1);
+static std::atomic<int> last_command_key(0);
+static std::atomic<int> posted_command_key(0);
+
+static void on_stop_signal(int)
+{
+   stop_requested.store(true, std::memory_order_relaxed);
+}
+
+//A key is either a command or a stop request.
+static void on_key(int key)
+{
+   if (key >= first_command_key.load(std::memory_order_relaxed) && key <= last_command_key.load(std::memory_order_relaxed))
+      posted_command_key.store(key, std::memory_order_relaxed);
+   else
+      request_stop();
+}
+
+//Waits for a key press, waking up every 100 ms to see if the listener is stopped.
+static void watch_keyboard()
+{
+   while (!stop_listening.load(std::memory_order_relaxed) && !stop_requested.load(std::memory_order_relaxed))
+   {
+#if defined (__linux__) || defined (__APPLE__)
+      pollfd input = { STDIN_FILENO, POLLIN, 0 };
+      const int ready = poll(&input, 1, 100);
+      if (ready < 0 || (ready > 0 && !(input.revents & POLLIN)))
+         break;
+      if (ready > 0)
+      {
+         //The end of the input is not a key press, only the signals can stop the sample from then on.
+         const int key = _getch();
+         if (key != 0)
+            on_key(key);
+         else
+            break;
+      }
+#else
+      if (_kbhit())
+         on_key(_getch());
+      else
+         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+#endif
+   }
+}
+
+void start_stop_request_listener()
+{
+   std::signal(SIGINT, on_stop_signal);
+   std::signal(SIGTERM, on_stop_signal);
+
+#if defined (__linux__) || defined (__APPLE__)
+   if (!isatty(STDIN_FILENO))
+      return;
+   init_keyboard();
+#else
+   if (!_isatty(_fileno(stdin)))
+      return;
+#endif
+   keyboard_initialized = true;
+   stop_listening = false;
+   keyboard_thread = std::thread(watch_keyboard);
+}
+
+void stop_stop_request_listener()
+{
+   stop_listening = true;
+   if (keyboard_thread.joinable())
+      keyboard_thread.join();
+
+#if defined (__linux__) || defined (__APPLE__)
+   if (keyboard_initialized)
+      close_keyboard();
+#endif
+   keyboard_initialized = false;
+}
+
+bool is_stop_requested()
+{
+   return stop_requested.load(std::memory_order_relaxed);
+}
+
+void request_stop()
+{
+   stop_requested.store(true, std::memory_order_relaxed);
+}
+
+void set_command_keys(int first_key, int last_key)
+{
+   first_command_key.store(first_key, std::memory_order_relaxed);
+   last_command_key.store(last_key, std::memory_order_relaxed);
+}
+
+int take_command_key()
+{
+   return posted_command_key.exchange(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+/*!
+   @file stop_request.h
+   @brief This file contains the request to stop the samples, from a key press or from SIGINT / SIGTERM.
+
+   Polling the terminal costs two tcsetattr calls and a read per check, too much for the transmission and reception
+   loops. The keyboard is instead watched by a thread of its own, which sets a flag on a key press, as do the handlers
+   of SIGINT and SIGTERM. Checking for a stop is then a relaxed load of that flag. Without a terminal, under systemd
+   for instance, the keyboard is not watched and the samples are stopped by the signals only.
+*/
+
+/*!
+   @brief Installs the SIGINT and SIGTERM handlers, and starts watching the keyboard if the standard input is a terminal.
+*/
+void start_stop_request_listener();
+
+/*!
+   @brief Stops watching the keyboard and restores the terminal. The signal handlers are left in place.
+*/
+void stop_stop_request_listener();
+
+/*!
+   @brief Returns true once a stop was requested. Cheap enough to be checked on every slot.
+*/
+bool is_stop_requested();
+
+/*!
+   @brief Requests a stop, as a key press would.
+*/
+void request_stop();
+
+/*!
+   @brief Sets the range of the keys used as commands. The keyboard thread only posts them, the other keys requesting a stop.
+*/
+void set_command_keys(int first_key /*!< [in] First command key*/,
+                      int last_key /*!< [in] Last command key. Below first_key, every key requests a stop.*/
+);
+
+/*!
+   @brief Returns the last command key pressed since the previous call, and forgets it. 0 if none.
+*/
+int take_command_key();
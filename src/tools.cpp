@@ -25,7 +25,9 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <cstring>
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <thread>
@@ -275,18 +277,17 @@ VMIP_ERRORCODE configure_conductor(const uint32_t conductor_cpu_core_os_id, HAND
    return result;
 }
 
-VMIP_ERRORCODE configure_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
-                               const std::vector<uint32_t>& processing_cpu_core_os_id,
-                               const std::vector<uint32_t>& destination_addresses,
-                               const std::vector<uint16_t>& destination_udp_ports,
-                               const uint32_t destination_ssrc,
-                               const VMIP_VIDEO_STANDARD video_standard, 
-                               const std::vector<uint64_t>& nic_ids,
-                               uint64_t conductor_id, uint32_t management_thread_cpu_core_os_id, HANDLE stream)
+//Configures the processing cores, the conductor and the destinations of a stream, whatever its essence.
+static VMIP_ERRORCODE configure_stream_transport(HANDLE vcs_context,
+                                                const std::vector<uint32_t>& processing_cpu_core_os_id,
+                                                const std::vector<uint32_t>& destination_addresses,
+                                                const std::vector<uint16_t>& destination_udp_ports,
+                                                const uint32_t destination_ssrc,
+                                                const std::vector<uint64_t>& nic_ids,
+                                                uint64_t conductor_id, uint32_t management_thread_cpu_core_os_id, HANDLE stream)
 {
    VMIP_STREAM_COMMON_CONFIG stream_common_config;
    VMIP_STREAM_NETWORK_CONFIG stream_network_config;
-   VMIP_STREAM_ESSENCE_CONFIG essence_config;
    VMIP_ERRORCODE result = VMIPERR_NOERROR;
 
    if (stream == nullptr)
@@ -368,6 +369,24 @@ VMIP_ERRORCODE configure_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
          std::cout << "Error when setting stream network config" << " [" << to_string(result) << "]" << std::endl;
    }
 
+   return result;
+}
+
+VMIP_ERRORCODE configure_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
+                               const std::vector<uint32_t>& processing_cpu_core_os_id,
+                               const std::vector<uint32_t>& destination_addresses,
+                               const std::vector<uint16_t>& destination_udp_ports,
+                               const uint32_t destination_ssrc,
+                               const VMIP_VIDEO_STANDARD video_standard, 
+                               const VMIP_VIDEO_SAMPLING video_sampling,
+                               const VMIP_VIDEO_DEPTH video_depth,
+                               const std::vector<uint64_t>& nic_ids,
+                               uint64_t conductor_id, uint32_t management_thread_cpu_core_os_id, HANDLE stream)
+{
+   VMIP_STREAM_ESSENCE_CONFIG essence_config;
+   VMIP_ERRORCODE result = configure_stream_transport(vcs_context, processing_cpu_core_os_id, destination_addresses, destination_udp_ports, destination_ssrc,
+                                                      nic_ids, conductor_id, management_thread_cpu_core_os_id, stream);
+
    //We get the stream essence config. It is also a way to initialize the structure essence_config.
    if (result == VMIPERR_NOERROR)
    {
@@ -380,10 +399,11 @@ VMIP_ERRORCODE configure_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
    //We set the stream essence config.
    if (result == VMIPERR_NOERROR)
    {
-      essence_config.EssenceS2110_20Prop.NetworkBitDepth = VMIP_VIDEO_DEPTH_10BIT;
-      essence_config.EssenceS2110_20Prop.NetworkBitSampling = VMIP_VIDEO_SAMPLING_YCBCR_422;
-      essence_config.EssenceS2110_20Prop.UserBitDepth = VMIP_VIDEO_DEPTH_10BIT;
-      essence_config.EssenceS2110_20Prop.UserBitSampling = VMIP_VIDEO_SAMPLING_YCBCR_422;
+      //The slot buffers hold the network format, so that no conversion is needed in the stream.
+      essence_config.EssenceS2110_20Prop.NetworkBitDepth = video_depth;
+      essence_config.EssenceS2110_20Prop.NetworkBitSampling = video_sampling;
+      essence_config.EssenceS2110_20Prop.UserBitDepth = video_depth;
+      essence_config.EssenceS2110_20Prop.UserBitSampling = video_sampling;
       essence_config.EssenceS2110_20Prop.UserBitPadding = VMIP_VIDEO_NO_PADDING;
       essence_config.EssenceS2110_20Prop.UserEndianness = VMIP_VIDEO_BIG_ENDIAN;
       essence_config.EssenceS2110_20Prop.UseDefaultTrOffset = true;
@@ -402,9 +422,59 @@ VMIP_ERRORCODE configure_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
    return result;
 }
 
+VMIP_ERRORCODE create_audio_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type, HANDLE* stream)
+{
+#if IPVC_ST2110_30
+   return VMIP_CreateStream(vcs_context, stream_type, VMIP_ET_ST2110_30, stream);
+#else
+   return VMIPERR_BAD_CONFIGURATION;
+#endif
+}
+
+VMIP_ERRORCODE configure_audio_stream(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
+                                     const std::vector<uint32_t>& processing_cpu_core_os_id,
+                                     const std::vector<uint32_t>& destination_addresses,
+                                     const std::vector<uint16_t>& destination_udp_ports,
+                                     const uint32_t destination_ssrc,
+                                     const uint32_t channel_count,
+                                     const AudioPacketTime packet_time,
+                                     const std::vector<uint64_t>& nic_ids,
+                                     uint64_t conductor_id, uint32_t management_thread_cpu_core_os_id, HANDLE stream)
+{
+#if IPVC_ST2110_30
+   VMIP_STREAM_ESSENCE_CONFIG essence_config;
+   VMIP_ERRORCODE result = configure_stream_transport(vcs_context, processing_cpu_core_os_id, destination_addresses, destination_udp_ports, destination_ssrc,
+                                                      nic_ids, conductor_id, management_thread_cpu_core_os_id, stream);
+
+   //We get the stream essence config. It is also a way to initialize the structure essence_config.
+   if (result == VMIPERR_NOERROR)
+   {
+      essence_config.EssenceType = VMIP_ET_ST2110_30;
+      result = VMIP_GetStreamEssenceConfig(stream, &essence_config);
+      if (result != VMIPERR_NOERROR)
+         std::cout << "Error when getting stream essence config" << " [" << to_string(result) << "]" << std::endl;
+   }
+
+   //We set the stream essence config. The samples are 24 bits at 48 kHz, the slot buffers holding them in the network format.
+   if (result == VMIPERR_NOERROR)
+   {
+      essence_config.EssenceS2110_30Prop.NbChannels = channel_count;
+      essence_config.EssenceS2110_30Prop.PacketTime = (packet_time == AudioPacketTime::packet_125us) ? VMIP_AUDIO_PACKET_TIME_125US : VMIP_AUDIO_PACKET_TIME_1MS;
+
+      result = VMIP_SetStreamEssenceConfig(stream, essence_config);
+      if (result != VMIPERR_NOERROR)
+         std::cout << "Error when setting stream essence config"<< " [" << to_string(result) << "]" << std::endl;
+   }
+
+   return result;
+#else
+   return VMIPERR_BAD_CONFIGURATION;
+#endif
+}
+
 VMIP_ERRORCODE configure_stream_from_sdp(HANDLE vcs_context, VMIP_STREAMTYPE stream_type,
                                       const std::vector<uint32_t>& rProcessingeCpuCoreOsId, std::string Sdp,
-                                      const uint32_t destination_ip_overrides, const uint16_t destination_udp_port_ovverrides,
+                                      const std::vector<uint32_t>& destination_ip_overrides, const std::vector<uint16_t>& destination_udp_port_ovverrides,
                                       const std::vector<uint64_t>& nic_ids, uint64_t conductor_id,
                                       uint32_t management_thread_cpu_core_os_id, HANDLE stream)
 {
@@ -470,10 +540,18 @@ VMIP_ERRORCODE configure_stream_from_sdp(HANDLE vcs_context, VMIP_STREAMTYPE str
          std::cout << "Error when setting stream common config" << " [" << to_string(result) << "]" << std::endl;
    }
 
-   if(nic_ids.size() != stream_network_config.PathParameterSize)
+   //A redundant SDP can be received on a single NIC, the second path is left out.
+   if (result == VMIPERR_NOERROR)
    {
-      std::cout << std::endl << "The number of path configured in the SDP and the number of Nic do not correspond" << std::endl;
-      result = VMIPERR_BAD_CONFIGURATION;
+      if (nic_ids.size() < stream_network_config.PathParameterSize)
+         stream_network_config.PathParameterSize = static_cast<uint32_t>(nic_ids.size());
+
+      if(stream_network_config.PathParameterSize == 0 || destination_ip_overrides.size() < stream_network_config.PathParameterSize
+         || destination_udp_port_ovverrides.size() < stream_network_config.PathParameterSize)
+      {
+         std::cout << std::endl << "The number of path configured in the SDP and the number of Nic do not correspond" << std::endl;
+         result = VMIPERR_BAD_CONFIGURATION;
+      }
    }
 
    //Wet set the network configuration.
@@ -486,11 +564,10 @@ VMIP_ERRORCODE configure_stream_from_sdp(HANDLE vcs_context, VMIP_STREAMTYPE str
          stream_network_config.pPathParameters[path_index].InterfaceId = nic_ids[path_index];
          stream_network_config.pPathParameters[path_index].IgmpFilteringType = VMIP_FILTERING_BLACKLIST;
          stream_network_config.pPathParameters[path_index].IgmpSourceListSize = 0;
+         stream_network_config.pPathParameters[path_index].DestinationIp = destination_ip_overrides[path_index];
+         stream_network_config.pPathParameters[path_index].UdpPort = destination_udp_port_ovverrides[path_index];
       }
 
-      stream_network_config.pPathParameters[0].DestinationIp = destination_ip_overrides;
-      stream_network_config.pPathParameters[0].UdpPort = destination_udp_port_ovverrides;
-
       result = VMIP_SetStreamNetworkConfig(stream, stream_network_config);
       if (result != VMIPERR_NOERROR)
          std::cout << "Error when setting stream network config." << " [" << to_string(result) << "]" << std::endl;
@@ -558,6 +635,181 @@ std::string to_string(VMIP_ERRORCODE error_code)
    return std::string(error_string);
 }
 
+std::string to_string(VMIP_VIDEO_STANDARD video_standard)
+{
+   uint32_t frame_width = 0, frame_height = 0, frame_rate = 0;
+   bool8_t interlaced = false, is_us = false;
+
+   if (VMIP_GetVideoStandardInfo(video_standard, &frame_width, &frame_height, &frame_rate, &interlaced, &is_us) != VMIPERR_NOERROR)
+      return "Undefined";
+
+   std::stringstream name;
+   name << frame_width << "x" << frame_height << (interlaced ? "i" : "p");
+   if (is_us)
+      name << std::fixed << std::setprecision(2) << frame_rate * 1000.0 / 1001.0;
+   else
+      name << frame_rate;
+
+   return name.str();
+}
+
+bool parse_video_standard(const std::string& name, VMIP_VIDEO_STANDARD* video_standard)
+{
+   if (video_standard == nullptr)
+   {
+      std::cout << std::endl << "The video_standard pointer is invalid" << std::endl;
+      return false;
+   }
+
+   for (uint32_t i = 0; i < NB_VMIP_VIDEO_STANDARD; i++)
+   {
+      if (to_string(static_cast<VMIP_VIDEO_STANDARD>(i)) == name)
+      {
+         *video_standard = static_cast<VMIP_VIDEO_STANDARD>(i);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool get_quad_link_video_standard(VMIP_VIDEO_STANDARD video_standard, VMIP_VIDEO_STANDARD* link_video_standard)
+{
+   if (link_video_standard == nullptr)
+   {
+      std::cout << std::endl << "The link_video_standard pointer is invalid" << std::endl;
+      return false;
+   }
+
+   uint32_t frame_width = 0, frame_height = 0, frame_rate = 0;
+   bool8_t interlaced = false, is_us = false;
+   if (VMIP_GetVideoStandardInfo(video_standard, &frame_width, &frame_height, &frame_rate, &interlaced, &is_us) != VMIPERR_NOERROR)
+      return false;
+
+   for (uint32_t i = 0; i < NB_VMIP_VIDEO_STANDARD; i++)
+   {
+      uint32_t link_width = 0, link_height = 0, link_rate = 0;
+      bool8_t link_interlaced = false, link_is_us = false;
+      if (VMIP_GetVideoStandardInfo(static_cast<VMIP_VIDEO_STANDARD>(i), &link_width, &link_height, &link_rate, &link_interlaced, &link_is_us) == VMIPERR_NOERROR
+         && 2 * link_width == frame_width && 2 * link_height == frame_height && link_rate == frame_rate && link_interlaced == interlaced && link_is_us == is_us)
+      {
+         *link_video_standard = static_cast<VMIP_VIDEO_STANDARD>(i);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+std::string to_string(VMIP_VIDEO_SAMPLING video_sampling)
+{
+   std::string result = "Undefined";
+
+   switch (video_sampling)
+   {
+   case VMIP_VIDEO_SAMPLING_YCBCR_422: result = "ycbcr422"; break;
+   case VMIP_VIDEO_SAMPLING_YCBCR_444: result = "ycbcr444"; break;
+   case VMIP_VIDEO_SAMPLING_RGB_444: result = "rgb444"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+bool parse_video_sampling(const std::string& name, VMIP_VIDEO_SAMPLING* video_sampling)
+{
+   if (video_sampling == nullptr)
+   {
+      std::cout << std::endl << "The video_sampling pointer is invalid" << std::endl;
+      return false;
+   }
+
+   for (VMIP_VIDEO_SAMPLING candidate : {VMIP_VIDEO_SAMPLING_YCBCR_422, VMIP_VIDEO_SAMPLING_YCBCR_444, VMIP_VIDEO_SAMPLING_RGB_444})
+   {
+      if (to_string(candidate) == name)
+      {
+         *video_sampling = candidate;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+std::string to_string(VMIP_VIDEO_DEPTH video_depth)
+{
+   std::string result = "Undefined";
+
+   switch (video_depth)
+   {
+   case VMIP_VIDEO_DEPTH_8BIT: result = "8"; break;
+   case VMIP_VIDEO_DEPTH_10BIT: result = "10"; break;
+   case VMIP_VIDEO_DEPTH_12BIT: result = "12"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+bool parse_video_depth(const std::string& name, VMIP_VIDEO_DEPTH* video_depth)
+{
+   if (video_depth == nullptr)
+   {
+      std::cout << std::endl << "The video_depth pointer is invalid" << std::endl;
+      return false;
+   }
+
+   for (VMIP_VIDEO_DEPTH candidate : {VMIP_VIDEO_DEPTH_8BIT, VMIP_VIDEO_DEPTH_10BIT, VMIP_VIDEO_DEPTH_12BIT})
+   {
+      if (to_string(candidate) == name)
+      {
+         *video_depth = candidate;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+std::string to_string(AudioPacketTime packet_time)
+{
+   std::string result = "Undefined";
+
+   switch (packet_time)
+   {
+   case AudioPacketTime::packet_1ms: result = "1ms"; break;
+   case AudioPacketTime::packet_125us: result = "125us"; break;
+   default: break;
+   }
+
+   return result;
+}
+
+bool parse_audio_packet_time(const std::string& name, AudioPacketTime* packet_time)
+{
+   if (packet_time == nullptr)
+   {
+      std::cout << std::endl << "The packet_time pointer is invalid" << std::endl;
+      return false;
+   }
+
+   for (AudioPacketTime candidate : {AudioPacketTime::packet_1ms, AudioPacketTime::packet_125us})
+   {
+      if (to_string(candidate) == name)
+      {
+         *packet_time = candidate;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+uint32_t get_audio_packet_rate(AudioPacketTime packet_time)
+{
+   return (packet_time == AudioPacketTime::packet_125us) ? 8000 : 1000;
+}
+
 VMIP_ERRORCODE generate_sdp(HANDLE vcs_context, HANDLE stream, std::string* sdp)
 {
    VMIP_ERRORCODE result = VMIPERR_NOERROR;
@@ -605,14 +857,15 @@ VMIP_ERRORCODE generate_sdp(HANDLE vcs_context, VMIP_STREAM_NETWORK_CONFIG strea
       return VMIPERR_INVALIDPOINTER;
    }
 
-   if (result == VMIPERR_NOERROR)
+   //Each path is sent from the address of its own NIC.
+   for (uint32_t path_index = 0; path_index < stream_network_config.PathParameterSize && result == VMIPERR_NOERROR; path_index++)
    {
       VMIP_NETWORK_ITF_CONFIG nic_config;
-      result = VMIP_GetNetworkInterfaceConfig(vcs_context,stream_network_config.pPathParameters[0].InterfaceId, &nic_config);
+      result = VMIP_GetNetworkInterfaceConfig(vcs_context,stream_network_config.pPathParameters[path_index].InterfaceId, &nic_config);
       if (result != VMIPERR_NOERROR)
          std::cout << "Error when getting the network interface config" << " [" << to_string(result) << "]" << std::endl;
       else
-         stream_network_config.pPathParameters[0].SourceIp = nic_config.InterfaceIpAddress;
+         stream_network_config.pPathParameters[path_index].SourceIp = nic_config.InterfaceIpAddress;
    }
 
    if (result == VMIPERR_NOERROR)
@@ -637,8 +890,11 @@ VMIP_ERRORCODE generate_sdp(HANDLE vcs_context, VMIP_STREAM_NETWORK_CONFIG strea
       sdp_additional_information.TimestampDelay = 1000;
       snprintf(sdp_additional_information.pSessionName, MAX_CHAR_ARRAY_SIZE, "Sample Media Stream");
       snprintf(sdp_additional_information.pSessionDescription, MAX_CHAR_ARRAY_SIZE, "media stream created with Deltacast IPVirtualCard");
+#if IPVC_ST2110_30
+      //The channels are sent as a single undefined group (U01 to U64).
       if (essence_config.EssenceType == VMIP_ET_ST2110_30)
-         snprintf(sdp_additional_information.pAudioChannelOrder, MAX_CHAR_AUDIO_CHANNEL_ORDER_SIZE, "SMPTE2110.(M,M,M,M,ST,U02)");
+         snprintf(sdp_additional_information.pAudioChannelOrder, MAX_CHAR_AUDIO_CHANNEL_ORDER_SIZE, "SMPTE2110.(U%02u)", static_cast<unsigned>(essence_config.EssenceS2110_30Prop.NbChannels));
+#endif
 
       const uint32_t max_sdp_size = 65536;
       uint32_t sdp_size = max_sdp_size;
@@ -688,12 +944,70 @@ VMIP_ERRORCODE print_ptp_status(HANDLE vcs_context, uint8_t domain_number, uint8
    return result;
 }
 
+VMIP_ERRORCODE get_ptp_lock(HANDLE vcs_context, bool* is_locked, double* offset_from_master)
+{
+   VMIP_PTP_STATUS ptp_status = {};
+
+   if (is_locked == nullptr || offset_from_master == nullptr)
+      return VMIPERR_INVALIDPOINTER;
+
+   VMIP_ERRORCODE result = VMIP_GetPTPStatus(vcs_context, &ptp_status);
+   if (result != VMIPERR_NOERROR)
+      std::cout << std::endl << "Error when getting the PTP status. " << std::endl;
+   else
+   {
+      *is_locked = (ptp_status.PortDS.PortState == VMIP_PTP_STATE_SLAVE);
+      *offset_from_master = ptp_status.CurrentDS.OffsetFromMaster;
+   }
+   return result;
+}
+
+uint64_t next_frame_boundary(uint64_t ptp_time, uint32_t rate_numerator, uint32_t rate_denominator)
+{
+   const uint64_t nanoseconds_per_second = 1000000000;
+   if (rate_numerator == 0 || rate_denominator == 0)
+      return ptp_time;
+
+   //Frame k starts at k * rate_denominator / rate_numerator seconds. The products are split on the seconds so that they do not overflow.
+   const uint64_t seconds = ptp_time / nanoseconds_per_second;
+   const uint64_t nanoseconds = ptp_time % nanoseconds_per_second;
+   const uint64_t whole_frames = seconds * rate_numerator / rate_denominator;
+   const uint64_t remaining = (seconds * rate_numerator % rate_denominator) * nanoseconds_per_second + nanoseconds * rate_numerator;
+   const uint64_t frame = whole_frames + remaining / (rate_denominator * nanoseconds_per_second) + ((remaining % (rate_denominator * nanoseconds_per_second)) != 0 ? 1 : 0);
+
+   const uint64_t frame_periods = frame * rate_denominator;
+   const uint64_t frame_seconds = frame_periods / rate_numerator;
+   const uint64_t frame_nanoseconds = ((frame_periods % rate_numerator) * nanoseconds_per_second + rate_numerator - 1) / rate_numerator;
+   return frame_seconds * nanoseconds_per_second + frame_nanoseconds;
+}
+
+int64_t print_switch_error(HANDLE vcs_context, const std::string& stream_name, uint64_t scheduled_time, uint64_t switch_time)
+{
+   const int64_t switch_error = static_cast<int64_t>(switch_time - scheduled_time);
+   bool is_locked = false;
+   double offset_from_master = 0;
+
+   std::cout << std::endl << stream_name << "Scheduled activation : switched " << switch_error / 1000 << " us after the frame boundary";
+   if (get_ptp_lock(vcs_context, &is_locked, &offset_from_master) == VMIPERR_NOERROR)
+   {
+      //Unless PTP is locked, the frame boundaries are not those of the other devices.
+      if (is_locked)
+         std::cout << " (PTP locked, offset " << static_cast<int64_t>(offset_from_master * 1e9) << " ns)";
+      else
+         std::cout << " (PTP not locked)";
+   }
+   std::cout << std::endl;
+
+   return switch_error;
+}
+
 using namespace std::chrono_literals;
 void monitor_rx_stream_status(HANDLE stream, bool* request_stop, uint32_t* timeout)
 {
    VMIP_STREAM_COMMON_STATUS stream_common_status;
    VMIP_STREAM_NETWORK_STATUS stream_network_status;
 
+   //With two paths (ST2022-7), PacketLost counts the packets missing on both, that is the packets the redundancy could not recover.
    while(!*request_stop)
    {
       VMIP_GetStreamCommonStatus(stream, &stream_common_status);
@@ -705,7 +1019,7 @@ void monitor_rx_stream_status(HANDLE stream, bool* request_stop, uint32_t* timeo
    }
 }
 
-void monitor_tx_stream_status(HANDLE stream, bool* request_stop)
+void monitor_tx_stream_status(HANDLE stream, bool* request_stop, const std::atomic<uint64_t>* deadline_misses)
 {
    VMIP_STREAM_COMMON_STATUS stream_common_status;
    VMIP_STREAM_NETWORK_STATUS stream_network_status;
@@ -715,7 +1029,10 @@ void monitor_tx_stream_status(HANDLE stream, bool* request_stop)
       VMIP_GetStreamCommonStatus(stream, &stream_common_status);
       VMIP_GetStreamNetworkStatus(stream, &stream_network_status);
 
-      std::cout << "SlotCount: " << stream_common_status.SlotCount << " - SlotFilling: " << stream_common_status.ApplicativeBufferQueueFilling << " - SlotDropped: " << stream_common_status.SlotDropped << " - PacketUnderrun:  " << stream_network_status.PacketUnderrun<< " - PacketDrop:  " << stream_network_status.PacketDrop << "                      \r" << std::flush;
+      std::cout << "SlotCount: " << stream_common_status.SlotCount << " - SlotFilling: " << stream_common_status.ApplicativeBufferQueueFilling << " - SlotDropped: " << stream_common_status.SlotDropped << " - PacketUnderrun:  " << stream_network_status.PacketUnderrun<< " - PacketDrop:  " << stream_network_status.PacketDrop;
+      if (deadline_misses)
+         std::cout << " - DeadlineMiss: " << deadline_misses->load(std::memory_order_relaxed);
+      std::cout << "                      \r" << std::flush;
 
       std::this_thread::sleep_for(100ms);
    }
@@ -31,10 +31,25 @@
 #include <stdint.h>
 #endif
 
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <vector>
 
+//The ST2110-30 audio stream uses SDK names that are only compiled with the SENDER_ST2110_30 CMake option.
+#ifndef IPVC_ST2110_30
+#define IPVC_ST2110_30 0
+#endif
+
+/*!
+   @brief Duration of the samples of an ST2110-30 packet.
+*/
+enum class AudioPacketTime
+{
+   packet_1ms, /*! 1 ms, 48 samples per channel */
+   packet_125us /*! 125 us, 6 samples per channel */
+};
+
 /*!
    @brief This function prints the information regarding the detected CPU's. CPU's mentionned as forbidden in the configuration file will not appear.
 
@@ -119,6 +134,8 @@ VMIP_ERRORCODE configure_stream(HANDLE vcs_context /*!< [in] Context of the VCS
                                                                           In RX : Ssrc of the received packet.
                                                                                   If this is set to 0, wo filtering will be done on the SSRC.    */
                                , const VMIP_VIDEO_STANDARD video_standard /*!< [in] Video standard of the stream. */
+                               , const VMIP_VIDEO_SAMPLING video_sampling /*!< [in] Sampling of the stream, used on the network and in the slot buffers. */
+                               , const VMIP_VIDEO_DEPTH video_depth /*!< [in] Depth of the stream, used on the network and in the slot buffers. */
                                , const std::vector<uint64_t>& nic_ids /*!< [in] Ids of the NICs used by the stream
                                                                           The size of the vector indicates the number of different path that will be used. Using multiple paths allows seamless
                                                                           switching in RX and TX as specified in the norm ST2022-7. The size must correspond to the size of destination_addresses and destination_udp_ports */
@@ -127,6 +144,36 @@ VMIP_ERRORCODE configure_stream(HANDLE vcs_context /*!< [in] Context of the VCS
                                , HANDLE stream /*!< [out] Handle of the created stream */
 );
 
+/*!
+   @brief This function creates an ST2110-30 audio stream
+
+   @returns The function returns the status of its execution as VMIP_ERRORCODE, VMIPERR_BAD_CONFIGURATION if the sample is built without ST2110-30
+*/
+VMIP_ERRORCODE create_audio_stream(HANDLE vcs_context /*!< [in] Context of the VCS session */
+                                  , VMIP_STREAMTYPE stream_type /*!< [in] Type of the stream (RX or TX)*/
+                                  , HANDLE* stream /*!< [out] Handle of the created stream */
+);
+
+/*!
+   @brief This function manages the configuration of an ST2110-30 audio stream, 24 bits at 48 kHz.
+   It holds, with create_audio_stream, all the ST2110-30 names of the SDK.
+
+   @returns The function returns the status of its execution as VMIP_ERRORCODE, VMIPERR_BAD_CONFIGURATION if the sample is built without ST2110-30
+*/
+VMIP_ERRORCODE configure_audio_stream(HANDLE vcs_context /*!< [in] Context of the VCS session */
+                                     , VMIP_STREAMTYPE stream_type /*!< [in] Type of the stream (RX or TX)*/
+                                     , const std::vector<uint32_t>& processing_cpu_core_os_id /*!< [in] Cores on which the processing jobs are launched, as for configure_stream. */
+                                     , const std::vector<uint32_t>& destination_addresses /*!< [in] Destination addresses, one per path, as for configure_stream. */
+                                     , const std::vector<uint16_t>& destination_udp_ports /*!< [in] Destination ports, one per path, as for configure_stream. */
+                                     , const uint32_t destination_ssrc /*!< [in] Ssrc of the packets, as for configure_stream. */
+                                     , const uint32_t channel_count /*!< [in] Number of audio channels. */
+                                     , const AudioPacketTime packet_time /*!< [in] Duration of the samples of a packet. */
+                                     , const std::vector<uint64_t>& nic_ids /*!< [in] Ids of the NICs used by the stream, one per path, as for configure_stream. */
+                                     , uint64_t conductor_id /*!< [in] Id of the conductor used by the stream. */
+                                     , uint32_t management_thread_cpu_core_os_id /*!< [in] CPU core on wich the management thread will be pinned. */
+                                     , HANDLE stream /*!< [out] Handle of the created stream */
+);
+
 /*!
    @brief This function manages stream creation and configuration based on a SDP
 
@@ -138,9 +185,10 @@ VMIP_ERRORCODE configure_stream_from_sdp(HANDLE vcs_context /*!< [in] Context of
                                                                                                         Putting the conductor core in this list should be avoided.
                                                                                                         If left empty, all the core of the system will be used. */
                                       , std::string sdp /*!< [in] SDP from which informations will be extracted*/
-                                      , const uint32_t destination_ip_overrides /*!< [in] To override the destination IP contained in the SDP.*/
-                                      , const uint16_t destination_udp_port_ovverrides /*!< [in] To override the destination UDP port contained in the SDP.*/
-                                      , const std::vector<uint64_t>& nic_ids /*!< [in] Ids of the NICs used by the stream. Multiple NICs are used in case we use multiple paths as specified in the norm ST2022-7 */
+                                      , const std::vector<uint32_t>& destination_ip_overrides /*!< [in] To override the destination IP contained in the SDP, one per path.*/
+                                      , const std::vector<uint16_t>& destination_udp_port_ovverrides /*!< [in] To override the destination UDP port contained in the SDP, one per path.*/
+                                      , const std::vector<uint64_t>& nic_ids /*!< [in] Ids of the NICs used by the stream. Multiple NICs are used in case we use multiple paths as specified in the norm ST2022-7.
+                                                                                    The stream receives on the first paths of the SDP that have a NIC. */
                                       , uint64_t conductor_id /*!< [in] Id of the conductor used by the stream. */
                                       , uint32_t management_thread_cpu_core_os_id /*!< [in] CPU core on wich the management thread will be pinned. */
                                       , HANDLE stream /*!< [out] Handle of the created stream */
@@ -167,6 +215,86 @@ std::string version_to_string(uint64_t version /*!< [in] version that will be st
 */
 std::string to_string(VMIP_ERRORCODE error_code /*!< [in] Error code that will be stringified*/);
 
+/*!
+   @brief Stringify a video standard as width x height, scan mode and rate, for example 1920x1080p30 or 3840x2160p59.94
+
+   @returns A string containing the name of the video standard, or "Undefined" if the standard is not known by the library
+*/
+std::string to_string(VMIP_VIDEO_STANDARD video_standard /*!< [in] Video standard that will be stringified*/);
+
+/*!
+   @brief Finds a video standard from its name, as given by to_string
+
+   @returns true if the name corresponds to a video standard supported by the library
+*/
+bool parse_video_standard(const std::string& name /*!< [in] Name of the video standard*/
+                         , VMIP_VIDEO_STANDARD* video_standard /*!< [out] Video standard corresponding to the name*/
+);
+
+/*!
+   @brief Finds the video standard of the links of a quad-link division : half the width and half the height, at the same rate and scan
+
+   @returns true if such a video standard is supported by the library
+*/
+bool get_quad_link_video_standard(VMIP_VIDEO_STANDARD video_standard /*!< [in] Video standard of the whole frame*/
+                                 , VMIP_VIDEO_STANDARD* link_video_standard /*!< [out] Video standard of each link*/
+);
+
+/*!
+   @brief Stringify a video sampling
+
+   @returns A string containing the name of the sampling : ycbcr422, ycbcr444 or rgb444
+*/
+std::string to_string(VMIP_VIDEO_SAMPLING video_sampling /*!< [in] Video sampling that will be stringified*/);
+
+/*!
+   @brief Finds a video sampling from its name, as given by to_string
+
+   @returns true if the name corresponds to a video sampling
+*/
+bool parse_video_sampling(const std::string& name /*!< [in] Name of the video sampling*/
+                         , VMIP_VIDEO_SAMPLING* video_sampling /*!< [out] Video sampling corresponding to the name*/
+);
+
+/*!
+   @brief Stringify a video depth
+
+   @returns A string containing the number of bits per sample : 8, 10 or 12
+*/
+std::string to_string(VMIP_VIDEO_DEPTH video_depth /*!< [in] Video depth that will be stringified*/);
+
+/*!
+   @brief Finds a video depth from its number of bits per sample, as given by to_string
+
+   @returns true if the name corresponds to a video depth
+*/
+bool parse_video_depth(const std::string& name /*!< [in] Number of bits per sample*/
+                      , VMIP_VIDEO_DEPTH* video_depth /*!< [out] Video depth corresponding to the name*/
+);
+
+/*!
+   @brief Stringify an audio packet time
+
+   @returns A string containing the duration of a packet : 1ms or 125us
+*/
+std::string to_string(AudioPacketTime packet_time /*!< [in] Audio packet time that will be stringified*/);
+
+/*!
+   @brief Finds an audio packet time from its duration, as given by to_string
+
+   @returns true if the name corresponds to an audio packet time
+*/
+bool parse_audio_packet_time(const std::string& name /*!< [in] Duration of a packet*/
+                            , AudioPacketTime* packet_time /*!< [out] Audio packet time corresponding to the name*/
+);
+
+/*!
+   @brief Number of packets sent per second with an audio packet time
+
+   @returns 8000 for 125 us packets, 1000 otherwise
+*/
+uint32_t get_audio_packet_rate(AudioPacketTime packet_time /*!< [in] Duration of a packet*/);
+
 /*!
    @brief This function generates an SDP based on a stream configuration.
 
@@ -211,6 +339,37 @@ VMIP_ERRORCODE print_ptp_status(HANDLE vcs_context /*!< [in] Handle to the VCS c
 
 );
 
+/*!
+   @brief This function gives the state of the PTP service, to know whether times can be taken from the PTP clock
+
+   @returns The function returns the status of its execution as VMIP_ERRORCODE
+*/
+VMIP_ERRORCODE get_ptp_lock(HANDLE vcs_context /*!< [in] Handle to the VCS context.*/,
+                           bool* is_locked /*!< [out] The PTP service is slave of a grandmaster*/,
+                           double* offset_from_master /*!< [out] Offset of the PTP clock from the grandmaster, in seconds*/
+);
+
+/*!
+   @brief This function rounds a PTP time up to the next frame boundary. As specified in ST2059-1, the frames are aligned on the PTP epoch.
+
+   @returns The time of the first frame boundary at or after ptp_time, in nanoseconds since the PTP epoch
+*/
+uint64_t next_frame_boundary(uint64_t ptp_time /*!< [in] Time in nanoseconds since the PTP epoch*/,
+                             uint32_t rate_numerator /*!< [in] Numerator of the frame rate, 30000 for 29.97 frames per second*/,
+                             uint32_t rate_denominator /*!< [in] Denominator of the frame rate, 1001 for 29.97 frames per second*/
+);
+
+/*!
+   @brief This function prints the error between the frame boundary on which an activation was scheduled and the time the stream was switched, with the state of the PTP service
+
+   @returns The error in nanoseconds, positive if the stream was switched after the frame boundary
+*/
+int64_t print_switch_error(HANDLE vcs_context /*!< [in] Handle to the VCS context.*/,
+                           const std::string& stream_name /*!< [in] Name of the stream prefixed to the message, empty with a single stream*/,
+                           uint64_t scheduled_time /*!< [in] Frame boundary of the activation, in nanoseconds since the PTP epoch*/,
+                           uint64_t switch_time /*!< [in] Time at which the stream was switched, in nanoseconds since the PTP epoch*/
+);
+
 /*!
    @brief This function monitor RX stream status
 */
@@ -219,4 +378,4 @@ void monitor_rx_stream_status(HANDLE stream, bool* request_stop, uint32_t* timeo
 /*!
    @brief This function monitor TX stream status
 */
-void monitor_tx_stream_status(HANDLE stream, bool* request_stop);
\ No newline at end of file
+void monitor_tx_stream_status(HANDLE stream, bool* request_stop, const std::atomic<uint64_t>* deadline_misses = nullptr /*!< [in] Slots of the stream that missed their deadline, shown on the status line if set*/);
\ No newline at end of file